@@ -1,6 +1,6 @@
 /*
 Author: Dante Crescenzi
-Last Modif: 28 Mar 2024
+Last Modif: 19 Oct 2026
 Description: demo of hashtable usage
 
 tests the insertion/lookup of 2^20 random 4 byte strings
@@ -8,10 +8,40 @@ ignore the errors in this file, they are not real.
 */
 
 #include "../hashtable.h"
+#include "../hashtable_internal.h" //hash(), to time against the batch hash
+#include "../compact_hashtable.h"
+#include "../hashcache.h"
+#include "../frozen_hashtable.h"
+#include "../int_hashtable.h"
+#include "../durable_hashtable.h"
+#include "../hashset.h"
+#include "../buffer_hashtable.h"
+#include "../cuckoo_hashtable.h"
+#include "../cow_hashtable.h"
+#include "../hashtable_dump.h"
+#include "../shm_hashtable.h"
+#include "../static_hashtable.hpp"
 #include <unordered_map>
 #include <chrono>
 #include <string>
 #include <iostream>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <filesystem>
+
+//keywords known at compile time, placed by the compiler with the same hash and probe sequence
+static constexpr static_cell_t keyword_cells[] = {
+    {"GET", 0}, {"HEAD", 1}, {"POST", 2}, {"PUT", 3}, {"DELETE", 4}, {"CONNECT", 5}, {"OPTIONS", 6},
+    {"TRACE", 7}, {"PATCH", 8}, {"Host", 9}, {"Accept", 10}, {"Content-Type", 11}, {"Content-Length", 12},
+    {"Connection", 13}, {"Cookie", 14}, {"User-Agent", 15}, {"Authorization", 16}, {"Cache-Control", 17}
+};
+static constexpr auto keywords = static_hashtable_make(keyword_cells);
+static_assert(keywords.capacity == 32 && keywords.size == 18, "grown like hashtable_insert would");
+static_assert(keywords.lookup("Content-Length").cell->value == 12, "constant keys are looked up at compile time");
+static_assert(keywords.lookup("content-length").status == KEY_NOT_FOUND, "keys are case sensitive");
+static_assert(static_hash("GET") == ((5381u * 33 + 'G') * 33 + 'E') * 33 + 'T', "same hash as hash()");
 
 //NOTE: NOT MY CODE - SOURCED FROM https://codereview.stackexchange.com/questions/29198/random-string-generator-in-c
 char *randstring(size_t length) {
@@ -31,6 +61,38 @@ char *randstring(size_t length) {
 }
 //END NOTE: NOT MY CODE
 
+//draws count indices in [0, n) where index i is picked with probability proportional to 1/(i+1)^s
+std::vector<int> zipf_indices(int n, double s, int count)
+{
+    std::vector<double> cdf(n);
+    double total = 0;
+    for(int i = 0; i < n; i++) cdf[i] = total += 1.0 / std::pow(i + 1, s);
+
+    std::vector<int> indices(count);
+    for(int i = 0; i < count; i++)
+    {
+        double r = (double)rand() / RAND_MAX * total;
+        indices[i] = std::min<int>(std::lower_bound(cdf.begin(), cdf.end(), r) - cdf.begin(), n - 1);
+    }
+    return indices;
+}
+
+//times every lookup on its own, then prints the median and tail of those times
+template <typename lookup_fn>
+void print_lookup_latency(const char* name, int count, lookup_fn lookup)
+{
+    std::vector<double> latencies(count);
+    for(int i = 0; i < count; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        lookup(i);
+        latencies[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << "lookup latency of " << name << ":\tp50 " << latencies[count / 2] << " ns, p99 " << latencies[(size_t)(count * 0.99)]
+              << " ns, p99.9 " << latencies[(size_t)(count * 0.999)] << " ns, max " << latencies[count - 1] << " ns\n";
+}
+
 int main(int argc, char** argv)
 {
     //init rand strings
@@ -68,6 +130,10 @@ int main(int argc, char** argv)
         strcpy(rand_keys[i], str);
     }
 
+    //lambdas can't capture the array above, so keep plain pointers to its keys around too
+    std::vector<char*> keys(numstr);
+    for(int i = 0; i < numstr; i++) keys[i] = rand_keys[i];
+
     std::cout << "insertion/lookup of " << numstr << " random generated " << strlen << "-char strs\n";
 
     //HOMEMADE HASHTABLE ===============
@@ -92,6 +158,585 @@ int main(int argc, char** argv)
     time_taken *= 1e-9;
     std::cout << "time taken by C hashtable:\t" << time_taken << " sec\n";
 
+    //COUNTER HASHTABLE ================
+    start = std::chrono::high_resolution_clock::now();
+    hashtable_t* counter_htb = hashtable_init(default_size ? 1 : numstr);
+    for(int i = 0; i < numstr; i++) hashtable_increment(counter_htb, rand_keys[i], 1);
+    end = std::chrono::high_resolution_clock::now();
+
+    cell_t* top[1];
+    uint32_t num_top = hashtable_top_k(counter_htb, 1, top);
+    int top_count = num_top ? top[0]->value : 0;
+    hashtable_cleanup(counter_htb);
+    //==================================
+
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C hashtable (increment):\t" << time_taken << " sec\n";
+    std::cout << "most repeated key seen " << top_count << " times\n";
+
+    //CONCURRENT COUNTER HASHTABLE =====
+    int num_threads = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 4;
+    start = std::chrono::high_resolution_clock::now();
+    hashtable_t* concurrent_htb = hashtable_init_counter(default_size ? 1 : numstr);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < num_threads; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            for(int i = t; i < numstr; i += num_threads) hashtable_increment_concurrent(concurrent_htb, keys[i], 1);
+        });
+    }
+    for(std::thread& thread : threads) thread.join();
+    end = std::chrono::high_resolution_clock::now();
+
+    hashtable_cleanup(concurrent_htb);
+    //==================================
+
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C hashtable (" << num_threads << " thread increment):\t" << time_taken << " sec\n";
+
+    //COMPACT HASHTABLE ================
+    start = std::chrono::high_resolution_clock::now();
+    compact_hashtable_t* compact_htb = compact_hashtable_init(default_size ? 1 : numstr);
+    for(int i = 0; i < numstr; i++)
+    {
+        value_info_t lookup = compact_hashtable_lookup(compact_htb, rand_keys[i]);
+        if(lookup.status == OK)
+        {
+            (*lookup.value)++;
+            continue;
+        }
+        compact_hashtable_insert(compact_htb, rand_keys[i], 0);
+    }
+    end = std::chrono::high_resolution_clock::now();
+
+    size_t compact_slot_bytes = compact_hashtable_bytes(compact_htb) - compact_htb->keys_capacity - sizeof(compact_hashtable_t);
+    size_t cell_slot_bytes = sizeof(cell_t) * compact_htb->capacity;
+    compact_hashtable_cleanup(compact_htb);
+    //==================================
+
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C compact hashtable:\t" << time_taken << " sec\n";
+    std::cout << "slot memory: " << compact_slot_bytes << " bytes compact vs " << cell_slot_bytes << " bytes of cell_t\n";
+
+    //FROZEN HASHTABLE ================
+    //freeze a built table, then time hits against the same keys in the table it came from
+    hashtable_t* source_htb = hashtable_init(numstr);
+    for(int i = 0; i < numstr; i++) hashtable_insert(source_htb, rand_keys[i], i);
+
+    start = std::chrono::high_resolution_clock::now();
+    frozen_hashtable_t* frozen_htb = hashtable_freeze(source_htb);
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C hashtable (freeze):\t" << time_taken << " sec, " << frozen_hashtable_bytes(frozen_htb) << " bytes\n";
+
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < numstr; i++) hashtable_lookup(source_htb, rand_keys[i]);
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C hashtable (lookups):\t" << time_taken << " sec\n";
+
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < numstr; i++) frozen_hashtable_lookup(frozen_htb, rand_keys[i]);
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C frozen hashtable (lookups):\t" << time_taken << " sec\n";
+
+    frozen_hashtable_cleanup(frozen_htb);
+    hashtable_cleanup(source_htb);
+    //==================================
+
+    //INTEGER KEYS ====================
+    //count numstr random ids, formatted into strings for hashtable_t and inline for u64_hashtable_t
+    std::vector<uint64_t> ids(numstr);
+    for(int i = 0; i < numstr; i++) ids[i] = ((uint64_t)rand() << 31 | rand()) % (numstr * 4);
+
+    start = std::chrono::high_resolution_clock::now();
+    hashtable_t* id_str_htb = hashtable_init(default_size ? 1 : numstr);
+    char id_str[32];
+    for(int i = 0; i < numstr; i++)
+    {
+        snprintf(id_str, sizeof(id_str), "%llu", (unsigned long long)ids[i]);
+        hashtable_increment(id_str_htb, id_str, 1);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    hashtable_cleanup(id_str_htb);
+
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C hashtable (formatted id increment):\t" << time_taken << " sec\n";
+
+    start = std::chrono::high_resolution_clock::now();
+    u64_hashtable_t* id_htb = u64_hashtable_init(default_size ? 1 : numstr);
+    for(int i = 0; i < numstr; i++) u64_hashtable_increment(id_htb, ids[i], 1);
+    end = std::chrono::high_resolution_clock::now();
+    u64_hashtable_cleanup(id_htb);
+
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C u64 hashtable (id increment):\t" << time_taken << " sec\n";
+    //==================================
+
+    //STATIC HASHTABLE ================
+    //look up a stream of keywords in the compile time table and in one built at startup
+    hashtable_t* keyword_htb = hashtable_init(keywords.capacity);
+    for(const static_cell_t& cell : keyword_cells) hashtable_insert_(keyword_htb, (char*)cell.key, cell.value, /*resize*/ false, /*move*/ false);
+    for(uint32_t i = 0; i < keywords.capacity; i++) //same placement, slot for slot
+    {
+        const char* key = keyword_htb->data[i].key;
+        if((key == NULL) != (keywords.data[i].key == nullptr) || (key && strcmp(key, keywords.data[i].key) != 0)) std::cout << "static hashtable layout differs!\n";
+    }
+    const int num_keywords = sizeof(keyword_cells) / sizeof(keyword_cells[0]);
+    std::vector<std::string> keyword_stream(numstr);
+    for(int i = 0; i < numstr; i++) keyword_stream[i] = i % 4 ? keyword_cells[rand() % num_keywords].key : "X-Unknown";
+
+    value_type keyword_sum = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < numstr; i++)
+    {
+        cell_info_t lookup = hashtable_lookup(keyword_htb, (char*)keyword_stream[i].c_str());
+        if(lookup.status == OK) keyword_sum += lookup.cell->value;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C hashtable (keyword lookups):\t" << time_taken << " sec\n";
+
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < numstr; i++)
+    {
+        static_cell_info_t lookup = keywords.lookup(keyword_stream[i].c_str());
+        if(lookup.status == OK) keyword_sum -= lookup.cell->value;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by static hashtable (keyword lookups):\t" << time_taken << " sec\n";
+    if(keyword_sum) std::cout << "static hashtable lookups differ!\n";
+    hashtable_cleanup(keyword_htb);
+    //==================================
+
+    //DURABLE HASHTABLE ===============
+    //log every key with group commit, then a slice of them with an fsync per key
+    DURABILITY modes[2] = {DURABILITY_GROUP, DURABILITY_SYNC};
+    for(DURABILITY mode : modes)
+    {
+        char durable_dir[] = "/tmp/hashtable_demo_XXXXXX";
+        if(mkdtemp(durable_dir) == NULL) break;
+        durability_policy_t policy = durability_policy_default();
+        policy.mode = mode;
+        int num_logged = mode == DURABILITY_SYNC ? std::min(numstr, 1024) : numstr;
+
+        start = std::chrono::high_resolution_clock::now();
+        durable_hashtable_t* durable = durable_hashtable_open(durable_dir, policy);
+        for(int i = 0; i < num_logged; i++) durable_hashtable_put(durable, rand_keys[i], i);
+        durable_hashtable_sync(durable);
+        end = std::chrono::high_resolution_clock::now();
+        uint64_t commits = durable->commits;
+        durable_hashtable_close(durable);
+        std::filesystem::remove_all(durable_dir);
+
+        time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        time_taken *= 1e-9;
+        std::cout << "time taken by C durable hashtable (" << num_logged << (mode == DURABILITY_SYNC ? " sync" : " group commit");
+        std::cout << " puts):\t" << time_taken << " sec, " << commits << " commits\n";
+    }
+    //==================================
+
+    //BATCH HASHING ===================
+    //hash every key one at a time, then with the SIMD kernels, variable and fixed width
+    std::vector<uint32_t> batch_hashes(numstr);
+    uint32_t hash_sink = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < numstr; i++) hash_sink += hash(rand_keys[i]);
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by hash (one key at a time):\t" << time_taken << " sec\n";
+
+    start = std::chrono::high_resolution_clock::now();
+    hash_batch(keys.data(), numstr, batch_hashes.data());
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by hash_batch (isa " << hash_batch_isa() << "):\t" << time_taken << " sec\n";
+
+    start = std::chrono::high_resolution_clock::now();
+    hash_batch_fixed(rand_keys[0], strlen, strlen + 1, numstr, batch_hashes.data());
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by hash_batch_fixed:\t" << time_taken << " sec\n";
+    for(int i = 0; i < numstr; i++) hash_sink -= batch_hashes[i];
+    if(hash_sink) std::cout << "batch hashes differ from hash!\n";
+    //==================================
+
+    //TIERED LOOKUPS ==================
+    //look every key up tier by tier until found, each key living in one of 4 tiers, hashing per table vs once
+    const int num_tiers = 4;
+    hashtable_t* tiers[num_tiers];
+    for(int t = 0; t < num_tiers; t++)
+    {
+        tiers[t] = hashtable_init(numstr);
+        for(int i = t; i < numstr; i += num_tiers) hashtable_insert(tiers[t], rand_keys[i], i);
+    }
+
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < numstr; i++)
+    {
+        for(int t = 0; t < num_tiers; t++) if(hashtable_lookup(tiers[t], rand_keys[i]).status == OK) break;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C hashtable (tiered lookups):\t" << time_taken << " sec\n";
+
+    std::vector<hashed_key_t> hashed_keys(numstr);
+    start = std::chrono::high_resolution_clock::now();
+    hashtable_hash_batch(keys.data(), numstr, hashed_keys.data());
+    for(int i = 0; i < numstr; i++)
+    {
+        for(int t = 0; t < num_tiers; t++) if(hashtable_lookup_hashed(tiers[t], hashed_keys[i]).status == OK) break;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C hashtable (pre-hashed tiered lookups):\t" << time_taken << " sec\n";
+
+    for(int t = 0; t < num_tiers; t++) hashtable_cleanup(tiers[t]);
+    //==================================
+
+    //HASHSET ========================
+    //dedup every key into a set of keys only, then intersect and subtract the two halves of the keys
+    start = std::chrono::high_resolution_clock::now();
+    hashset_t* set = hashset_init(default_size ? 1 : numstr);
+    for(int i = 0; i < numstr; i++) hashset_insert(set, rand_keys[i]);
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C hashset (dedup):\t" << time_taken << " sec\n";
+    std::cout << "slot memory: " << sizeof(char*) * set->capacity << " bytes of keys vs " << sizeof(cell_t) * set->capacity << " bytes of cell_t\n";
+
+    hashset_t* halves[2] = {hashset_init(1), hashset_init(1)};
+    for(int i = 0; i < numstr; i++) hashset_insert(halves[i < numstr / 2], rand_keys[i]);
+    start = std::chrono::high_resolution_clock::now();
+    hashset_t* common = hashset_intersection(halves[0], halves[1]);
+    hashset_t* only_first = hashset_difference(halves[0], halves[1]);
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C hashset (intersection + difference):\t" << time_taken << " sec (" << common->size << " common keys)\n";
+
+    hashset_cleanup(common);
+    hashset_cleanup(only_first);
+    hashset_cleanup(halves[0]);
+    hashset_cleanup(halves[1]);
+    hashset_cleanup(set);
+    //==================================
+
+    //SCRATCH TABLES ==================
+    //fill a fresh 128 key table per request, heap allocated each time vs reset in a stack buffer
+    const int scratch_keys = 128;
+    int num_requests = numstr / scratch_keys;
+    start = std::chrono::high_resolution_clock::now();
+    for(int r = 0; r < num_requests; r++)
+    {
+        hashtable_t* scratch = hashtable_init(256);
+        for(int i = 0; i < scratch_keys; i++) hashtable_insert(scratch, rand_keys[r * scratch_keys + i], i);
+        hashtable_cleanup(scratch);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C hashtable (" << num_requests << " scratch tables):\t" << time_taken << " sec\n";
+
+    std::vector<char> scratch_buffer(buffer_hashtable_size(256, scratch_keys * (strlen + 1)));
+    buffer_hashtable_t* scratch = buffer_hashtable_init(scratch_buffer.data(), scratch_buffer.size(), 256);
+    start = std::chrono::high_resolution_clock::now();
+    for(int r = 0; r < num_requests; r++)
+    {
+        for(int i = 0; i < scratch_keys; i++) buffer_hashtable_insert(scratch, rand_keys[r * scratch_keys + i], i);
+        buffer_hashtable_reset(scratch);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C buffer hashtable (" << num_requests << " scratch tables):\t" << time_taken << " sec\n";
+    //==================================
+
+    //CUCKOO HASHTABLE ================
+    //time each lookup of 95% as many keys as slots, against hashtable_t growing as usual and held at the same load
+    int cuckoo_keys = (int)(numstr * CUCKOO_MAX_LOAD_FACTOR);
+    hashtable_t* probing_htb = hashtable_init(1);
+    hashtable_t* loaded_htb = hashtable_init(numstr);
+    cuckoo_hashtable_t* cuckoo_htb = cuckoo_hashtable_init(numstr);
+    for(int i = 0; i < cuckoo_keys; i++)
+    {
+        hashtable_insert(probing_htb, rand_keys[i], i);
+        hashtable_insert_(loaded_htb, rand_keys[i], i, /*resize*/ false, /*move*/ false);
+        cuckoo_hashtable_insert(cuckoo_htb, rand_keys[i], i);
+    }
+    print_lookup_latency("C hashtable", cuckoo_keys, [&](int i) { hashtable_lookup(probing_htb, keys[i]); });
+    print_lookup_latency("C hashtable (0.95 load)", cuckoo_keys, [&](int i) { hashtable_lookup(loaded_htb, keys[i]); });
+    print_lookup_latency("C cuckoo hashtable (0.95 load)", cuckoo_keys, [&](int i) { cuckoo_hashtable_lookup(cuckoo_htb, keys[i]); });
+    std::cout << "cuckoo hashtable capacity " << cuckoo_htb->capacity << " for " << cuckoo_htb->size << " keys\n";
+    hashtable_cleanup(probing_htb);
+    hashtable_cleanup(loaded_htb);
+    cuckoo_hashtable_cleanup(cuckoo_htb);
+    //==================================
+
+    //SNAPSHOTS =======================
+    //copy a full table for a consistent view vs snapshot it, then update 1% of the keys
+    hashtable_t* full_htb = hashtable_init(numstr);
+    cow_hashtable_t* cow_htb = cow_hashtable_init(numstr);
+    for(int i = 0; i < numstr; i++)
+    {
+        hashtable_insert(full_htb, rand_keys[i], i);
+        cow_hashtable_insert(cow_htb, rand_keys[i], i);
+    }
+
+    start = std::chrono::high_resolution_clock::now();
+    hashtable_t* full_copy = hashtable_copy(full_htb);
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C hashtable (copy):\t" << time_taken << " sec\n";
+
+    start = std::chrono::high_resolution_clock::now();
+    cow_hashtable_t* snapshot = cow_hashtable_snapshot(cow_htb);
+    end = std::chrono::high_resolution_clock::now();
+    time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    time_taken *= 1e-9;
+    std::cout << "time taken by C cow hashtable (snapshot):\t" << time_taken << " sec\n";
+
+    for(int i = 0; i < numstr; i += 100) cow_hashtable_put(cow_htb, rand_keys[i], -i);
+    uint32_t cloned_pages = cow_htb->num_pages - cow_hashtable_shared_pages(cow_htb);
+    std::cout << "pages cloned after updating 1% of keys: " << cloned_pages << " of " << cow_htb->num_pages << "\n";
+
+    cow_hashtable_cleanup(snapshot);
+    cow_hashtable_cleanup(cow_htb);
+    hashtable_cleanup(full_copy);
+    hashtable_cleanup(full_htb);
+    //==================================
+
+    //PARALLEL RESIZE =================
+    //double a full table on more and more threads, shrinking it back between runs
+    hashtable_t* resized_htb = hashtable_init(numstr);
+    for(int i = 0; i < numstr; i++) hashtable_insert(resized_htb, rand_keys[i], i);
+    uint32_t resized_capacity = resized_htb->capacity;
+    double one_thread_time = 0;
+    for(uint32_t num_threads = 1; num_threads <= 8; num_threads <<= 1)
+    {
+        hashtable_set_resize_threads(resized_htb, num_threads);
+        start = std::chrono::high_resolution_clock::now();
+        hashtable_resize(resized_htb, resized_capacity << 1);
+        end = std::chrono::high_resolution_clock::now();
+        hashtable_resize(resized_htb, resized_capacity);
+        time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        time_taken *= 1e-9;
+        if(num_threads == 1) one_thread_time = time_taken;
+        std::cout << "time taken by C hashtable (resize, " << num_threads << " threads):\t" << time_taken << " sec, speedup " << one_thread_time / time_taken << "\n";
+    }
+    hashtable_cleanup(resized_htb);
+    //==================================
+
+    //PARALLEL EXPORT =================
+    //read every key of a table (ex to serialize it), with range scans on more and more threads
+    hashtable_t* export_htb = hashtable_init(numstr);
+    for(int i = 0; i < numstr; i++) hashtable_insert(export_htb, rand_keys[i], i);
+    hashtable_visit_fn export_cell = [](cell_t* cell, void* ctx) { *(size_t*)ctx += ::strlen(cell->key) + sizeof(value_type); };
+    double one_scan_time = 0;
+    for(uint32_t num_threads = 1; num_threads <= 8; num_threads <<= 1)
+    {
+        std::vector<size_t> exported(num_threads, 0);
+        std::vector<void*> ctxs(num_threads);
+        for(uint32_t t = 0; t < num_threads; t++) ctxs[t] = &exported[t];
+        start = std::chrono::high_resolution_clock::now();
+        hashtable_for_each_parallel(export_htb, export_cell, ctxs.data(), num_threads);
+        end = std::chrono::high_resolution_clock::now();
+        time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        time_taken *= 1e-9;
+        if(num_threads == 1) one_scan_time = time_taken;
+        size_t total = 0;
+        for(uint32_t t = 0; t < num_threads; t++) total += exported[t];
+        std::cout << "time taken by C hashtable (export of " << total << " bytes, " << num_threads << " threads):\t" << time_taken << " sec, speedup " << one_scan_time / time_taken << "\n";
+    }
+    hashtable_cleanup(export_htb);
+    //==================================
+
+    //DUMP LOADING ====================
+    //dump a table to a temp directory, then load it back on more and more threads
+    char dump_dir[] = "/tmp/hashtable_demo_XXXXXX";
+    if(mkdtemp(dump_dir) != NULL)
+    {
+        std::string dump_path = std::string(dump_dir) + "/dump";
+        hashtable_t* dumped_htb = hashtable_init(numstr);
+        for(int i = 0; i < numstr; i++) hashtable_insert(dumped_htb, rand_keys[i], i);
+        if(hashtable_dump(dumped_htb, dump_path.c_str(), 64))
+        {
+            double dump_gb = std::filesystem::file_size(dump_path) * 1e-9;
+            for(uint32_t num_threads = 1; num_threads <= 8; num_threads <<= 1)
+            {
+                start = std::chrono::high_resolution_clock::now();
+                hashtable_t* loaded_htb = hashtable_load(dump_path.c_str(), num_threads);
+                end = std::chrono::high_resolution_clock::now();
+                if(loaded_htb) hashtable_cleanup(loaded_htb);
+                time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+                time_taken *= 1e-9;
+                std::cout << "time taken by C hashtable (load of dump, " << num_threads << " threads):\t" << time_taken << " sec, " << dump_gb / time_taken << " GB/s\n";
+            }
+        }
+        hashtable_cleanup(dumped_htb);
+        std::filesystem::remove_all(dump_dir);
+    }
+    //==================================
+
+    //KEY CHURN =======================
+    //delete every key and insert it back, with and without recycling key buffers
+    for(int cached = 0; cached < 2; cached++)
+    {
+        hashtable_t* churn_htb = hashtable_init(numstr);
+        hashtable_enable_expiry(churn_htb, NULL); //tombstones keep probe chains whole through deletes
+        if(cached) hashtable_enable_key_cache(churn_htb, 1 << 20);
+        for(int i = 0; i < numstr; i++) hashtable_insert(churn_htb, rand_keys[i], i);
+        start = std::chrono::high_resolution_clock::now();
+        for(int round = 0; round < 4; round++)
+        {
+            for(int i = 0; i < numstr; i += 64)
+            {
+                int batch_end = std::min(numstr, i + 64);
+                for(int j = i; j < batch_end; j++) hashtable_delete(churn_htb, keys[j]);
+                for(int j = i; j < batch_end; j++) hashtable_insert(churn_htb, keys[j], j);
+            }
+        }
+        end = std::chrono::high_resolution_clock::now();
+        hashtable_cleanup(churn_htb);
+        time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        time_taken *= 1e-9;
+        std::cout << "time taken by C hashtable (" << (cached ? "key cache, " : "") << "delete/insert churn):\t" << time_taken << " sec\n";
+    }
+    //==================================
+
+    //SHARED MEMORY ===================
+    //fill a memfd backed table once, then time attaching it like another process would and looking every key up
+    uint32_t shm_capacity = 1;
+    while(shm_capacity * MAX_LOAD_FACTOR < numstr) shm_capacity <<= 1;
+    start = std::chrono::high_resolution_clock::now();
+    shm_hashtable_t* shm_writer = shm_hashtable_create(NULL, shm_capacity, (size_t)numstr * strlen);
+    for(int i = 0; shm_writer && i < numstr; i++) shm_hashtable_put(shm_writer, rand_keys[i], i);
+    end = std::chrono::high_resolution_clock::now();
+    if(shm_writer)
+    {
+        time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        time_taken *= 1e-9;
+        std::cout << "time taken by C hashtable (build in shared memory):\t" << time_taken << " sec\n";
+
+        start = std::chrono::high_resolution_clock::now();
+        shm_hashtable_t* shm_reader = shm_hashtable_attach(shm_writer->fd);
+        end = std::chrono::high_resolution_clock::now();
+        time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        time_taken *= 1e-9;
+        std::cout << "time taken by C hashtable (attach shared memory):\t" << time_taken << " sec\n";
+
+        value_type shm_value;
+        start = std::chrono::high_resolution_clock::now();
+        for(int i = 0; shm_reader && i < numstr; i++) shm_hashtable_lookup(shm_reader, rand_keys[i], &shm_value);
+        end = std::chrono::high_resolution_clock::now();
+        time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        time_taken *= 1e-9;
+        std::cout << "time taken by C hashtable (lookups from shared memory):\t" << time_taken << " sec\n";
+        if(shm_reader) shm_hashtable_close(shm_reader);
+        shm_hashtable_close(shm_writer);
+    }
+    //==================================
+
+    //FILTERED HASHTABLE LOOKUPS =======
+    //look up as many fresh random keys as were inserted, which are almost all misses
+    std::vector<char*> missing_keys(numstr);
+    for(int i = 0; i < numstr; i++) missing_keys[i] = randstring(strlen);
+
+    hashtable_t* filter_htb = hashtable_init(numstr);
+    for(int i = 0; i < numstr; i++) hashtable_insert(filter_htb, rand_keys[i], 0);
+
+    for(int filtered = 0; filtered < 2; filtered++)
+    {
+        if(filtered) hashtable_enable_filter(filter_htb);
+        start = std::chrono::high_resolution_clock::now();
+        for(int i = 0; i < numstr; i++) hashtable_lookup(filter_htb, missing_keys[i]);
+        end = std::chrono::high_resolution_clock::now();
+
+        time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        time_taken *= 1e-9;
+        std::cout << "time taken by C hashtable (" << (filtered ? "filtered " : "") << "missing lookups):\t" << time_taken << " sec\n";
+    }
+
+    int misses = 0, false_positives = 0;
+    for(int i = 0; i < numstr; i++)
+    {
+        if(hashtable_lookup(filter_htb, missing_keys[i]).status == OK) continue;
+        misses++;
+        false_positives += hashtable_filter_contains(filter_htb, missing_keys[i]);
+    }
+    std::cout << "filter memory: " << hashtable_filter_bytes(filter_htb) << " bytes (" << (double)hashtable_filter_bytes(filter_htb) * 8 / filter_htb->size << " bits/key)";
+    std::cout << ", false positive rate: " << (misses ? (double)false_positives / misses : 0) << "\n";
+
+    hashtable_cleanup(filter_htb);
+    for(int i = 0; i < numstr; i++) free(missing_keys[i]);
+    //==================================
+
+    //CACHE UNDER ZIPFIAN LOAD =========
+    //cache a tenth of the keys, and fill it on misses like a read-through cache would
+    double exponents[] = {0.6, 0.99, 1.2};
+    for(double exponent : exponents)
+    {
+        std::vector<int> indices = zipf_indices(numstr, exponent, numstr);
+        hashcache_t* cache = hashcache_init(numstr / 10 ? numstr / 10 : 1, NULL, NULL);
+
+        start = std::chrono::high_resolution_clock::now();
+        for(int i = 0; i < numstr; i++)
+        {
+            char* key = rand_keys[indices[i]];
+            if(hashcache_lookup(cache, key).status != OK) hashcache_insert(cache, key, 0);
+        }
+        end = std::chrono::high_resolution_clock::now();
+
+        time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        time_taken *= 1e-9;
+        std::cout << "time taken by C cache (zipf " << exponent << "):\t" << time_taken << " sec, hit ratio " << hashcache_hit_ratio(cache) << "\n";
+        hashcache_cleanup(cache);
+    }
+    //==================================
+
+    //HOT KEY LOOKUPS =================
+    //look up zipfian keys in a full hashtable, walking the probe sequence vs through a 4096 entry hot cache
+    hashtable_t* hot_htb = hashtable_init(numstr);
+    for(int i = 0; i < numstr; i++) hashtable_insert(hot_htb, rand_keys[i], i);
+    for(double exponent : exponents)
+    {
+        std::vector<int> indices = zipf_indices(numstr, exponent, numstr);
+        for(int cached = 0; cached < 2; cached++)
+        {
+            if(cached) hashtable_enable_hot_cache(hot_htb, 4096);
+            start = std::chrono::high_resolution_clock::now();
+            for(int i = 0; i < numstr; i++) hashtable_lookup(hot_htb, rand_keys[indices[i]]);
+            end = std::chrono::high_resolution_clock::now();
+            time_taken = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            time_taken *= 1e-9;
+            std::cout << "time taken by C hashtable (zipf " << exponent << (cached ? ", hot cache" : "") << "):\t" << time_taken << " sec";
+            if(cached) std::cout << ", hit ratio " << (double)hot_htb->hot_cache->hits / numstr;
+            std::cout << "\n";
+        }
+        hashtable_disable_hot_cache(hot_htb);
+    }
+    hashtable_cleanup(hot_htb);
+    //==================================
+
     //C++ HASHTABLE ====================
     start = std::chrono::high_resolution_clock::now();
     std::unordered_map<std::string, int> cpp_htb;
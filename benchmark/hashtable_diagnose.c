@@ -0,0 +1,60 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: command line tool printing the diagnostics of a hashtable
+
+Diagnoses the hashtable saved in a dump (see hashtable_dump.h), or one built from a file of keys
+(one per line) to see how hash() and the load factor would treat them, see hashtable_diagnostics.h.
+*/
+
+#include "../hashtable_diagnostics.h"
+#include "../hashtable_dump.h"
+
+static hashtable_t* load_keys_(const char* path, uint32_t capacity) //local utility, one key per line
+{
+    FILE* file = fopen(path, "r");
+    if(file == NULL) return NULL;
+    hashtable_t* hashtable = hashtable_init(capacity);
+    if(hashtable == NULL)
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    char* line = NULL;
+    size_t line_capacity = 0;
+    ssize_t len;
+    while((len = getline(&line, &line_capacity, file)) >= 0)
+    {
+        while(len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = '\0';
+        if(len == 0) continue;
+        //a fixed capacity shows the keys at the load factor it gives them
+        if(hashtable_insert_(hashtable, line, 0, /*resize*/ capacity == 1, /*move*/ false).status == HASHTABLE_FULL) break;
+    }
+    free(line);
+    fclose(file);
+    return hashtable;
+}
+
+int main(int argc, char** argv)
+{
+    hashtable_t* hashtable = NULL;
+    if(argc == 2) hashtable = hashtable_load(argv[1], 4);
+    else if((argc == 3 || argc == 4) && strcmp(argv[1], "--keys") == 0) hashtable = load_keys_(argv[2], argc == 4 ? (uint32_t)strtoul(argv[3], NULL, 10) : 1);
+    else
+    {
+        printf("usage: ./hashtable_diagnose <dump> | ./hashtable_diagnose --keys <file> [capacity]\n");
+        printf("example: ./hashtable_diagnose --keys words.txt 65536 -- words.txt (one key per line) in a hashtable of capacity 65536\n");
+        return 1;
+    }
+    if(hashtable == NULL)
+    {
+        fprintf(stderr, "could not read a hashtable from '%s'\n", argv[argc == 2 ? 1 : 2]);
+        return 1;
+    }
+
+    hashtable_diagnostics_t diagnostics = hashtable_diagnose(hashtable);
+    hashtable_print_diagnostics(stdout, &diagnostics);
+    hashtable_cleanup(hashtable);
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: impl of buffer hashtable methods outlined in buffer_hashtable.h
+*/
+
+#include "buffer_hashtable.h"
+#include "hashtable_internal.h"
+
+static size_t align_up_(size_t n) //local utility
+{
+    return (n + BUFFER_HASHTABLE_ALIGN - 1) & ~(size_t)(BUFFER_HASHTABLE_ALIGN - 1);
+}
+
+size_t buffer_hashtable_size(uint32_t capacity, size_t key_bytes)
+{
+    //worst case misalignment of the buffer, then header, slots and keys
+    return BUFFER_HASHTABLE_ALIGN - 1 + align_up_(sizeof(buffer_hashtable_t)) + sizeof(buffer_cell_t) * capacity + key_bytes;
+}
+
+buffer_hashtable_t* buffer_hashtable_init(void* buffer, size_t buffer_bytes, uint32_t capacity)
+{
+    bool capacity_is_not_power_of_2 = capacity & (capacity - 1);
+    if(capacity == 0 || capacity_is_not_power_of_2)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "buffer_hashtable_init", "capacity %u must be nonzero and a power of two, aborting", capacity);
+        return NULL;
+    }
+
+    uintptr_t start = (uintptr_t)buffer;
+    uintptr_t aligned = align_up_(start);
+    size_t slots_offset = aligned - start + align_up_(sizeof(buffer_hashtable_t));
+    size_t keys_offset = slots_offset + sizeof(buffer_cell_t) * capacity;
+    if(buffer == NULL || keys_offset > buffer_bytes)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "buffer_hashtable_init", "buffer of %zu bytes can't hold %u slots, aborting", buffer_bytes, capacity);
+        return NULL;
+    }
+
+    buffer_hashtable_t* hashtable = (buffer_hashtable_t*)aligned;
+    hashtable->capacity = capacity;
+    hashtable->size = 0;
+    hashtable->epoch = 1;
+    hashtable->data = (buffer_cell_t*)((char*)buffer + slots_offset);
+    hashtable->keys = (char*)buffer + keys_offset;
+    hashtable->keys_used = 0;
+    hashtable->keys_capacity = buffer_bytes - keys_offset;
+    memset(hashtable->data, 0, sizeof(buffer_cell_t) * capacity); //epoch 0, so every slot starts empty
+
+    if(hashtable_logs) hashtable_log(INFO, "buffer_hashtable_init", "created buffer hashtable of capacity %u with %zu bytes of keys", capacity, hashtable->keys_capacity);
+    return hashtable;
+}
+
+void buffer_hashtable_reset(buffer_hashtable_t* hashtable)
+{
+    hashtable->size = 0;
+    hashtable->keys_used = 0;
+    hashtable->epoch++;
+    if(hashtable->epoch == 0) //wrapped around, slots of old epochs could look occupied again
+    {
+        memset(hashtable->data, 0, sizeof(buffer_cell_t) * hashtable->capacity);
+        hashtable->epoch = 1;
+    }
+    if(hashtable_logs) hashtable_log(INFO, "buffer_hashtable_reset", "reset buffer hashtable to epoch %u", hashtable->epoch);
+}
+
+value_info_t buffer_hashtable_insert(buffer_hashtable_t* hashtable, char* key, value_type value)
+{
+    value_info_t insertion_result;
+    insertion_result.value = NULL;
+
+    if(hashtable->size == hashtable->capacity)
+    {
+        if(hashtable_logs) hashtable_log(WARN, "buffer_hashtable_insert", "insertion of key '%s' failed, size has reached capacity %u", key, hashtable->capacity);
+        insertion_result.status = HASHTABLE_FULL;
+        return insertion_result;
+    }
+
+    uint32_t base_idx = hash(key);
+    int64_t free_idx = -1; //first tombstone seen, reused unless the key turns up later in the chain
+    int probe = 0;
+
+    do
+    {
+        uint32_t idx = probe_idx(base_idx, probe, hashtable->capacity);
+        bool full_cycle = probe && idx == mod(base_idx, hashtable->capacity);
+        buffer_cell_t* cell = &hashtable->data[idx];
+
+        if(cell->epoch != hashtable->epoch || full_cycle) //end of chain
+        {
+            if(free_idx >= 0) cell = &hashtable->data[free_idx];
+
+            size_t key_bytes = strlen(key) + 1;
+            if(hashtable->keys_capacity - hashtable->keys_used < key_bytes)
+            {
+                if(hashtable_logs) hashtable_log(WARN, "buffer_hashtable_insert", "insertion of key '%s' failed, key arena is full", key);
+                insertion_result.status = HASHTABLE_FULL;
+                break;
+            }
+
+            cell->key = hashtable->keys + hashtable->keys_used;
+            memcpy(cell->key, key, key_bytes);
+            hashtable->keys_used += key_bytes;
+            cell->value = value;
+            cell->epoch = hashtable->epoch;
+
+            insertion_result.status = OK;
+            insertion_result.value = &cell->value;
+            hashtable->size++;
+            if(hashtable_logs) hashtable_log(INFO, "buffer_hashtable_insert", "insertion of key '%s' succeeded", key);
+            break;
+        }
+        else if(cell->key == NULL) //tombstone
+        {
+            if(free_idx < 0) free_idx = idx;
+        }
+        else if(*cell->key == *key && strcmp(cell->key, key) == 0) //duplicate key
+        {
+            insertion_result.status = DUPLICATE_KEY;
+            insertion_result.value = &cell->value;
+            if(hashtable_logs) hashtable_log(WARN, "buffer_hashtable_insert", "insertion of key '%s' failed, duplicate key found", key);
+            break;
+        }
+        probe++;
+    } while(true);
+
+    return insertion_result;
+}
+
+value_info_t buffer_hashtable_lookup(buffer_hashtable_t* hashtable, char* key)
+{
+    value_info_t lookup_result;
+    lookup_result.value = NULL;
+    lookup_result.status = KEY_NOT_FOUND;
+
+    uint32_t base_idx = hash(key);
+    int probe = 0;
+
+    do
+    {
+        uint32_t idx = probe_idx(base_idx, probe, hashtable->capacity);
+
+        if(probe && idx == mod(base_idx, hashtable->capacity)) break; //full table cycle case
+
+        buffer_cell_t* cell = &hashtable->data[idx];
+        if(cell->epoch != hashtable->epoch) break; //empty slot
+        if(cell->key && *cell->key == *key && strcmp(cell->key, key) == 0) //key found
+        {
+            lookup_result.status = OK;
+            lookup_result.value = &cell->value;
+            break;
+        }
+        probe++;
+    } while(true);
+
+    if(hashtable_logs) hashtable_log(INFO, "buffer_hashtable_lookup", "lookup of key '%s' %s", key, lookup_result.status == OK ? "succeeded" : "failed, not found");
+    return lookup_result;
+}
+
+value_info_t buffer_hashtable_delete(buffer_hashtable_t* hashtable, char* key)
+{
+    value_info_t lookup_result = buffer_hashtable_lookup(hashtable, key);
+    if(lookup_result.status == KEY_NOT_FOUND)
+    {
+        if(hashtable_logs) hashtable_log(WARN, "buffer_hashtable_delete", "deletion of key '%s' failed, not found", key);
+        return lookup_result;
+    }
+
+    //value is the second member, step back to the slot holding it
+    buffer_cell_t* cell = (buffer_cell_t*)((char*)lookup_result.value - offsetof(buffer_cell_t, value));
+    cell->key = NULL; //the slot stays in the current epoch as a tombstone, its value owns nothing
+    hashtable->size--;
+
+    lookup_result.value = NULL;
+    if(hashtable_logs) hashtable_log(INFO, "buffer_hashtable_delete", "deletion of key '%s' succeeded", key);
+    return lookup_result;
+}
@@ -0,0 +1,74 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: string -> any hashtable laid out in a caller provided buffer
+
+This header describes the interface to a fixed capacity hashtable that never touches the heap, for
+small scratch tables on latency critical paths (ex one per request).  buffer_hashtable_init lays
+out the header, the slots and a key arena inside a buffer the caller owns (on the stack, from a
+pool...), and keys are copied into the arena instead of being allocated one by one.  Nothing grows:
+inserts past the capacity, or past the room left in the key arena, return HASHTABLE_FULL.
+
+It uses the same hash and probe sequence as hashtable_t, with the same status codes.  Every slot is
+stamped with the epoch it was written in, and only slots of the current epoch are occupied, so
+buffer_hashtable_reset empties the hashtable in O(1) by starting a new epoch and rewinding the key
+arena.  Deleted slots leave a tombstone and deleted keys keep their arena space until the reset.
+
+There is no cleanup, the caller just reuses or frees its buffer.
+NOTE: reset drops values without looking at them, so value_type must not own resources.
+*/
+
+#ifndef INCLUDE_BUFFER_HASHTABLE_H
+#define INCLUDE_BUFFER_HASHTABLE_H
+
+#include "hashtable.h"
+#include <stddef.h>
+
+//alignment the header and slots are laid out at within the buffer
+#define BUFFER_HASHTABLE_ALIGN 16
+
+//struct to represent a slot of a buffer hashtable, occupied only if epoch is the hashtable's.
+typedef struct
+{
+    char* key;      //NULL for a tombstone
+    value_type value;
+    uint32_t epoch;
+} buffer_cell_t;
+
+//struct to represent a buffer hashtable, stored at the start of its buffer.
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t size;
+    uint32_t epoch;
+    buffer_cell_t* data;
+    char* keys;         //key arena, every key back to back, NUL terminated
+    size_t keys_used;
+    size_t keys_capacity;
+} buffer_hashtable_t;
+
+//returns the number of bytes a buffer needs to hold a buffer hashtable of passed capacity with
+//key_bytes of keys (each key takes its length + 1).
+size_t buffer_hashtable_size(uint32_t capacity, size_t key_bytes);
+
+//initialize a buffer hashtable with passed capacity, which must be a power of 2, inside the
+//passed buffer. every byte left after the slots goes to the key arena.
+//returns a pointer to the new hashtable (within buffer), NULL if the buffer is too small.
+buffer_hashtable_t* buffer_hashtable_init(void* buffer, size_t buffer_bytes, uint32_t capacity);
+
+//empty the passed buffer hashtable in O(1), making it ready for reuse.
+void buffer_hashtable_reset(buffer_hashtable_t* hashtable);
+
+//insert a key value pair into the passed buffer hashtable, copying the key into the key arena.
+//returns a value_info_t, with status and pointer to value if insertion succeeded (NULL otherwise).
+value_info_t buffer_hashtable_insert(buffer_hashtable_t* hashtable, char* key, value_type value);
+
+//lookup a key value pair in the passed buffer hashtable
+//returns a value_info_t, with status and pointer to value if lookup succeeded (NULL otherwise).
+value_info_t buffer_hashtable_lookup(buffer_hashtable_t* hashtable, char* key);
+
+//delete a key value pair in the passed buffer hashtable
+//returns a value_info_t, with status of deletion (value pointer always NULL)
+value_info_t buffer_hashtable_delete(buffer_hashtable_t* hashtable, char* key);
+
+#endif //INCLUDE_BUFFER_HASHTABLE_H
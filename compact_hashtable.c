@@ -0,0 +1,286 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: impl of compact hashtable methods outlined in compact_hashtable.h
+*/
+
+#include "compact_hashtable.h"
+#include "hashtable_internal.h"
+
+static uint8_t tag_of_(uint32_t key_hash) //local utility, top bits since the low bits pick the slot
+{
+    return 0x80 | (key_hash >> 25);
+}
+
+compact_hashtable_t* compact_hashtable_init(uint32_t capacity)
+{
+    bool capacity_is_not_power_of_2 = capacity & (capacity - 1);
+    if(capacity == 0 || capacity_is_not_power_of_2)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "compact_hashtable_init", "capacity %u must be nonzero and a power of two, aborting", capacity);
+        return NULL;
+    }
+
+    compact_hashtable_t* hashtable = (compact_hashtable_t*)malloc(sizeof(compact_hashtable_t));
+
+    hashtable->capacity = capacity;
+    hashtable->size = 0;
+    hashtable->tombstones = 0;
+    hashtable->tags = (uint8_t*)calloc(capacity, sizeof(uint8_t));
+    hashtable->offsets = (uint32_t*)malloc(sizeof(uint32_t) * capacity);
+    hashtable->values = (value_type*)malloc(sizeof(value_type) * capacity);
+    hashtable->keys_capacity = capacity <= (UINT32_MAX >> 3) ? capacity * 8 : UINT32_MAX; //room for 7 char keys before growing
+    hashtable->keys = (char*)malloc(hashtable->keys_capacity);
+    hashtable->keys_used = 0;
+    hashtable->keys_garbage = 0;
+
+    if(hashtable_logs) hashtable_log(INFO, "compact_hashtable_init", "created and initialized compact hashtable of capacity %u", capacity);
+    return hashtable;
+}
+
+void compact_hashtable_cleanup(compact_hashtable_t* hashtable)
+{
+    if(hashtable_logs) hashtable_log(INFO, "compact_hashtable_cleanup", "destroying compact hashtable of capacity %u with %u elements", hashtable->capacity, hashtable->size);
+    compact_hashtable_clear(hashtable);
+    free(hashtable->tags);
+    free(hashtable->offsets);
+    free(hashtable->values);
+    free(hashtable->keys);
+    free(hashtable);
+}
+
+//appends key to the key blob, growing it if need be.
+//returns false if the blob can't address the key with 32 bit offsets.
+static bool append_key_(compact_hashtable_t* hashtable, char* key, uint32_t* offset) //local utility
+{
+    size_t key_size = strlen(key) + 1;
+    if(hashtable->keys_used + key_size > UINT32_MAX) return false;
+
+    if(hashtable->keys_used + key_size > hashtable->keys_capacity)
+    {
+        size_t new_capacity = (size_t)hashtable->keys_capacity << 1;
+        while(new_capacity < hashtable->keys_used + key_size) new_capacity <<= 1;
+        if(new_capacity > UINT32_MAX) new_capacity = UINT32_MAX;
+        hashtable->keys = (char*)realloc(hashtable->keys, new_capacity);
+        hashtable->keys_capacity = (uint32_t)new_capacity;
+    }
+
+    *offset = hashtable->keys_used;
+    memcpy(hashtable->keys + hashtable->keys_used, key, key_size);
+    hashtable->keys_used += key_size;
+    return true;
+}
+
+uint32_t compact_hashtable_resize(compact_hashtable_t* hashtable, uint32_t new_capacity)
+{
+    if(new_capacity < hashtable->size)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "compact_hashtable_resize", "new capacity %u too small to hold current elements (%u), aborting", new_capacity, hashtable->size);
+        return hashtable->capacity;
+    }
+    bool capacity_is_not_power_of_2 = new_capacity & (new_capacity - 1);
+    if(new_capacity == 0 || capacity_is_not_power_of_2)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "compact_hashtable_resize", "new capacity %u is not a power of 2, aborting", new_capacity);
+        return hashtable->capacity;
+    }
+
+    //rehashing into the same capacity is allowed, it drops tombstones and deleted keys
+    compact_hashtable_t* tmp_hashtable = compact_hashtable_init(new_capacity);
+    uint32_t live_keys = hashtable->keys_used - hashtable->keys_garbage;
+    if(live_keys > tmp_hashtable->keys_capacity)
+    {
+        tmp_hashtable->keys_capacity = live_keys;
+        tmp_hashtable->keys = (char*)realloc(tmp_hashtable->keys, live_keys);
+    }
+
+    for(uint32_t i = 0; i < hashtable->capacity; i++)
+    {
+        if(hashtable->tags[i] < 0x80) continue;
+        compact_hashtable_insert_(tmp_hashtable, hashtable->keys + hashtable->offsets[i], hashtable->values[i], /*resize*/ false, /*move*/ true);
+    }
+
+    free(hashtable->tags);
+    free(hashtable->offsets);
+    free(hashtable->values);
+    free(hashtable->keys);
+    *hashtable = *tmp_hashtable;
+    free(tmp_hashtable);
+
+    if(hashtable_logs) hashtable_log(INFO, "compact_hashtable_resize", "resized compact hashtable to new capacity %u", new_capacity);
+    return new_capacity;
+}
+
+uint32_t compact_hashtable_squash(compact_hashtable_t* hashtable)
+{
+    uint32_t new_capacity = 1;
+    while(new_capacity < hashtable->size && new_capacity < 1u << 31) new_capacity <<= 1;
+    compact_hashtable_resize(hashtable, new_capacity);
+    if(hashtable_logs) hashtable_log(INFO, "compact_hashtable_squash", "squashed compact hashtable to min capacity %u", hashtable->capacity);
+    return hashtable->capacity;
+}
+
+uint32_t compact_hashtable_clear(compact_hashtable_t* hashtable)
+{
+    uint32_t num_deletions = hashtable->size;
+    for(uint32_t i = 0; i < hashtable->capacity; i++) if(hashtable->tags[i] >= 0x80) HASHTABLE_VALUE_DESTROY(hashtable->values[i]);
+    memset(hashtable->tags, COMPACT_EMPTY, hashtable->capacity);
+    hashtable->size = 0;
+    hashtable->tombstones = 0;
+    hashtable->keys_used = 0;
+    hashtable->keys_garbage = 0;
+
+    if(hashtable_logs) hashtable_log(INFO, "compact_hashtable_clear", "cleared %u elements from compact hashtable", num_deletions);
+    return num_deletions;
+}
+
+size_t compact_hashtable_bytes(compact_hashtable_t* hashtable)
+{
+    size_t slot_bytes = sizeof(uint8_t) + sizeof(uint32_t) + sizeof(value_type);
+    return sizeof(compact_hashtable_t) + slot_bytes * hashtable->capacity + hashtable->keys_capacity;
+}
+
+value_info_t compact_hashtable_insert_(compact_hashtable_t* hashtable, char* key, value_type value, bool auto_resize, bool move)
+{
+    value_info_t insertion_result;
+    insertion_result.value = NULL;
+
+    if(hashtable->size == hashtable->capacity)
+    {
+        if(hashtable_logs) hashtable_log(WARN, "compact_hashtable_insert", "insertion of key '%s' failed, size has reached capacity %u", key, hashtable->capacity);
+        insertion_result.status = HASHTABLE_FULL;
+        return insertion_result;
+    }
+
+    uint32_t base_idx = hash(key);
+    uint8_t tag = tag_of_(base_idx);
+    int64_t free_idx = -1; //first tombstone seen, reused unless the key turns up later in the chain
+    int probe = 0;
+
+    do
+    {
+        uint32_t idx = probe_idx(base_idx, probe, hashtable->capacity);
+
+        if(probe && idx == mod(base_idx, hashtable->capacity) && free_idx < 0) //full table cycle case
+        {
+            if(hashtable_logs) hashtable_log(WARN, "compact_hashtable_insert", "insertion of key '%s' failed, no free slot found", key);
+            insertion_result.status = HASHTABLE_FULL;
+            return insertion_result;
+        }
+
+        uint8_t cur_tag = hashtable->tags[idx];
+        if(cur_tag == COMPACT_EMPTY || (probe && idx == mod(base_idx, hashtable->capacity))) //end of chain
+        {
+            if(free_idx >= 0) idx = (uint32_t)free_idx;
+
+            uint32_t offset;
+            if(!append_key_(hashtable, key, &offset))
+            {
+                if(hashtable_logs) hashtable_log(WARN, "compact_hashtable_insert", "insertion of key '%s' failed, key blob is full", key);
+                insertion_result.status = HASHTABLE_FULL;
+                return insertion_result;
+            }
+
+            if(hashtable->tags[idx] == COMPACT_TOMBSTONE) hashtable->tombstones--;
+            hashtable->tags[idx] = tag;
+            hashtable->offsets[idx] = offset;
+            if(move) hashtable->values[idx] = value;
+            else HASHTABLE_VALUE_COPY(&hashtable->values[idx], value);
+
+            insertion_result.status = OK;
+            insertion_result.value = &hashtable->values[idx];
+            hashtable->size++;
+            if(hashtable_logs) hashtable_log(INFO, "compact_hashtable_insert", "insertion of key '%s' succeeded", key);
+            break;
+        }
+        else if(cur_tag == COMPACT_TOMBSTONE)
+        {
+            if(free_idx < 0) free_idx = idx;
+        }
+        else if(cur_tag == tag && strcmp(hashtable->keys + hashtable->offsets[idx], key) == 0) //duplicate key
+        {
+            insertion_result.status = DUPLICATE_KEY;
+            insertion_result.value = &hashtable->values[idx];
+            if(hashtable_logs) hashtable_log(WARN, "compact_hashtable_insert", "insertion of key '%s' failed, duplicate key found", key);
+            break;
+        }
+        probe++;
+    } while(true);
+
+    //tombstones lengthen probe chains just like keys, so they count towards the load factor
+    double load_factor = (double)(hashtable->size + hashtable->tombstones) / hashtable->capacity;
+    if(auto_resize &&
+       load_factor > MAX_LOAD_FACTOR &&
+       insertion_result.status == OK &&
+       hashtable->capacity < 1u << 31)
+    {
+        bool mostly_tombstones = hashtable->tombstones > hashtable->size;
+        uint32_t new_capacity = mostly_tombstones ? hashtable->capacity : hashtable->capacity << 1;
+        if(hashtable_logs) hashtable_log(INFO, "compact_hashtable_insert", "insertion of key '%s' triggered resize to %u", key, new_capacity);
+        compact_hashtable_resize(hashtable, new_capacity);
+        insertion_result = compact_hashtable_lookup(hashtable, key);
+    }
+
+    return insertion_result;
+}
+
+value_info_t compact_hashtable_insert(compact_hashtable_t* hashtable, char* key, value_type value)
+{
+    return compact_hashtable_insert_(hashtable, key, value, /*resize*/ true, /*move*/ false);
+}
+
+value_info_t compact_hashtable_lookup(compact_hashtable_t* hashtable, char* key)
+{
+    value_info_t lookup_result;
+    lookup_result.value = NULL;
+    lookup_result.status = KEY_NOT_FOUND;
+
+    uint32_t base_idx = hash(key);
+    uint8_t tag = tag_of_(base_idx);
+    int probe = 0;
+
+    do
+    {
+        uint32_t idx = probe_idx(base_idx, probe, hashtable->capacity);
+
+        if(probe && idx == mod(base_idx, hashtable->capacity)) break; //full table cycle case
+
+        uint8_t cur_tag = hashtable->tags[idx];
+        if(cur_tag == COMPACT_EMPTY) break;
+        if(cur_tag == tag && strcmp(hashtable->keys + hashtable->offsets[idx], key) == 0) //key found
+        {
+            lookup_result.status = OK;
+            lookup_result.value = &hashtable->values[idx];
+            break;
+        }
+        probe++;
+    } while(true);
+
+    if(hashtable_logs) hashtable_log(INFO, "compact_hashtable_lookup", "lookup of key '%s' %s", key, lookup_result.status == OK ? "succeeded" : "failed, not found");
+    return lookup_result;
+}
+
+value_info_t compact_hashtable_delete(compact_hashtable_t* hashtable, char* key)
+{
+    value_info_t lookup_result = compact_hashtable_lookup(hashtable, key);
+    if(lookup_result.status == KEY_NOT_FOUND)
+    {
+        if(hashtable_logs) hashtable_log(WARN, "compact_hashtable_delete", "deletion of key '%s' failed, not found", key);
+        return lookup_result;
+    }
+
+    uint32_t idx = (uint32_t)(lookup_result.value - hashtable->values);
+    hashtable->tags[idx] = COMPACT_TOMBSTONE;
+    hashtable->tombstones++;
+    hashtable->keys_garbage += strlen(hashtable->keys + hashtable->offsets[idx]) + 1;
+    HASHTABLE_VALUE_DESTROY(hashtable->values[idx]);
+    hashtable->size--;
+
+    //deleted keys stay in the blob until the next rehash, force one once they're most of it
+    bool mostly_garbage = hashtable->keys_garbage > (hashtable->keys_used >> 1) && hashtable->keys_garbage > 4096;
+    if(mostly_garbage) compact_hashtable_resize(hashtable, hashtable->capacity);
+
+    lookup_result.value = NULL;
+    if(hashtable_logs) hashtable_log(INFO, "compact_hashtable_delete", "deletion of key '%s' succeeded", key);
+    return lookup_result;
+}
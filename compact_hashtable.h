@@ -0,0 +1,83 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: string -> any hashtable with a compact, struct of arrays slot layout
+
+This header describes the interface to a memory compact variant of hashtable_t.  Instead of a
+cell_t (8 byte key pointer + value, padded) per slot, slots are split into three arrays: a 1 byte
+tag holding 7 bits of the key hash, a 32 bit offset of the key within one contiguous key blob, and
+the value.  With int values a slot takes 9 bytes instead of 16, keys don't need an allocation each,
+and probing mostly only touches the tag array, 64 slots per cache line.
+
+It uses the same hash and probe sequence as hashtable_t, with the same operations and status
+codes.  Deleted slots are marked with a tombstone tag so probe chains stay intact, and the space of
+deleted keys in the blob is reclaimed whenever the table is rehashed.  The key blob is limited to
+4GB by its 32 bit offsets, inserts past that return HASHTABLE_FULL.
+Values go through HASHTABLE_VALUE_COPY and HASHTABLE_VALUE_DESTROY as in hashtable_t.
+*/
+
+#ifndef INCLUDE_COMPACT_HASHTABLE_H
+#define INCLUDE_COMPACT_HASHTABLE_H
+
+#include "hashtable.h"
+
+//struct to represent a compact hashtable.
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t size;
+    uint32_t tombstones;
+    uint8_t* tags;      //COMPACT_EMPTY, COMPACT_TOMBSTONE or 0x80 | top 7 bits of the key hash
+    uint32_t* offsets;  //offset of the key of each slot within keys
+    value_type* values;
+    char* keys;         //every key back to back, NUL terminated
+    uint32_t keys_used;
+    uint32_t keys_capacity;
+    uint32_t keys_garbage; //bytes of deleted keys still in keys
+} compact_hashtable_t;
+
+#define COMPACT_EMPTY 0x00
+#define COMPACT_TOMBSTONE 0x01
+
+//initialize a compact hashtable with passed capacity, which must be a power of 2.
+//returns a pointer to the new hashtable
+compact_hashtable_t* compact_hashtable_init(uint32_t capacity);
+
+//cleanup the passed compact hashtable.
+void compact_hashtable_cleanup(compact_hashtable_t* hashtable);
+
+//rehash the given compact hashtable into new_capacity slots, if possible, reclaiming the key
+//space of deleted keys.
+//returns the new capacity of the hashtable.
+uint32_t compact_hashtable_resize(compact_hashtable_t* hashtable, uint32_t new_capacity);
+
+//squash the given compact hashtable to it's smallest possible memory footprint.
+//returns the new capacity of the hashtable.
+uint32_t compact_hashtable_squash(compact_hashtable_t* hashtable);
+
+//clear the given compact hashtable, making it empty.
+//returns the number of deleted items.
+uint32_t compact_hashtable_clear(compact_hashtable_t* hashtable);
+
+//returns the number of bytes used by the passed compact hashtable's slots and key blob.
+size_t compact_hashtable_bytes(compact_hashtable_t* hashtable);
+
+//insert a key value pair into the passed compact hashtable, with flags to control automatic
+//resizing and whether the value is moved in bit for bit instead of copied through
+//HASHTABLE_VALUE_COPY. the key is always copied into the key blob.
+//returns a value_info_t, with status and pointer to value if insertion succeeded (NULL otherwise).
+value_info_t compact_hashtable_insert_(compact_hashtable_t* hashtable, char* key, value_type value, bool auto_resize, bool move);
+
+//insert a key value pair into the passed compact hashtable, and automatically resize if need be.
+//returns a value_info_t, with status and pointer to value if insertion succeeded (NULL otherwise).
+value_info_t compact_hashtable_insert(compact_hashtable_t* hashtable, char* key, value_type value);
+
+//lookup a key value pair in the passed compact hashtable
+//returns a value_info_t, with status and pointer to value if lookup succeeded (NULL otherwise).
+value_info_t compact_hashtable_lookup(compact_hashtable_t* hashtable, char* key);
+
+//delete a key value pair in the passed compact hashtable
+//returns a value_info_t, with status of deletion (value pointer always NULL)
+value_info_t compact_hashtable_delete(compact_hashtable_t* hashtable, char* key);
+
+#endif //INCLUDE_COMPACT_HASHTABLE_H
@@ -0,0 +1,321 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: impl of copy-on-write hashtable methods outlined in cow_hashtable.h
+*/
+
+#include "cow_hashtable.h"
+#include "hashtable_internal.h"
+
+//deleted slots point at this, so they are neither empty (NULL) nor a key
+static char tombstone_;
+#define COW_TOMBSTONE (&tombstone_)
+
+static bool is_key_(char* key) //local utility
+{
+    return key && key != COW_TOMBSTONE;
+}
+
+//keys have the layout of interned keys (refcount and hash right before the string), but are
+//refcounted atomically since pages holding them can be released from other threads
+static char* key_new_(char* key, uint32_t key_hash) //local utility
+{
+    size_t key_len = strlen(key);
+    pooled_key_t* header = (pooled_key_t*)malloc(sizeof(pooled_key_t) + key_len + 1);
+    header->refcount = 1;
+    header->hash = key_hash;
+    char* copy = (char*)(header + 1);
+    memcpy(copy, key, key_len + 1);
+    return copy;
+}
+
+static uint32_t key_hash_(char* key) //local utility
+{
+    return ((pooled_key_t*)key - 1)->hash;
+}
+
+static void key_retain_(char* key) //local utility
+{
+    __atomic_add_fetch(&((pooled_key_t*)key - 1)->refcount, 1, __ATOMIC_RELAXED);
+}
+
+static void key_release_(char* key) //local utility
+{
+    pooled_key_t* header = (pooled_key_t*)key - 1;
+    if(__atomic_sub_fetch(&header->refcount, 1, __ATOMIC_ACQ_REL) == 0) free(header);
+}
+
+static cow_page_t* page_init_(uint32_t page_slots) //local utility, empty and unshared
+{
+    cow_page_t* page = (cow_page_t*)malloc(sizeof(cow_page_t) + sizeof(cell_t) * page_slots);
+    page->refcount = 1;
+    page->cells = (cell_t*)(page + 1);
+    for(uint32_t i = 0; i < page_slots; i++) page->cells[i].key = NULL;
+    return page;
+}
+
+static void page_release_(cow_page_t* page, uint32_t page_slots) //local utility
+{
+    if(__atomic_sub_fetch(&page->refcount, 1, __ATOMIC_ACQ_REL) != 0) return;
+    for(uint32_t i = 0; i < page_slots; i++)
+    {
+        if(is_key_(page->cells[i].key)) key_release_(page->cells[i].key); //values own nothing, see cow_hashtable.h
+    }
+    free(page);
+}
+
+static cell_t* slot_(cow_hashtable_t* hashtable, uint32_t idx) //local utility, read only
+{
+    return &hashtable->pages[idx / hashtable->page_slots]->cells[idx % hashtable->page_slots];
+}
+
+static cell_t* writable_slot_(cow_hashtable_t* hashtable, uint32_t idx) //local utility, clones the page if shared
+{
+    cow_page_t** page = &hashtable->pages[idx / hashtable->page_slots];
+    if(__atomic_load_n(&(*page)->refcount, __ATOMIC_ACQUIRE) > 1)
+    {
+        cow_page_t* clone = page_init_(hashtable->page_slots);
+        memcpy(clone->cells, (*page)->cells, sizeof(cell_t) * hashtable->page_slots);
+        for(uint32_t i = 0; i < hashtable->page_slots; i++) if(is_key_(clone->cells[i].key)) key_retain_(clone->cells[i].key);
+        page_release_(*page, hashtable->page_slots);
+        *page = clone;
+        if(hashtable_logs) hashtable_log(INFO, "cow_hashtable", "cloned shared page %u", idx / hashtable->page_slots);
+    }
+    return &(*page)->cells[idx % hashtable->page_slots];
+}
+
+static void pages_init_(cow_hashtable_t* hashtable, uint32_t capacity) //local utility
+{
+    hashtable->capacity = capacity;
+    hashtable->page_slots = capacity < COW_PAGE_SLOTS ? capacity : COW_PAGE_SLOTS;
+    hashtable->num_pages = capacity / hashtable->page_slots;
+    hashtable->pages = (cow_page_t**)malloc(sizeof(cow_page_t*) * hashtable->num_pages);
+    for(uint32_t p = 0; p < hashtable->num_pages; p++) hashtable->pages[p] = page_init_(hashtable->page_slots);
+}
+
+static void pages_release_(cow_hashtable_t* hashtable) //local utility
+{
+    for(uint32_t p = 0; p < hashtable->num_pages; p++) page_release_(hashtable->pages[p], hashtable->page_slots);
+    free(hashtable->pages);
+}
+
+//probe for key, returning its slot or -1 if absent. insert_idx is set to the slot the key would
+//be inserted in, the first tombstone of the chain if any.
+static int64_t find_slot_(cow_hashtable_t* hashtable, char* key, uint32_t key_hash, int64_t* insert_idx) //local utility
+{
+    *insert_idx = -1;
+    int probe = 0;
+
+    do
+    {
+        uint32_t idx = probe_idx(key_hash, probe, hashtable->capacity);
+
+        if(probe && idx == mod(key_hash, hashtable->capacity)) return -1; //full table cycle case
+
+        char* cur_key = slot_(hashtable, idx)->key;
+        if(cur_key == NULL)
+        {
+            if(*insert_idx < 0) *insert_idx = idx;
+            return -1;
+        }
+        if(cur_key == COW_TOMBSTONE)
+        {
+            if(*insert_idx < 0) *insert_idx = idx;
+        }
+        else if(key_hash_(cur_key) == key_hash && strcmp(cur_key, key) == 0) return idx;
+        probe++;
+    } while(true);
+}
+
+cow_hashtable_t* cow_hashtable_init(uint32_t capacity)
+{
+    bool capacity_is_not_power_of_2 = capacity & (capacity - 1);
+    if(capacity == 0 || capacity_is_not_power_of_2)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "cow_hashtable_init", "capacity %u must be nonzero and a power of two, aborting", capacity);
+        return NULL;
+    }
+
+    cow_hashtable_t* hashtable = (cow_hashtable_t*)malloc(sizeof(cow_hashtable_t));
+    hashtable->size = 0;
+    hashtable->tombstones = 0;
+    pages_init_(hashtable, capacity);
+
+    if(hashtable_logs) hashtable_log(INFO, "cow_hashtable_init", "created and initialized cow hashtable of capacity %u", capacity);
+    return hashtable;
+}
+
+void cow_hashtable_cleanup(cow_hashtable_t* hashtable)
+{
+    if(hashtable_logs) hashtable_log(INFO, "cow_hashtable_cleanup", "destroying cow hashtable of capacity %u with %u elements", hashtable->capacity, hashtable->size);
+    pages_release_(hashtable);
+    free(hashtable);
+}
+
+cow_hashtable_t* cow_hashtable_snapshot(cow_hashtable_t* hashtable)
+{
+    cow_hashtable_t* snapshot = (cow_hashtable_t*)malloc(sizeof(cow_hashtable_t));
+    *snapshot = *hashtable;
+    snapshot->pages = (cow_page_t**)malloc(sizeof(cow_page_t*) * hashtable->num_pages);
+    memcpy(snapshot->pages, hashtable->pages, sizeof(cow_page_t*) * hashtable->num_pages);
+    for(uint32_t p = 0; p < hashtable->num_pages; p++) __atomic_add_fetch(&hashtable->pages[p]->refcount, 1, __ATOMIC_RELAXED);
+
+    if(hashtable_logs) hashtable_log(INFO, "cow_hashtable_snapshot", "took snapshot of %u elements sharing %u pages", hashtable->size, hashtable->num_pages);
+    return snapshot;
+}
+
+uint32_t cow_hashtable_resize(cow_hashtable_t* hashtable, uint32_t new_capacity)
+{
+    if(new_capacity < hashtable->size)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "cow_hashtable_resize", "new capacity %u too small to hold current elements (%u), aborting", new_capacity, hashtable->size);
+        return hashtable->capacity;
+    }
+    bool capacity_is_not_power_of_2 = new_capacity & (new_capacity - 1);
+    if(new_capacity == 0 || capacity_is_not_power_of_2)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "cow_hashtable_resize", "new capacity %u is not a power of 2, aborting", new_capacity);
+        return hashtable->capacity;
+    }
+
+    //rehashing into the same capacity is allowed, it drops tombstones. old pages may still be
+    //shared, so keys are retained by the new pages before the old ones are released
+    cow_hashtable_t old = *hashtable;
+    pages_init_(hashtable, new_capacity);
+    hashtable->tombstones = 0;
+    for(uint32_t i = 0; i < old.capacity; i++)
+    {
+        cell_t cell = *slot_(&old, i);
+        if(!is_key_(cell.key)) continue;
+        uint32_t key_hash = key_hash_(cell.key);
+        int probe = 0;
+        uint32_t idx = mod(key_hash, new_capacity);
+        while(slot_(hashtable, idx)->key)
+        {
+            probe++;
+            idx = probe_idx(key_hash, probe, new_capacity);
+        }
+        key_retain_(cell.key);
+        *slot_(hashtable, idx) = cell;
+    }
+    pages_release_(&old);
+
+    if(hashtable_logs) hashtable_log(INFO, "cow_hashtable_resize", "resized cow hashtable to new capacity %u", new_capacity);
+    return new_capacity;
+}
+
+static STATUS insert_hashed_(cow_hashtable_t* hashtable, char* key, uint32_t key_hash, value_type value, bool auto_resize) //local utility
+{
+    if(hashtable->size == hashtable->capacity)
+    {
+        if(hashtable_logs) hashtable_log(WARN, "cow_hashtable_insert", "insertion of key '%s' failed, size has reached capacity %u", key, hashtable->capacity);
+        return HASHTABLE_FULL;
+    }
+
+    int64_t insert_idx;
+    if(find_slot_(hashtable, key, key_hash, &insert_idx) >= 0)
+    {
+        if(hashtable_logs) hashtable_log(WARN, "cow_hashtable_insert", "insertion of key '%s' failed, duplicate key found", key);
+        return DUPLICATE_KEY;
+    }
+    if(insert_idx < 0) //the chain went through every slot without a free one, only tombstones
+    {
+        cow_hashtable_resize(hashtable, hashtable->capacity);
+        find_slot_(hashtable, key, key_hash, &insert_idx);
+    }
+
+    cell_t* cell = writable_slot_(hashtable, (uint32_t)insert_idx);
+    if(cell->key == COW_TOMBSTONE) hashtable->tombstones--;
+    cell->key = key_new_(key, key_hash);
+    cell->value = value;
+    hashtable->size++;
+    if(hashtable_logs) hashtable_log(INFO, "cow_hashtable_insert", "insertion of key '%s' succeeded", key);
+
+    //tombstones lengthen probe chains just like keys, so they count towards the load factor
+    double load_factor = (double)(hashtable->size + hashtable->tombstones) / hashtable->capacity;
+    if(auto_resize && load_factor > MAX_LOAD_FACTOR && hashtable->capacity < 1u << 31)
+    {
+        bool mostly_tombstones = hashtable->tombstones > hashtable->size;
+        uint32_t new_capacity = mostly_tombstones ? hashtable->capacity : hashtable->capacity << 1;
+        if(hashtable_logs) hashtable_log(INFO, "cow_hashtable_insert", "insertion of key '%s' triggered resize to %u", key, new_capacity);
+        cow_hashtable_resize(hashtable, new_capacity);
+    }
+    return OK;
+}
+
+STATUS cow_hashtable_insert_(cow_hashtable_t* hashtable, char* key, value_type value, bool auto_resize)
+{
+    return insert_hashed_(hashtable, key, hash(key), value, auto_resize);
+}
+
+STATUS cow_hashtable_insert(cow_hashtable_t* hashtable, char* key, value_type value)
+{
+    return insert_hashed_(hashtable, key, hash(key), value, /*resize*/ true);
+}
+
+STATUS cow_hashtable_put(cow_hashtable_t* hashtable, char* key, value_type value)
+{
+    uint32_t key_hash = hash(key);
+    int64_t insert_idx;
+    int64_t found_idx = find_slot_(hashtable, key, key_hash, &insert_idx);
+    if(found_idx < 0) return insert_hashed_(hashtable, key, key_hash, value, /*resize*/ true);
+
+    writable_slot_(hashtable, (uint32_t)found_idx)->value = value;
+    if(hashtable_logs) hashtable_log(INFO, "cow_hashtable_put", "value of key '%s' overwritten", key);
+    return OK;
+}
+
+value_info_t cow_hashtable_lookup(cow_hashtable_t* hashtable, char* key)
+{
+    value_info_t lookup_result;
+    int64_t insert_idx;
+    int64_t found_idx = find_slot_(hashtable, key, hash(key), &insert_idx);
+    lookup_result.value = found_idx >= 0 ? &slot_(hashtable, (uint32_t)found_idx)->value : NULL;
+    lookup_result.status = found_idx >= 0 ? OK : KEY_NOT_FOUND;
+
+    if(hashtable_logs) hashtable_log(INFO, "cow_hashtable_lookup", "lookup of key '%s' %s", key, lookup_result.status == OK ? "succeeded" : "failed, not found");
+    return lookup_result;
+}
+
+STATUS cow_hashtable_delete(cow_hashtable_t* hashtable, char* key)
+{
+    int64_t insert_idx;
+    int64_t found_idx = find_slot_(hashtable, key, hash(key), &insert_idx);
+    if(found_idx < 0)
+    {
+        if(hashtable_logs) hashtable_log(WARN, "cow_hashtable_delete", "deletion of key '%s' failed, not found", key);
+        return KEY_NOT_FOUND;
+    }
+
+    cell_t* cell = writable_slot_(hashtable, (uint32_t)found_idx);
+    key_release_(cell->key);
+    cell->key = COW_TOMBSTONE;
+    hashtable->size--;
+    hashtable->tombstones++;
+
+    if(hashtable_logs) hashtable_log(INFO, "cow_hashtable_delete", "deletion of key '%s' succeeded", key);
+    return OK;
+}
+
+uint32_t cow_hashtable_for_each(cow_hashtable_t* hashtable, cow_visit_fn visit, void* arg)
+{
+    uint32_t num_visited = 0;
+    for(uint32_t p = 0; p < hashtable->num_pages; p++)
+    {
+        cell_t* cells = hashtable->pages[p]->cells;
+        for(uint32_t i = 0; i < hashtable->page_slots; i++)
+        {
+            if(!is_key_(cells[i].key)) continue;
+            visit(cells[i].key, cells[i].value, arg);
+            num_visited++;
+        }
+    }
+    return num_visited;
+}
+
+uint32_t cow_hashtable_shared_pages(cow_hashtable_t* hashtable)
+{
+    uint32_t num_shared = 0;
+    for(uint32_t p = 0; p < hashtable->num_pages; p++) num_shared += __atomic_load_n(&hashtable->pages[p]->refcount, __ATOMIC_ACQUIRE) > 1;
+    return num_shared;
+}
@@ -0,0 +1,91 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: string -> any hashtable with copy-on-write snapshots
+
+This header describes the interface to a copy-on-write hashtable, for taking consistent snapshots
+(ex for background reporting) while writers keep going.  Its slots are split into pages of
+COW_PAGE_SLOTS cells, and keys are refcounted.  cow_hashtable_snapshot doesn't copy any of them: the
+snapshot shares every page with the original, and a page is only cloned the first time either side
+writes to it while it's shared.  Cloning a page copies its cells and retains its keys, so memory
+only grows with the pages touched while the snapshot is alive, and a snapshot costs O(pages).
+
+It uses the same hash and probe sequence as hashtable_t, and deleted keys leave a tombstone.
+Every table (original or snapshot) must only be used by one thread at a time, but a snapshot can be
+read and cleaned up in another thread while the original is written, since shared pages and keys
+are never written and are refcounted atomically.
+NOTE: values are copied bit for bit when a page is cloned, so value_type must not own resources.
+*/
+
+#ifndef INCLUDE_COW_HASHTABLE_H
+#define INCLUDE_COW_HASHTABLE_H
+
+#include "hashtable.h"
+
+#define COW_PAGE_SLOTS 256
+
+//page of cells, shared by every table holding a reference to it. cells are stored right after it.
+typedef struct
+{
+    uint32_t refcount;
+    cell_t* cells;
+} cow_page_t;
+
+//struct to represent a copy-on-write hashtable, or a snapshot of one.
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t size;
+    uint32_t tombstones;
+    uint32_t page_slots; //COW_PAGE_SLOTS, or capacity if smaller
+    uint32_t num_pages;
+    cow_page_t** pages;
+} cow_hashtable_t;
+
+//callback called with every key value pair by cow_hashtable_for_each
+typedef void (*cow_visit_fn)(const char* key, value_type value, void* arg);
+
+//initialize a copy-on-write hashtable with passed capacity, which must be a power of 2.
+//returns a pointer to the new hashtable
+cow_hashtable_t* cow_hashtable_init(uint32_t capacity);
+
+//cleanup the passed copy-on-write hashtable or snapshot, releasing its pages.
+void cow_hashtable_cleanup(cow_hashtable_t* hashtable);
+
+//take a snapshot of the passed hashtable, sharing all of its pages.
+//returns a pointer to the snapshot, a cow_hashtable_t of its own to be cleaned up once done.
+cow_hashtable_t* cow_hashtable_snapshot(cow_hashtable_t* hashtable);
+
+//rehash the given hashtable into new_capacity slots, if possible, in new unshared pages.
+//returns the new capacity of the hashtable.
+uint32_t cow_hashtable_resize(cow_hashtable_t* hashtable, uint32_t new_capacity);
+
+//insert a key value pair into the passed hashtable, with a flag to control automatic resizing.
+//returns OK, DUPLICATE_KEY or HASHTABLE_FULL.
+STATUS cow_hashtable_insert_(cow_hashtable_t* hashtable, char* key, value_type value, bool auto_resize);
+
+//insert a key value pair into the passed hashtable, and automatically resize if need be.
+//returns OK, DUPLICATE_KEY or HASHTABLE_FULL.
+STATUS cow_hashtable_insert(cow_hashtable_t* hashtable, char* key, value_type value);
+
+//insert a key value pair, or overwrite the value of the key if it's already present.
+//returns OK or HASHTABLE_FULL.
+STATUS cow_hashtable_put(cow_hashtable_t* hashtable, char* key, value_type value);
+
+//lookup a key value pair in the passed hashtable
+//returns a value_info_t, with status and pointer to value if lookup succeeded (NULL otherwise).
+//NOTE: the value may be shared with snapshots, only read it and update it with cow_hashtable_put.
+value_info_t cow_hashtable_lookup(cow_hashtable_t* hashtable, char* key);
+
+//delete a key value pair in the passed hashtable
+//returns OK or KEY_NOT_FOUND.
+STATUS cow_hashtable_delete(cow_hashtable_t* hashtable, char* key);
+
+//call visit with every key value pair of the passed hashtable, in slot order.
+//returns the number of pairs visited.
+uint32_t cow_hashtable_for_each(cow_hashtable_t* hashtable, cow_visit_fn visit, void* arg);
+
+//returns the number of pages of the passed hashtable also referenced by another table.
+uint32_t cow_hashtable_shared_pages(cow_hashtable_t* hashtable);
+
+#endif //INCLUDE_COW_HASHTABLE_H
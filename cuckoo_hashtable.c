@@ -0,0 +1,369 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: impl of cuckoo hashtable methods outlined in cuckoo_hashtable.h
+*/
+
+#include "cuckoo_hashtable.h"
+#include "hashtable_internal.h"
+
+static cuckoo_bucket_t* buckets_init_(uint32_t num_buckets) //local utility, cache line aligned and empty
+{
+    size_t bytes = sizeof(cuckoo_bucket_t) * num_buckets;
+    bytes = (bytes + 63) & ~(size_t)63; //aligned_alloc wants a multiple of the alignment
+    cuckoo_bucket_t* buckets = (cuckoo_bucket_t*)aligned_alloc(64, bytes);
+    memset(buckets, 0, bytes);
+    return buckets;
+}
+
+//hash key with hash() and with a second, independent hash (FNV-1a) in one pass over it. keys
+//sharing hash() (easy to make, ex "Aa" and "B@") then still get different second buckets.
+//returns hash(key), with the second hash in tag.
+static uint32_t hashes_(char* key, uint32_t* tag) //local utility
+{
+    uint32_t val = HASHTABLE_SEED;
+    uint32_t fnv = 2166136261u;
+    int c;
+    while((c = *key++))
+    {
+        val = ((val << 5) + val) + c;
+        fnv = (fnv ^ (uint8_t)c) * 16777619u;
+    }
+    *tag = fnv;
+    return val;
+}
+
+static uint32_t primary_(cuckoo_hashtable_t* hashtable, uint32_t key_hash) //local utility
+{
+    //the low bits of hash() are too regular for similar keys, so take the high bits of a mix
+    uint32_t x = key_hash * 0x9E3779B1u;
+    return (uint32_t)(((uint64_t)x * hashtable->num_buckets) >> 32);
+}
+
+//the other bucket of a key is its bucket xor an offset picked by its tag, so either bucket leads
+//to the other from the tag alone and moves never need hash() again
+static uint32_t alternate_(cuckoo_hashtable_t* hashtable, uint32_t bucket, uint32_t tag) //local utility
+{
+    uint32_t x = tag;
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    uint32_t offset = x & (hashtable->num_buckets - 1);
+    if(offset == 0) offset = 1; //never the same bucket twice, unless there is a single one
+    return (bucket ^ offset) & (hashtable->num_buckets - 1);
+}
+
+static int free_slot_(cuckoo_bucket_t* bucket) //local utility, -1 if the bucket is full
+{
+    for(int s = 0; s < CUCKOO_BUCKET_SLOTS; s++) if(bucket->keys[s] == NULL) return s;
+    return -1;
+}
+
+static value_type* find_(cuckoo_hashtable_t* hashtable, char* key, uint32_t key_hash, uint32_t tag, cuckoo_bucket_t** found_bucket, int* found_slot) //local utility
+{
+    uint32_t primary = primary_(hashtable, key_hash);
+    uint32_t candidates[2] = {primary, alternate_(hashtable, primary, tag)};
+    for(int c = 0; c < 2; c++)
+    {
+        cuckoo_bucket_t* bucket = &hashtable->buckets[candidates[c]];
+        for(int s = 0; s < CUCKOO_BUCKET_SLOTS; s++)
+        {
+            if(bucket->hashes[s] != tag || bucket->keys[s] == NULL) continue;
+            if(strcmp(bucket->keys[s], key) == 0)
+            {
+                *found_bucket = bucket;
+                *found_slot = s;
+                return &bucket->values[s];
+            }
+        }
+    }
+    return NULL;
+}
+
+static void fill_slot_(cuckoo_bucket_t* bucket, int slot, char* key, uint32_t tag) //local utility
+{
+    bucket->keys[slot] = key;
+    bucket->hashes[slot] = tag;
+}
+
+//node of the breadth first search for a free slot, the bucket reached by moving the key in slot
+//of the parent's bucket to its other bucket
+typedef struct
+{
+    uint32_t bucket;
+    int32_t parent;
+    int32_t slot;
+} path_node_t;
+
+static void push_node_(path_node_t* nodes, int32_t* num_nodes, uint32_t bucket, int32_t parent, int32_t slot) //local utility
+{
+    path_node_t* node = &nodes[(*num_nodes)++];
+    node->bucket = bucket;
+    node->parent = parent;
+    node->slot = slot;
+}
+
+static bool on_path_(path_node_t* nodes, int32_t node, uint32_t bucket) //local utility
+{
+    for(; node >= 0; node = nodes[node].parent) if(nodes[node].bucket == bucket) return true;
+    return false;
+}
+
+//put a key known to be absent in one of its buckets, moving other keys out of the way if need be.
+//returns a pointer to its value, left for the caller to set, NULL if no free slot was found within
+//CUCKOO_MAX_PATH_NODES.
+static value_type* place_(cuckoo_hashtable_t* hashtable, char* key, uint32_t primary, uint32_t tag) //local utility
+{
+    path_node_t nodes[CUCKOO_MAX_PATH_NODES];
+    int32_t num_nodes = 0;
+    uint32_t candidates[2] = {primary, alternate_(hashtable, primary, tag)};
+    for(int c = 0; c < 2; c++)
+    {
+        cuckoo_bucket_t* bucket = &hashtable->buckets[candidates[c]];
+        int slot = free_slot_(bucket);
+        if(slot >= 0)
+        {
+            fill_slot_(bucket, slot, key, tag);
+            return &bucket->values[slot];
+        }
+        if(c == 0 || candidates[1] != candidates[0]) push_node_(nodes, &num_nodes, candidates[c], -1, -1);
+    }
+
+    for(int32_t head = 0; head < num_nodes; head++)
+    {
+        cuckoo_bucket_t* bucket = &hashtable->buckets[nodes[head].bucket];
+        for(int s = 0; s < CUCKOO_BUCKET_SLOTS; s++)
+        {
+            uint32_t next = alternate_(hashtable, nodes[head].bucket, bucket->hashes[s]);
+            if(on_path_(nodes, head, next)) continue;
+            int free_slot = free_slot_(&hashtable->buckets[next]);
+            if(free_slot < 0)
+            {
+                if(num_nodes < CUCKOO_MAX_PATH_NODES) push_node_(nodes, &num_nodes, next, head, s);
+                continue;
+            }
+
+            //found one, move every key of the path one step towards it, starting from its end
+            cuckoo_bucket_t* to = &hashtable->buckets[next];
+            int to_slot = free_slot;
+            int from_slot = s;
+            for(int32_t node = head; node >= 0; node = nodes[node].parent)
+            {
+                cuckoo_bucket_t* from = &hashtable->buckets[nodes[node].bucket];
+                //values are moved bit for bit, the emptied slot is never destroyed
+                fill_slot_(to, to_slot, from->keys[from_slot], from->hashes[from_slot]);
+                to->values[to_slot] = from->values[from_slot];
+                from->keys[from_slot] = NULL;
+                to = from;
+                to_slot = from_slot;
+                from_slot = nodes[node].slot;
+            }
+            fill_slot_(to, to_slot, key, tag);
+            return &to->values[to_slot];
+        }
+    }
+    return NULL;
+}
+
+cuckoo_hashtable_t* cuckoo_hashtable_init(uint32_t capacity)
+{
+    bool capacity_is_not_power_of_2 = capacity & (capacity - 1);
+    if(capacity == 0 || capacity_is_not_power_of_2)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "cuckoo_hashtable_init", "capacity %u must be nonzero and a power of two, aborting", capacity);
+        return NULL;
+    }
+
+    cuckoo_hashtable_t* hashtable = (cuckoo_hashtable_t*)malloc(sizeof(cuckoo_hashtable_t));
+    hashtable->num_buckets = capacity >= CUCKOO_BUCKET_SLOTS ? capacity / CUCKOO_BUCKET_SLOTS : 1;
+    hashtable->capacity = hashtable->num_buckets * CUCKOO_BUCKET_SLOTS;
+    hashtable->size = 0;
+    hashtable->buckets = buckets_init_(hashtable->num_buckets);
+
+    if(hashtable_logs) hashtable_log(INFO, "cuckoo_hashtable_init", "created and initialized cuckoo hashtable of capacity %u", hashtable->capacity);
+    return hashtable;
+}
+
+void cuckoo_hashtable_cleanup(cuckoo_hashtable_t* hashtable)
+{
+    if(hashtable_logs) hashtable_log(INFO, "cuckoo_hashtable_cleanup", "destroying cuckoo hashtable of capacity %u with %u elements", hashtable->capacity, hashtable->size);
+    cuckoo_hashtable_clear(hashtable);
+    free(hashtable->buckets);
+    free(hashtable);
+}
+
+uint32_t cuckoo_hashtable_resize(cuckoo_hashtable_t* hashtable, uint32_t new_capacity)
+{
+    if(new_capacity < hashtable->size)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "cuckoo_hashtable_resize", "new capacity %u too small to hold current elements (%u), aborting", new_capacity, hashtable->size);
+        return hashtable->capacity;
+    }
+    bool capacity_is_not_power_of_2 = new_capacity & (new_capacity - 1);
+    if(new_capacity == 0 || capacity_is_not_power_of_2)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "cuckoo_hashtable_resize", "new capacity %u is not a power of 2, aborting", new_capacity);
+        return hashtable->capacity;
+    }
+
+    //keys stay owned by the old buckets until every one of them found a place in the new ones.
+    //their primary bucket depends on the number of buckets, so this is the one place keys are
+    //hashed again
+    cuckoo_hashtable_t tmp_hashtable;
+    bool placed_all = false;
+    for(int growth = 0; !placed_all; growth++)
+    {
+        tmp_hashtable.num_buckets = new_capacity >= CUCKOO_BUCKET_SLOTS ? new_capacity / CUCKOO_BUCKET_SLOTS : 1;
+        tmp_hashtable.capacity = tmp_hashtable.num_buckets * CUCKOO_BUCKET_SLOTS;
+        tmp_hashtable.buckets = buckets_init_(tmp_hashtable.num_buckets);
+        placed_all = true;
+        for(uint32_t b = 0; b < hashtable->num_buckets && placed_all; b++)
+        {
+            cuckoo_bucket_t* bucket = &hashtable->buckets[b];
+            for(int s = 0; s < CUCKOO_BUCKET_SLOTS && placed_all; s++)
+            {
+                if(bucket->keys[s] == NULL) continue;
+                uint32_t primary = primary_(&tmp_hashtable, hash(bucket->keys[s]));
+                value_type* value = place_(&tmp_hashtable, bucket->keys[s], primary, bucket->hashes[s]);
+                placed_all = value != NULL;
+                if(placed_all) *value = bucket->values[s];
+            }
+        }
+        if(placed_all) break;
+
+        free(tmp_hashtable.buckets);
+        //keys colliding on both hashes fit in no capacity, so only try a few doublings
+        if(growth + 1 >= CUCKOO_MAX_GROWTH || tmp_hashtable.capacity >= 1u << 31)
+        {
+            if(hashtable_logs) hashtable_log(ERROR, "cuckoo_hashtable_resize", "keys don't fit in capacity %u, aborting", tmp_hashtable.capacity);
+            return hashtable->capacity;
+        }
+        if(hashtable_logs) hashtable_log(WARN, "cuckoo_hashtable_resize", "keys don't fit in capacity %u, doubling it", new_capacity);
+        new_capacity = tmp_hashtable.capacity << 1;
+    }
+    free(hashtable->buckets);
+    hashtable->buckets = tmp_hashtable.buckets;
+    hashtable->num_buckets = tmp_hashtable.num_buckets;
+    hashtable->capacity = tmp_hashtable.capacity;
+
+    if(hashtable_logs) hashtable_log(INFO, "cuckoo_hashtable_resize", "resized cuckoo hashtable to new capacity %u", hashtable->capacity);
+    return hashtable->capacity;
+}
+
+uint32_t cuckoo_hashtable_clear(cuckoo_hashtable_t* hashtable)
+{
+    uint32_t num_deletions = hashtable->size;
+    for(uint32_t b = 0; b < hashtable->num_buckets; b++)
+    {
+        cuckoo_bucket_t* bucket = &hashtable->buckets[b];
+        for(int s = 0; s < CUCKOO_BUCKET_SLOTS; s++)
+        {
+            if(bucket->keys[s] == NULL) continue;
+            free(bucket->keys[s]);
+            bucket->keys[s] = NULL;
+            HASHTABLE_VALUE_DESTROY(bucket->values[s]);
+        }
+    }
+    hashtable->size = 0;
+
+    if(hashtable_logs) hashtable_log(INFO, "cuckoo_hashtable_clear", "cleared %u elements from cuckoo hashtable", num_deletions);
+    return num_deletions;
+}
+
+value_info_t cuckoo_hashtable_insert_(cuckoo_hashtable_t* hashtable, char* key, value_type value, bool auto_resize)
+{
+    value_info_t insertion_result;
+    uint32_t tag;
+    uint32_t key_hash = hashes_(key, &tag);
+    cuckoo_bucket_t* bucket;
+    int slot;
+
+    insertion_result.value = find_(hashtable, key, key_hash, tag, &bucket, &slot);
+    if(insertion_result.value)
+    {
+        insertion_result.status = DUPLICATE_KEY;
+        if(hashtable_logs) hashtable_log(WARN, "cuckoo_hashtable_insert", "insertion of key '%s' failed, duplicate key found", key);
+        return insertion_result;
+    }
+
+    double load_factor = (double)(hashtable->size + 1) / hashtable->capacity;
+    if(auto_resize && load_factor > CUCKOO_MAX_LOAD_FACTOR && hashtable->capacity < 1u << 31)
+    {
+        if(hashtable_logs) hashtable_log(INFO, "cuckoo_hashtable_insert", "insertion of key '%s' triggered resize to %u", key, hashtable->capacity << 1);
+        cuckoo_hashtable_resize(hashtable, hashtable->capacity << 1);
+    }
+
+    size_t key_len = strlen(key);
+    char* copy = (char*)malloc(key_len + 1);
+    memcpy(copy, key, key_len + 1);
+
+    insertion_result.value = place_(hashtable, copy, primary_(hashtable, key_hash), tag);
+    for(int growth = 0; insertion_result.value == NULL && auto_resize && growth < CUCKOO_MAX_GROWTH; growth++)
+    {
+        uint32_t capacity = hashtable->capacity;
+        if(capacity >= 1u << 31) break;
+        if(hashtable_logs) hashtable_log(INFO, "cuckoo_hashtable_insert", "no free slot for key '%s', resizing to %u", key, capacity << 1);
+        if(cuckoo_hashtable_resize(hashtable, capacity << 1) == capacity) break;
+        insertion_result.value = place_(hashtable, copy, primary_(hashtable, key_hash), tag);
+    }
+    if(insertion_result.value == NULL)
+    {
+        free(copy);
+        insertion_result.status = HASHTABLE_FULL;
+        if(hashtable_logs) hashtable_log(WARN, "cuckoo_hashtable_insert", "insertion of key '%s' failed, no free slot found", key);
+        return insertion_result;
+    }
+
+    HASHTABLE_VALUE_COPY(insertion_result.value, value);
+    hashtable->size++;
+    insertion_result.status = OK;
+    if(hashtable_logs) hashtable_log(INFO, "cuckoo_hashtable_insert", "insertion of key '%s' succeeded", key);
+    return insertion_result;
+}
+
+value_info_t cuckoo_hashtable_insert(cuckoo_hashtable_t* hashtable, char* key, value_type value)
+{
+    return cuckoo_hashtable_insert_(hashtable, key, value, /*resize*/ true);
+}
+
+value_info_t cuckoo_hashtable_lookup(cuckoo_hashtable_t* hashtable, char* key)
+{
+    value_info_t lookup_result;
+    cuckoo_bucket_t* bucket;
+    int slot;
+
+    uint32_t tag;
+    uint32_t key_hash = hashes_(key, &tag);
+    lookup_result.value = find_(hashtable, key, key_hash, tag, &bucket, &slot);
+    lookup_result.status = lookup_result.value ? OK : KEY_NOT_FOUND;
+    if(hashtable_logs) hashtable_log(INFO, "cuckoo_hashtable_lookup", "lookup of key '%s' %s", key, lookup_result.status == OK ? "succeeded" : "failed, not found");
+    return lookup_result;
+}
+
+value_info_t cuckoo_hashtable_delete(cuckoo_hashtable_t* hashtable, char* key)
+{
+    value_info_t lookup_result;
+    cuckoo_bucket_t* bucket;
+    int slot;
+
+    uint32_t tag;
+    uint32_t key_hash = hashes_(key, &tag);
+    lookup_result.value = NULL;
+    if(find_(hashtable, key, key_hash, tag, &bucket, &slot) == NULL)
+    {
+        lookup_result.status = KEY_NOT_FOUND;
+        if(hashtable_logs) hashtable_log(WARN, "cuckoo_hashtable_delete", "deletion of key '%s' failed, not found", key);
+        return lookup_result;
+    }
+
+    free(bucket->keys[slot]);
+    bucket->keys[slot] = NULL;
+    HASHTABLE_VALUE_DESTROY(bucket->values[slot]);
+    hashtable->size--;
+
+    lookup_result.status = OK;
+    if(hashtable_logs) hashtable_log(INFO, "cuckoo_hashtable_delete", "deletion of key '%s' succeeded", key);
+    return lookup_result;
+}
@@ -0,0 +1,85 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: string -> any hashtable with bucketized cuckoo hashing
+
+This header describes the interface to a cuckoo hashtable, for lookups that need a bounded worst
+case.  Slots are grouped in buckets of 4, and every key lives in one of exactly two buckets: one
+picked by hash(), the other by xoring it with an offset picked by a second, independent hash of
+the key (FNV-1a), so keys colliding on hash() still spread over different second buckets.  A
+lookup reads at most those two buckets, each the size of a cache line with int values, whatever
+the load or the keys.
+
+When both buckets of a new key are full, insert searches (breadth first, up to
+CUCKOO_MAX_PATH_NODES buckets) for the shortest chain of keys that can each move to their other
+bucket to free a slot, and moves them.  This keeps working up to loads of about 0.95, past which
+(or when no chain is found) the hashtable doubles, up to CUCKOO_MAX_GROWTH times before insert
+gives up with HASHTABLE_FULL (more than 8 keys colliding on both hashes fit in no capacity).
+Buckets store the second hash of their keys, so moves never hash keys again, only resizes do.
+
+It uses the same status codes as hashtable_t, deletes need no tombstones.
+Keys are memory managed by the hashtable, values go through HASHTABLE_VALUE_COPY and
+HASHTABLE_VALUE_DESTROY as in hashtable_t (moves between buckets are bit for bit).
+*/
+
+#ifndef INCLUDE_CUCKOO_HASHTABLE_H
+#define INCLUDE_CUCKOO_HASHTABLE_H
+
+#include "hashtable.h"
+
+#define CUCKOO_BUCKET_SLOTS 4
+#define CUCKOO_MAX_LOAD_FACTOR 0.95
+#define CUCKOO_MAX_PATH_NODES 512 //buckets visited looking for a free slot before giving up
+#define CUCKOO_MAX_GROWTH 4 //doublings tried to place keys that don't fit before giving up
+
+//bucket of a cuckoo hashtable, 64 bytes with int values.
+typedef struct
+{
+    uint32_t hashes[CUCKOO_BUCKET_SLOTS]; //second hash of the keys, see the top of the file
+    char* keys[CUCKOO_BUCKET_SLOTS]; //NULL for empty slots
+    value_type values[CUCKOO_BUCKET_SLOTS];
+} cuckoo_bucket_t;
+
+//struct to represent a cuckoo hashtable.
+typedef struct
+{
+    uint32_t capacity;    //number of slots, CUCKOO_BUCKET_SLOTS per bucket
+    uint32_t size;
+    uint32_t num_buckets;
+    cuckoo_bucket_t* buckets;
+} cuckoo_hashtable_t;
+
+//initialize a cuckoo hashtable with passed capacity (in slots), which must be a power of 2.
+//returns a pointer to the new hashtable
+cuckoo_hashtable_t* cuckoo_hashtable_init(uint32_t capacity);
+
+//cleanup the passed cuckoo hashtable.
+void cuckoo_hashtable_cleanup(cuckoo_hashtable_t* hashtable);
+
+//rehash the given cuckoo hashtable into new_capacity slots, if possible. the capacity is doubled
+//further if the keys can't all be placed, up to CUCKOO_MAX_GROWTH times.
+//returns the new capacity of the hashtable (unchanged if the keys could not be placed).
+uint32_t cuckoo_hashtable_resize(cuckoo_hashtable_t* hashtable, uint32_t new_capacity);
+
+//clear the given cuckoo hashtable, making it empty.
+//returns the number of deleted items.
+uint32_t cuckoo_hashtable_clear(cuckoo_hashtable_t* hashtable);
+
+//insert a key value pair into the passed cuckoo hashtable, with a flag to control automatic
+//resizing. without it, HASHTABLE_FULL is returned when no slot can be freed for the key.
+//returns a value_info_t, with status and pointer to value if insertion succeeded (NULL otherwise).
+value_info_t cuckoo_hashtable_insert_(cuckoo_hashtable_t* hashtable, char* key, value_type value, bool auto_resize);
+
+//insert a key value pair into the passed cuckoo hashtable, and automatically resize if need be.
+//returns a value_info_t, with status and pointer to value if insertion succeeded (NULL otherwise).
+value_info_t cuckoo_hashtable_insert(cuckoo_hashtable_t* hashtable, char* key, value_type value);
+
+//lookup a key value pair in the passed cuckoo hashtable, reading at most two buckets.
+//returns a value_info_t, with status and pointer to value if lookup succeeded (NULL otherwise).
+value_info_t cuckoo_hashtable_lookup(cuckoo_hashtable_t* hashtable, char* key);
+
+//delete a key value pair in the passed cuckoo hashtable
+//returns a value_info_t, with status of deletion (value pointer always NULL)
+value_info_t cuckoo_hashtable_delete(cuckoo_hashtable_t* hashtable, char* key);
+
+#endif //INCLUDE_CUCKOO_HASHTABLE_H
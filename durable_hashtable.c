@@ -0,0 +1,589 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: impl of durable hashtable methods outlined in durable_hashtable.h
+*/
+
+#include "durable_hashtable.h"
+#include "hashtable_internal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+//record layout: checksum (4) | type (1) | key length (4) | value (puts only) | key, no '\0'
+#define RECORD_PUT 1
+#define RECORD_DELETE 2
+#define RECORD_HEADER_BYTES 9
+
+//header at the start of every log
+typedef struct
+{
+    uint64_t magic;
+    uint32_t value_size; //sizeof(value_type) of the build that wrote the log
+    uint32_t reserved;
+} wal_header_t;
+
+//header at the start of a snapshot, followed by a put record per key
+typedef struct
+{
+    uint64_t magic;
+    uint32_t value_size;
+    uint32_t reserved;
+    uint64_t log_gen; //first log written after the snapshot was taken
+    uint64_t size;
+} snapshot_header_t;
+
+//what a compactor thread needs, owned by the thread
+typedef struct
+{
+    durable_hashtable_t* durable;
+    hashtable_t* copy;
+    uint64_t log_gen;
+} compaction_job_t;
+
+durability_policy_t durability_policy_default(void)
+{
+    durability_policy_t policy;
+    policy.mode = DURABILITY_GROUP;
+    policy.commit_interval_ms = 10;
+    policy.commit_bytes = 1 << 16;
+    policy.compact_bytes = 1ull << 26;
+    return policy;
+}
+
+static uint32_t checksum_(const char* data, size_t bytes) //local utility, FNV-1a
+{
+    uint32_t val = 2166136261u;
+    for(size_t i = 0; i < bytes; i++) val = (val ^ (uint8_t)data[i]) * 16777619u;
+    return val;
+}
+
+static void buffer_reserve_(wal_buffer_t* buffer, size_t bytes) //local utility
+{
+    if(buffer->size + bytes <= buffer->capacity) return;
+    size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+    while(capacity < buffer->size + bytes) capacity <<= 1;
+    buffer->data = (char*)realloc(buffer->data, capacity);
+    buffer->capacity = capacity;
+}
+
+static void append_record_(wal_buffer_t* buffer, uint8_t type, char* key, value_type* value) //local utility
+{
+    uint32_t key_len = (uint32_t)strlen(key);
+    size_t value_bytes = type == RECORD_PUT ? sizeof(value_type) : 0;
+    size_t bytes = RECORD_HEADER_BYTES + value_bytes + key_len;
+    buffer_reserve_(buffer, bytes);
+
+    char* record = buffer->data + buffer->size;
+    record[4] = (char)type;
+    memcpy(record + 5, &key_len, sizeof(uint32_t));
+    if(value_bytes) memcpy(record + RECORD_HEADER_BYTES, value, value_bytes);
+    memcpy(record + RECORD_HEADER_BYTES + value_bytes, key, key_len);
+    uint32_t checksum = checksum_(record + 4, bytes - 4);
+    memcpy(record, &checksum, sizeof(uint32_t));
+    buffer->size += bytes;
+}
+
+static cell_info_t put_(hashtable_t* table, char* key, value_type value) //local utility
+{
+    cell_info_t result = hashtable_lookup(table, key);
+    if(result.status == OK)
+    {
+        result.cell->value = value; //values own nothing, see durable_hashtable.h
+        return result;
+    }
+    return hashtable_insert(table, key, value);
+}
+
+//apply every valid record of data to table, stopping at the first torn or corrupted one.
+//returns the number of bytes of valid records.
+static size_t replay_records_(hashtable_t* table, const char* data, size_t bytes) //local utility
+{
+    size_t offset = 0;
+    char* key = NULL;
+    size_t key_capacity = 0;
+
+    while(offset + RECORD_HEADER_BYTES <= bytes)
+    {
+        const char* record = data + offset;
+        uint32_t checksum, key_len;
+        uint8_t type = (uint8_t)record[4];
+        memcpy(&checksum, record, sizeof(uint32_t));
+        memcpy(&key_len, record + 5, sizeof(uint32_t));
+        if(type != RECORD_PUT && type != RECORD_DELETE) break;
+
+        size_t value_bytes = type == RECORD_PUT ? sizeof(value_type) : 0;
+        if(key_len > bytes || bytes - offset - RECORD_HEADER_BYTES < value_bytes + key_len) break;
+        size_t record_bytes = RECORD_HEADER_BYTES + value_bytes + key_len;
+        if(checksum_(record + 4, record_bytes - 4) != checksum) break;
+
+        if(key_len + 1 > key_capacity)
+        {
+            key_capacity = key_len + 1;
+            key = (char*)realloc(key, key_capacity);
+        }
+        memcpy(key, record + RECORD_HEADER_BYTES + value_bytes, key_len);
+        key[key_len] = '\0';
+
+        if(type == RECORD_PUT)
+        {
+            value_type value;
+            memcpy(&value, record + RECORD_HEADER_BYTES, sizeof(value_type));
+            put_(table, key, value);
+        }
+        else hashtable_delete(table, key);
+        offset += record_bytes;
+    }
+
+    free(key);
+    return offset;
+}
+
+static char* read_file_(const char* path, size_t* bytes) //local utility, NULL if path can't be read
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return NULL;
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) != 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    char* data = (char*)malloc(file_stat.st_size + 1);
+    size_t done = 0;
+    while(done < (size_t)file_stat.st_size)
+    {
+        ssize_t got = read(fd, data + done, file_stat.st_size - done);
+        if(got <= 0) break;
+        done += got;
+    }
+    close(fd);
+    *bytes = done;
+    return data;
+}
+
+static bool write_all_(int fd, const char* data, size_t bytes) //local utility
+{
+    while(bytes)
+    {
+        ssize_t put = write(fd, data, bytes);
+        if(put < 0 && errno == EINTR) continue;
+        if(put <= 0) return false;
+        data += put;
+        bytes -= put;
+    }
+    return true;
+}
+
+static void sync_dir_(const char* dir) //local utility, makes created/renamed/removed files durable
+{
+    int fd = open(dir, O_RDONLY);
+    if(fd < 0) return;
+    fsync(fd);
+    close(fd);
+}
+
+static void log_path_(durable_hashtable_t* durable, uint64_t gen, char* path, size_t path_bytes) //local utility
+{
+    snprintf(path, path_bytes, "%s/wal.%016llx", durable->dir, (unsigned long long)gen);
+}
+
+//open (or create) the log of generation gen for appending, with a valid header.
+//returns the file descriptor, -1 on failure.
+static int open_log_(durable_hashtable_t* durable, uint64_t gen, uint64_t* log_bytes) //local utility
+{
+    char path[4096];
+    log_path_(durable, gen, path, sizeof(path));
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if(fd < 0) return -1;
+
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    if((size_t)file_stat.st_size < sizeof(wal_header_t)) //new, or torn before its header was written
+    {
+        wal_header_t header = {WAL_MAGIC, (uint32_t)sizeof(value_type), 0};
+        if(ftruncate(fd, 0) != 0 || !write_all_(fd, (char*)&header, sizeof(header)) || fdatasync(fd) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+        sync_dir_(durable->dir);
+        *log_bytes = sizeof(header);
+        return fd;
+    }
+    *log_bytes = file_stat.st_size;
+    return fd;
+}
+
+//commit the pending records to the log, fsyncing it if sync. the lock is released while writing so
+//records can keep being appended, but only one commit runs at a time.
+//returns true if the commit succeeded.
+static bool commit_locked_(durable_hashtable_t* durable, bool sync) //local utility, called with lock held
+{
+    while(durable->committing) pthread_cond_wait(&durable->committed, &durable->lock);
+    if(durable->pending.size == 0 && !sync) return !durable->io_failed;
+
+    wal_buffer_t swap = durable->writing;
+    durable->writing = durable->pending;
+    durable->pending = swap;
+    durable->pending.size = 0;
+    durable->committing = true;
+    int fd = durable->log_fd;
+    pthread_mutex_unlock(&durable->lock);
+
+    bool committed = write_all_(fd, durable->writing.data, durable->writing.size);
+    if(committed && sync) committed = fdatasync(fd) == 0;
+
+    pthread_mutex_lock(&durable->lock);
+    if(committed) durable->log_bytes += durable->writing.size;
+    else
+    {
+        durable->io_failed = true;
+        if(hashtable_logs) hashtable_log(ERROR, "durable_hashtable_commit", "could not commit %zu bytes to the log in '%s'", durable->writing.size, durable->dir);
+    }
+    durable->writing.size = 0;
+    durable->commits++;
+    durable->committing = false;
+    pthread_cond_broadcast(&durable->committed);
+    return committed;
+}
+
+static void* committer_main_(void* arg) //local utility, commits batches of records in group mode
+{
+    durable_hashtable_t* durable = (durable_hashtable_t*)arg;
+    pthread_mutex_lock(&durable->lock);
+    while(true)
+    {
+        if(durable->pending.size == 0)
+        {
+            if(durable->stopping) break;
+            pthread_cond_wait(&durable->wake, &durable->lock);
+            continue;
+        }
+
+        //the oldest pending record waits at most commit_interval_ms
+        struct timespec deadline = durable->first_pending_at;
+        uint64_t nsec = deadline.tv_nsec + (uint64_t)durable->policy.commit_interval_ms * 1000000;
+        deadline.tv_sec += nsec / 1000000000;
+        deadline.tv_nsec = nsec % 1000000000;
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        bool due = now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec);
+
+        if(durable->stopping || due || durable->pending.size >= durable->policy.commit_bytes) commit_locked_(durable, /*sync*/ true);
+        else pthread_cond_timedwait(&durable->wake, &durable->lock, &deadline);
+    }
+    pthread_mutex_unlock(&durable->lock);
+    return NULL;
+}
+
+static void* compactor_main_(void* arg) //local utility, writes a snapshot then removes old logs
+{
+    compaction_job_t* job = (compaction_job_t*)arg;
+    durable_hashtable_t* durable = job->durable;
+    char path[4096], tmp_path[4096];
+    snprintf(path, sizeof(path), "%s/snapshot", durable->dir);
+    snprintf(tmp_path, sizeof(tmp_path), "%s/snapshot.tmp", durable->dir);
+
+    bool written = false;
+    FILE* file = fopen(tmp_path, "wb");
+    if(file)
+    {
+        snapshot_header_t header = {SNAPSHOT_MAGIC, (uint32_t)sizeof(value_type), 0, job->log_gen, job->copy->size};
+        written = fwrite(&header, sizeof(header), 1, file) == 1;
+
+        wal_buffer_t buffer = {NULL, 0, 0};
+        for(uint32_t i = 0; i < job->copy->capacity && written; i++)
+        {
+            cell_t* cell = &job->copy->data[i];
+            if(cell->key) append_record_(&buffer, RECORD_PUT, cell->key, &cell->value);
+            if(buffer.size >= (1 << 20) || (i + 1 == job->copy->capacity && buffer.size))
+            {
+                written = fwrite(buffer.data, 1, buffer.size, file) == buffer.size;
+                buffer.size = 0;
+            }
+        }
+        free(buffer.data);
+        written &= fflush(file) == 0 && fsync(fileno(file)) == 0;
+        written &= fclose(file) == 0;
+    }
+    written = written && rename(tmp_path, path) == 0;
+
+    if(written)
+    {
+        sync_dir_(durable->dir);
+        for(uint64_t gen = durable->snapshot_gen; gen < job->log_gen; gen++)
+        {
+            log_path_(durable, gen, path, sizeof(path));
+            unlink(path);
+        }
+        durable->snapshot_gen = job->log_gen;
+        if(hashtable_logs) hashtable_log(INFO, "durable_hashtable_compact", "wrote snapshot of %u keys to '%s'", job->copy->size, durable->dir);
+    }
+    else
+    {
+        unlink(tmp_path);
+        if(hashtable_logs) hashtable_log(ERROR, "durable_hashtable_compact", "could not write snapshot to '%s', keeping the logs", durable->dir);
+    }
+
+    hashtable_cleanup(job->copy);
+    free(job);
+    pthread_mutex_lock(&durable->lock);
+    durable->compacting = false;
+    pthread_mutex_unlock(&durable->lock);
+    return NULL;
+}
+
+//rebuild the hashtable from the snapshot and logs in the directory, and open the last log.
+//returns true if everything found was valid.
+static bool recover_(durable_hashtable_t* durable) //local utility
+{
+    char path[4096];
+    size_t bytes;
+    snprintf(path, sizeof(path), "%s/snapshot", durable->dir);
+    char* data = read_file_(path, &bytes);
+    if(data)
+    {
+        snapshot_header_t header;
+        bool valid = bytes >= sizeof(header);
+        if(valid) memcpy(&header, data, sizeof(header));
+        valid = valid && header.magic == SNAPSHOT_MAGIC && header.value_size == sizeof(value_type);
+        valid = valid && replay_records_(durable->table, data + sizeof(header), bytes - sizeof(header)) == bytes - sizeof(header);
+        free(data);
+        if(!valid)
+        {
+            if(hashtable_logs) hashtable_log(ERROR, "durable_hashtable_open", "snapshot in '%s' is not valid", durable->dir);
+            return false;
+        }
+        durable->snapshot_gen = header.log_gen;
+    }
+
+    //replay every log from the snapshot on, the last one is kept appending
+    durable->log_gen = durable->snapshot_gen;
+    for(uint64_t gen = durable->snapshot_gen;; gen++)
+    {
+        log_path_(durable, gen, path, sizeof(path));
+        data = read_file_(path, &bytes);
+        if(data == NULL) break;
+        durable->log_gen = gen;
+        wal_header_t header;
+        if(bytes >= sizeof(header))
+        {
+            memcpy(&header, data, sizeof(header));
+            if(header.magic != WAL_MAGIC || header.value_size != sizeof(value_type))
+            {
+                free(data);
+                if(hashtable_logs) hashtable_log(ERROR, "durable_hashtable_open", "log '%s' is not valid", path);
+                return false;
+            }
+            size_t valid = replay_records_(durable->table, data + sizeof(header), bytes - sizeof(header));
+            if(valid < bytes - sizeof(header)) //torn tail, dropped so new records follow valid ones
+            {
+                if(hashtable_logs) hashtable_log(WARN, "durable_hashtable_open", "dropping %zu bytes of torn records from '%s'", bytes - sizeof(header) - valid, path);
+                if(truncate(path, sizeof(header) + valid) != 0)
+                {
+                    free(data);
+                    return false;
+                }
+            }
+        }
+        free(data);
+    }
+
+    //logs already covered by the snapshot, left over if a compaction was interrupted
+    for(uint64_t gen = durable->snapshot_gen; gen-- > 0;)
+    {
+        log_path_(durable, gen, path, sizeof(path));
+        if(unlink(path) != 0) break;
+    }
+
+    durable->log_fd = open_log_(durable, durable->log_gen, &durable->log_bytes);
+    return durable->log_fd >= 0;
+}
+
+durable_hashtable_t* durable_hashtable_open(const char* dir, durability_policy_t policy)
+{
+    if(mkdir(dir, 0755) != 0 && errno != EEXIST)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "durable_hashtable_open", "could not create directory '%s'", dir);
+        return NULL;
+    }
+
+    durable_hashtable_t* durable = (durable_hashtable_t*)calloc(1, sizeof(durable_hashtable_t));
+    durable->dir = (char*)malloc(strlen(dir) + 1);
+    strcpy(durable->dir, dir);
+    durable->policy = policy;
+    durable->table = hashtable_init(1);
+    hashtable_enable_expiry(durable->table, NULL); //deletes leave tombstones
+    durable->log_fd = -1;
+
+    if(!recover_(durable))
+    {
+        if(durable->log_fd >= 0) close(durable->log_fd);
+        hashtable_cleanup(durable->table);
+        free(durable->dir);
+        free(durable);
+        return NULL;
+    }
+
+    pthread_mutex_init(&durable->lock, NULL);
+    pthread_cond_init(&durable->wake, NULL);
+    pthread_cond_init(&durable->committed, NULL);
+    if(policy.mode == DURABILITY_GROUP) pthread_create(&durable->committer, NULL, committer_main_, durable);
+
+    if(hashtable_logs) hashtable_log(INFO, "durable_hashtable_open", "opened '%s' with %u keys", dir, durable->table->size);
+    return durable;
+}
+
+void durable_hashtable_close(durable_hashtable_t* durable)
+{
+    if(hashtable_logs) hashtable_log(INFO, "durable_hashtable_close", "closing '%s' with %u keys", durable->dir, durable->table->size);
+    pthread_mutex_lock(&durable->lock);
+    durable->stopping = true;
+    pthread_cond_signal(&durable->wake);
+    pthread_mutex_unlock(&durable->lock);
+    if(durable->policy.mode == DURABILITY_GROUP) pthread_join(durable->committer, NULL);
+    durable_hashtable_sync(durable);
+    if(durable->compactor_started) pthread_join(durable->compactor, NULL);
+
+    close(durable->log_fd);
+    pthread_mutex_destroy(&durable->lock);
+    pthread_cond_destroy(&durable->wake);
+    pthread_cond_destroy(&durable->committed);
+    free(durable->pending.data);
+    free(durable->writing.data);
+    hashtable_cleanup(durable->table);
+    free(durable->dir);
+    free(durable);
+}
+
+//log a record of a change already made to the hashtable.
+//returns false if the change must be undone, because a DURABILITY_SYNC commit of it failed.
+static bool log_record_(durable_hashtable_t* durable, uint8_t type, char* key, value_type* value) //local utility
+{
+    pthread_mutex_lock(&durable->lock);
+    bool was_empty = durable->pending.size == 0;
+    if(was_empty) clock_gettime(CLOCK_REALTIME, &durable->first_pending_at);
+    append_record_(&durable->pending, type, key, value);
+
+    bool committed = true;
+    switch(durable->policy.mode)
+    {
+        case DURABILITY_SYNC:
+            committed = commit_locked_(durable, /*sync*/ true);
+            break;
+        case DURABILITY_GROUP: //wake the committer to start the interval, or early once enough is buffered
+            if(was_empty || durable->pending.size >= durable->policy.commit_bytes) pthread_cond_signal(&durable->wake);
+            break;
+        case DURABILITY_NONE:
+            if(durable->pending.size >= durable->policy.commit_bytes) commit_locked_(durable, /*sync*/ false);
+            break;
+    }
+
+    bool compact = committed && durable->policy.compact_bytes && !durable->compacting && durable->log_bytes >= durable->policy.compact_bytes;
+    pthread_mutex_unlock(&durable->lock);
+    if(compact) durable_hashtable_compact(durable);
+    return committed;
+}
+
+static cell_info_t io_error_(void) //local utility
+{
+    cell_info_t result = {NULL, IO_ERROR};
+    return result;
+}
+
+cell_info_t durable_hashtable_insert(durable_hashtable_t* durable, char* key, value_type value)
+{
+    cell_info_t insertion_result = hashtable_insert(durable->table, key, value);
+    if(insertion_result.status == OK && !log_record_(durable, RECORD_PUT, key, &value))
+    {
+        hashtable_delete(durable->table, key);
+        return io_error_();
+    }
+    return insertion_result;
+}
+
+cell_info_t durable_hashtable_put(durable_hashtable_t* durable, char* key, value_type value)
+{
+    //keep what the key held, to put it back if the change can't be committed
+    cell_info_t previous = hashtable_lookup(durable->table, key);
+    value_type previous_value;
+    if(previous.status == OK) previous_value = previous.cell->value;
+
+    cell_info_t put_result = put_(durable->table, key, value);
+    if(put_result.status == OK && !log_record_(durable, RECORD_PUT, key, &value))
+    {
+        if(previous.status == OK) put_result.cell->value = previous_value;
+        else hashtable_delete(durable->table, key);
+        return io_error_();
+    }
+    return put_result;
+}
+
+cell_info_t durable_hashtable_delete(durable_hashtable_t* durable, char* key)
+{
+    cell_info_t previous = hashtable_lookup(durable->table, key);
+    if(previous.status != OK) return hashtable_delete(durable->table, key);
+    value_type previous_value = previous.cell->value;
+
+    cell_info_t deletion_result = hashtable_delete(durable->table, key);
+    if(deletion_result.status == OK && !log_record_(durable, RECORD_DELETE, key, NULL))
+    {
+        hashtable_insert(durable->table, key, previous_value);
+        return io_error_();
+    }
+    return deletion_result;
+}
+
+bool durable_hashtable_sync(durable_hashtable_t* durable)
+{
+    pthread_mutex_lock(&durable->lock);
+    bool synced = commit_locked_(durable, /*sync*/ true);
+    pthread_mutex_unlock(&durable->lock);
+    return synced;
+}
+
+bool durable_hashtable_compact(durable_hashtable_t* durable)
+{
+    pthread_mutex_lock(&durable->lock);
+    if(durable->compacting)
+    {
+        pthread_mutex_unlock(&durable->lock);
+        return false;
+    }
+    durable->compacting = true;
+    pthread_mutex_unlock(&durable->lock);
+    if(durable->compactor_started) pthread_join(durable->compactor, NULL); //already done
+    durable->compactor_started = false;
+
+    //everything in the current log must be durable before the snapshot replaces it
+    pthread_mutex_lock(&durable->lock);
+    uint64_t log_bytes;
+    int fd = commit_locked_(durable, /*sync*/ true) ? open_log_(durable, durable->log_gen + 1, &log_bytes) : -1;
+    if(fd < 0)
+    {
+        durable->compacting = false;
+        pthread_mutex_unlock(&durable->lock);
+        if(hashtable_logs) hashtable_log(ERROR, "durable_hashtable_compact", "could not switch to a new log in '%s'", durable->dir);
+        return false;
+    }
+    close(durable->log_fd);
+    durable->log_fd = fd;
+    durable->log_gen++;
+    durable->log_bytes = log_bytes;
+    pthread_mutex_unlock(&durable->lock);
+
+    compaction_job_t* job = (compaction_job_t*)malloc(sizeof(compaction_job_t));
+    job->durable = durable;
+    job->copy = hashtable_copy(durable->table);
+    job->log_gen = durable->log_gen;
+    pthread_create(&durable->compactor, NULL, compactor_main_, job);
+    durable->compactor_started = true;
+    return true;
+}
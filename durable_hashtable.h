@@ -0,0 +1,125 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: string -> any hashtable made durable with a write-ahead log
+
+This header describes the interface to a durable hashtable, a hashtable_t kept in a directory on
+disk.  Every insert/put/delete that changes the hashtable appends a small record (key, value and a
+checksum) to a log file, instead of the whole hashtable being written out.  Records are committed
+(written and fsynced) according to a durability policy:
+
+- DURABILITY_SYNC commits every record before returning, so nothing acknowledged is ever lost.
+- DURABILITY_GROUP buffers records and commits them together from a background thread, at most
+  commit_interval_ms after they were appended (or as soon as commit_bytes are buffered).  One
+  fsync covers every record of the batch, and a crash loses at most the last interval.
+- DURABILITY_NONE only writes records once commit_bytes are buffered, and never fsyncs until
+  durable_hashtable_sync or close.
+
+When the log grows past compact_bytes, it is compacted in the background: the log is switched to a
+fresh file, and a snapshot of a copy of the hashtable (taken in the caller's thread) is written
+next to it, after which the old logs are removed.  Opening a directory loads the latest snapshot
+and replays the logs written after it, stopping at the first torn or corrupted record (ex from a
+crash mid write).
+
+Lookups go straight to the hashtable (durable->table), but every change must go through the
+functions below to be logged.  The hashtable has expiry enabled so deletes leave tombstones, but
+ttls, like filters, are not persisted.
+NOTE: values are logged bit for bit, so value_type must not own resources to be made durable.
+*/
+
+#ifndef INCLUDE_DURABLE_HASHTABLE_H
+#define INCLUDE_DURABLE_HASHTABLE_H
+
+#include "hashtable.h"
+#include <time.h>
+
+#define WAL_MAGIC 0x314c415748534148ull //"HASHWAL1"
+#define SNAPSHOT_MAGIC 0x31504e5348534148ull //"HASHSNP1"
+
+//when logged records are committed, see the top of the file
+typedef enum
+{
+    DURABILITY_NONE,
+    DURABILITY_GROUP,
+    DURABILITY_SYNC
+} DURABILITY;
+
+typedef struct
+{
+    DURABILITY mode;
+    uint32_t commit_interval_ms; //longest a record waits for its commit in group mode
+    uint32_t commit_bytes;       //buffered bytes that trigger a commit early
+    uint64_t compact_bytes;      //log size that triggers a background compaction, 0 for never
+} durability_policy_t;
+
+//buffer of records waiting to be committed
+typedef struct
+{
+    char* data;
+    size_t size;
+    size_t capacity;
+} wal_buffer_t;
+
+//struct to represent a durable hashtable.
+typedef struct
+{
+    hashtable_t* table;
+    char* dir;
+    durability_policy_t policy;
+    int log_fd;
+    uint64_t log_gen;       //the log is the file wal.<log_gen>
+    uint64_t log_bytes;     //bytes committed to the current log
+    uint64_t snapshot_gen;  //first log not covered by the snapshot
+    uint64_t commits;       //number of commits (one write, and one fsync unless DURABILITY_NONE)
+    bool io_failed;         //set once a log write or fsync fails
+
+    pthread_mutex_t lock;   //guards everything below, and the log while committing
+    pthread_cond_t wake;    //wakes the committer thread
+    pthread_cond_t committed;
+    wal_buffer_t pending;   //records appended since the last commit
+    wal_buffer_t writing;   //records being committed
+    bool committing;
+    bool stopping;
+    struct timespec first_pending_at;
+    pthread_t committer;    //only running in group mode
+    pthread_t compactor;
+    bool compactor_started; //whether compactor must be joined
+    bool compacting;
+} durable_hashtable_t;
+
+//returns the default policy: group commit every 10ms (or 64KB), compaction past 64MB of log.
+durability_policy_t durability_policy_default(void);
+
+//open the durable hashtable kept in dir, creating dir if it doesn't exist, and rebuild its
+//hashtable from the snapshot and logs found there.
+//returns a pointer to the durable hashtable, NULL if dir could not be opened or read.
+durable_hashtable_t* durable_hashtable_open(const char* dir, durability_policy_t policy);
+
+//commit every record, wait for any compaction to end and cleanup the durable hashtable.
+void durable_hashtable_close(durable_hashtable_t* durable);
+
+//insert a key value pair like hashtable_insert, and log it if it was inserted.
+//returns a cell_info_t, with status and pointer to cell if insertion succeeded (NULL otherwise),
+//or IO_ERROR if a DURABILITY_SYNC commit failed (the key is then not inserted).
+cell_info_t durable_hashtable_insert(durable_hashtable_t* durable, char* key, value_type value);
+
+//insert a key value pair, or overwrite the value of the key if it's already present, and log it.
+//returns a cell_info_t, with status OK and pointer to cell, or HASHTABLE_FULL, or IO_ERROR if a
+//DURABILITY_SYNC commit failed (the hashtable is then left unchanged).
+cell_info_t durable_hashtable_put(durable_hashtable_t* durable, char* key, value_type value);
+
+//delete a key like hashtable_delete, and log it if it was deleted.
+//returns a cell_info_t, with status of deletion (cell pointer always NULL), IO_ERROR if a
+//DURABILITY_SYNC commit failed (the key is then kept).
+cell_info_t durable_hashtable_delete(durable_hashtable_t* durable, char* key);
+
+//commit every record logged so far, whatever the policy.
+//returns true if every record was written and fsynced.
+bool durable_hashtable_sync(durable_hashtable_t* durable);
+
+//switch to a new log and write a snapshot of the hashtable in the background, which then replaces
+//the previous snapshot and logs.
+//returns true if the compaction was started, false if one is already running or it failed.
+bool durable_hashtable_compact(durable_hashtable_t* durable);
+
+#endif //INCLUDE_DURABLE_HASHTABLE_H
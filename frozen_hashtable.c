@@ -0,0 +1,340 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: impl of frozen hashtable methods outlined in frozen_hashtable.h
+*/
+
+#include "frozen_hashtable.h"
+#include "hashtable_internal.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define FROZEN_KEYS_PER_BUCKET 4
+#define FROZEN_MAX_ATTEMPTS 16
+
+static uint64_t mix64_(uint64_t x) //local utility, splitmix64 finalizer
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+//the 32 bit hash of hashtable_t is too small (and too weak) for every key of a big table to be
+//told apart, so freezing uses its own seeded 64 bit hash (FNV-1a, then mixed)
+static uint64_t frozen_hash_(char* key, uint64_t seed) //local utility
+{
+    uint64_t val = 0xCBF29CE484222325ull ^ seed;
+    while(*key) val = (val ^ (uint8_t)*key++) * 0x100000001B3ull;
+    return mix64_(val);
+}
+
+static uint32_t fastrange_(uint32_t x, uint32_t n) //local utility, maps x to [0, n) without a division
+{
+    return (uint32_t)(((uint64_t)x * n) >> 32);
+}
+
+static uint32_t bucket_of_(uint64_t key_hash, uint32_t num_buckets) //local utility
+{
+    return fastrange_((uint32_t)key_hash, num_buckets);
+}
+
+static uint32_t slot_of_(uint64_t key_hash, uint32_t pilot, uint32_t size) //local utility
+{
+    uint64_t x = (key_hash ^ mix64_(pilot)) * 0x9E3779B97F4A7C15ull;
+    return fastrange_((uint32_t)(x >> 32), size);
+}
+
+//find a pilot per bucket, biggest buckets first while most slots are still free. fills slots
+//with the slot of every key.
+//returns false if some bucket has no pilot that fits (ex two of its keys have the same hash).
+static bool find_pilots_(uint64_t* hashes, uint32_t size, uint32_t num_buckets, uint32_t* pilots, uint32_t* slots) //local utility
+{
+    //counting sort of the keys by bucket
+    uint32_t* bucket_start = (uint32_t*)calloc(num_buckets + 1, sizeof(uint32_t));
+    uint32_t* members = (uint32_t*)malloc(sizeof(uint32_t) * size);
+    for(uint32_t i = 0; i < size; i++) bucket_start[bucket_of_(hashes[i], num_buckets) + 1]++;
+    uint32_t max_bucket_size = 0;
+    for(uint32_t b = 0; b < num_buckets; b++)
+    {
+        if(bucket_start[b + 1] > max_bucket_size) max_bucket_size = bucket_start[b + 1];
+        bucket_start[b + 1] += bucket_start[b];
+    }
+    uint32_t* fill = (uint32_t*)malloc(sizeof(uint32_t) * num_buckets);
+    memcpy(fill, bucket_start, sizeof(uint32_t) * num_buckets);
+    for(uint32_t i = 0; i < size; i++) members[fill[bucket_of_(hashes[i], num_buckets)]++] = i;
+
+    //then of the buckets by decreasing size
+    uint32_t* size_start = (uint32_t*)calloc(max_bucket_size + 2, sizeof(uint32_t));
+    for(uint32_t b = 0; b < num_buckets; b++) size_start[max_bucket_size - (bucket_start[b + 1] - bucket_start[b]) + 1]++;
+    for(uint32_t s = 0; s <= max_bucket_size; s++) size_start[s + 1] += size_start[s];
+    uint32_t* order = fill; //reused, every bucket has been filled
+    for(uint32_t b = 0; b < num_buckets; b++) order[size_start[max_bucket_size - (bucket_start[b + 1] - bucket_start[b])]++] = b;
+
+    //the last buckets have to hit one of the few slots left, which takes about size tries each
+    uint64_t max_pilot = 1000 + (uint64_t)size * 64;
+    if(max_pilot > UINT32_MAX) max_pilot = UINT32_MAX;
+    uint8_t* taken = (uint8_t*)calloc(size, sizeof(uint8_t));
+    bool found_all = true;
+
+    for(uint32_t o = 0; o < num_buckets && found_all; o++)
+    {
+        uint32_t b = order[o];
+        uint32_t begin = bucket_start[b];
+        uint32_t end = bucket_start[b + 1];
+        pilots[b] = 0;
+        if(begin == end) continue;
+
+        bool found = false;
+        for(uint64_t pilot = 0; pilot < max_pilot && !found; pilot++)
+        {
+            found = true;
+            for(uint32_t m = begin; m < end && found; m++)
+            {
+                uint32_t slot = slot_of_(hashes[members[m]], (uint32_t)pilot, size);
+                slots[members[m]] = slot;
+                found = !taken[slot];
+                for(uint32_t prev = begin; prev < m && found; prev++) found = slots[members[prev]] != slot;
+            }
+            if(found) pilots[b] = (uint32_t)pilot;
+        }
+
+        if(found) for(uint32_t m = begin; m < end; m++) taken[slots[members[m]]] = 1;
+        found_all = found;
+    }
+
+    free(bucket_start);
+    free(members);
+    free(fill);
+    free(size_start);
+    free(taken);
+    return found_all;
+}
+
+static size_t align8_(size_t n) //local utility
+{
+    return (n + 7) & ~(size_t)7;
+}
+
+//point every section of the frozen hashtable into its blob, checking that they fit in it
+static bool view_blob_(frozen_hashtable_t* hashtable, void* blob, size_t blob_bytes) //local utility
+{
+    if(blob_bytes < sizeof(frozen_header_t)) return false;
+    frozen_header_t* header = (frozen_header_t*)blob;
+    if(header->magic != FROZEN_MAGIC || header->value_size != sizeof(value_type) || header->total_bytes > blob_bytes) return false;
+
+    size_t offsets_at = sizeof(frozen_header_t) + sizeof(uint32_t) * (size_t)header->num_buckets;
+    size_t values_at = align8_(offsets_at + sizeof(uint32_t) * (size_t)header->size);
+    size_t keys_at = values_at + sizeof(value_type) * (size_t)header->size;
+    if(keys_at > header->total_bytes || (header->size && header->num_buckets == 0)) return false;
+
+    char* base = (char*)blob;
+    hashtable->size = header->size;
+    hashtable->num_buckets = header->num_buckets;
+    hashtable->seed = header->seed;
+    hashtable->pilots = (uint32_t*)(base + sizeof(frozen_header_t));
+    hashtable->offsets = (uint32_t*)(base + offsets_at);
+    hashtable->values = (value_type*)(base + values_at);
+    hashtable->keys = base + keys_at;
+    hashtable->blob = blob;
+    hashtable->blob_bytes = header->total_bytes;
+    hashtable->owns_blob = false;
+    hashtable->mapped = false;
+    return true;
+}
+
+//check that every key of a viewed blob lies within it, and that the pilots send it back to its
+//own slot, so lookups in a corrupted blob can't read past its end or miss stored keys
+static bool check_keys_(frozen_hashtable_t* hashtable) //local utility
+{
+    if(hashtable->size == 0) return true;
+    size_t keys_bytes = hashtable->blob_bytes - (size_t)(hashtable->keys - (char*)hashtable->blob);
+    if(keys_bytes == 0 || hashtable->keys[keys_bytes - 1] != '\0') return false;
+    for(uint32_t s = 0; s < hashtable->size; s++)
+    {
+        if(hashtable->offsets[s] >= keys_bytes) return false;
+        uint64_t key_hash = frozen_hash_(hashtable->keys + hashtable->offsets[s], hashtable->seed);
+        uint32_t pilot = hashtable->pilots[bucket_of_(key_hash, hashtable->num_buckets)];
+        if(slot_of_(key_hash, pilot, hashtable->size) != s) return false;
+    }
+    return true;
+}
+
+frozen_hashtable_t* hashtable_freeze(hashtable_t* hashtable)
+{
+    uint64_t now = hashtable->expiry ? hashtable->expiry->clock() : 0;
+    uint32_t size = 0;
+    size_t keys_bytes = 0;
+    cell_t** cells = (cell_t**)malloc(sizeof(cell_t*) * (hashtable->size ? hashtable->size : 1));
+    for(uint32_t i = 0; i < hashtable->capacity; i++)
+    {
+        cell_t* cell = &hashtable->data[i];
+        if(cell->key == NULL) continue;
+        uint64_t expires_at = hashtable->expiry ? hashtable->expiry->expires_at[i] : 0;
+        if(expires_at && expires_at <= now) continue;
+        cells[size++] = cell;
+        keys_bytes += strlen(cell->key) + 1;
+    }
+    if(keys_bytes > UINT32_MAX)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "hashtable_freeze", "keys take %lu bytes, more than the 4GB offsets can address, aborting", (unsigned long)keys_bytes);
+        free(cells);
+        return NULL;
+    }
+
+    uint32_t num_buckets = size / FROZEN_KEYS_PER_BUCKET + 1;
+    uint32_t* pilots = (uint32_t*)malloc(sizeof(uint32_t) * num_buckets);
+    uint32_t* slots = (uint32_t*)malloc(sizeof(uint32_t) * (size ? size : 1));
+    uint64_t* hashes = (uint64_t*)malloc(sizeof(uint64_t) * (size ? size : 1));
+
+    //a seed that leaves two keys with the same hash (or just gets unlucky) is replaced by another
+    uint64_t seed = 0;
+    bool found = false;
+    for(uint32_t attempt = 0; attempt < FROZEN_MAX_ATTEMPTS && !found; attempt++)
+    {
+        seed = mix64_(attempt + 1);
+        for(uint32_t k = 0; k < size; k++) hashes[k] = frozen_hash_(cells[k]->key, seed);
+        found = find_pilots_(hashes, size, num_buckets, pilots, slots);
+        if(hashtable_logs && !found) hashtable_log(WARN, "hashtable_freeze", "no perfect hash found with seed %u, retrying", attempt);
+    }
+    if(!found)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "hashtable_freeze", "no perfect hash found for %u keys, aborting", size);
+        free(cells);
+        free(pilots);
+        free(slots);
+        free(hashes);
+        return NULL;
+    }
+
+    size_t offsets_at = sizeof(frozen_header_t) + sizeof(uint32_t) * (size_t)num_buckets;
+    size_t values_at = align8_(offsets_at + sizeof(uint32_t) * (size_t)size);
+    size_t keys_at = values_at + sizeof(value_type) * (size_t)size;
+    size_t total_bytes = keys_at + keys_bytes;
+
+    void* blob = calloc(1, total_bytes);
+    frozen_header_t* header = (frozen_header_t*)blob;
+    header->magic = FROZEN_MAGIC;
+    header->value_size = sizeof(value_type);
+    header->size = size;
+    header->num_buckets = num_buckets;
+    header->seed = seed;
+    header->total_bytes = total_bytes;
+
+    frozen_hashtable_t* frozen = (frozen_hashtable_t*)malloc(sizeof(frozen_hashtable_t));
+    view_blob_(frozen, blob, total_bytes);
+    frozen->owns_blob = true;
+    memcpy(frozen->pilots, pilots, sizeof(uint32_t) * num_buckets);
+
+    //keys are packed in slot order, so neighbouring slots have neighbouring keys
+    uint32_t* slot_keys = (uint32_t*)hashes; //reused as the key of each slot
+    for(uint32_t k = 0; k < size; k++) slot_keys[slots[k]] = k;
+    uint32_t keys_used = 0;
+    for(uint32_t s = 0; s < size; s++)
+    {
+        cell_t* cell = cells[slot_keys[s]];
+        size_t key_len = strlen(cell->key);
+        memcpy(frozen->keys + keys_used, cell->key, key_len + 1);
+        frozen->offsets[s] = keys_used;
+        keys_used += key_len + 1;
+        //values are copied bit for bit into the blob
+        frozen->values[s] = cell->value;
+    }
+
+    free(cells);
+    free(pilots);
+    free(slots);
+    free(hashes);
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_freeze", "froze %u keys into %lu bytes", size, (unsigned long)total_bytes);
+    return frozen;
+}
+
+frozen_hashtable_t* frozen_hashtable_from_blob(void* blob, size_t blob_bytes)
+{
+    frozen_hashtable_t* hashtable = (frozen_hashtable_t*)malloc(sizeof(frozen_hashtable_t));
+    if(!view_blob_(hashtable, blob, blob_bytes) || !check_keys_(hashtable))
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "frozen_hashtable_from_blob", "not a valid frozen blob, aborting");
+        free(hashtable);
+        return NULL;
+    }
+    return hashtable;
+}
+
+bool frozen_hashtable_write(frozen_hashtable_t* hashtable, const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if(file == NULL)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "frozen_hashtable_write", "could not open '%s' for writing", path);
+        return false;
+    }
+    bool written = fwrite(hashtable->blob, 1, hashtable->blob_bytes, file) == hashtable->blob_bytes;
+    written &= fclose(file) == 0;
+    if(hashtable_logs && !written) hashtable_log(ERROR, "frozen_hashtable_write", "could not write frozen blob to '%s'", path);
+    return written;
+}
+
+frozen_hashtable_t* frozen_hashtable_map(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "frozen_hashtable_map", "could not open '%s'", path);
+        return NULL;
+    }
+    struct stat file_stat;
+    void* blob = MAP_FAILED;
+    if(fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) blob = mmap(NULL, file_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(blob == MAP_FAILED)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "frozen_hashtable_map", "could not map '%s'", path);
+        return NULL;
+    }
+
+    frozen_hashtable_t* hashtable = frozen_hashtable_from_blob(blob, file_stat.st_size);
+    if(hashtable == NULL)
+    {
+        munmap(blob, file_stat.st_size);
+        return NULL;
+    }
+    hashtable->blob_bytes = file_stat.st_size;
+    hashtable->mapped = true;
+    return hashtable;
+}
+
+void frozen_hashtable_cleanup(frozen_hashtable_t* hashtable)
+{
+    if(hashtable->mapped) munmap(hashtable->blob, hashtable->blob_bytes);
+    else if(hashtable->owns_blob) free(hashtable->blob);
+    free(hashtable);
+}
+
+value_info_t frozen_hashtable_lookup(frozen_hashtable_t* hashtable, char* key)
+{
+    value_info_t lookup_result;
+    lookup_result.value = NULL;
+    lookup_result.status = KEY_NOT_FOUND;
+    if(hashtable->size == 0) return lookup_result;
+
+    //every key has a slot of its own, so a key is either in that slot or not in the table at all
+    uint64_t key_hash = frozen_hash_(key, hashtable->seed);
+    uint32_t slot = slot_of_(key_hash, hashtable->pilots[bucket_of_(key_hash, hashtable->num_buckets)], hashtable->size);
+    if(strcmp(hashtable->keys + hashtable->offsets[slot], key) == 0)
+    {
+        lookup_result.status = OK;
+        lookup_result.value = &hashtable->values[slot];
+    }
+    if(hashtable_logs) hashtable_log(INFO, "frozen_hashtable_lookup", "lookup of key '%s' %s", key, lookup_result.status == OK ? "succeeded" : "failed, not found");
+    return lookup_result;
+}
+
+size_t frozen_hashtable_bytes(frozen_hashtable_t* hashtable)
+{
+    return hashtable->blob_bytes;
+}
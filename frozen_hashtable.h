@@ -0,0 +1,87 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: read only string -> any hashtable built with a minimal perfect hash
+
+This header describes the interface to a frozen hashtable, made from a hashtable_t once it is
+fully built (dictionaries, config maps, symbol tables...).  Freezing finds a minimal perfect hash
+of the keys, PTHash style: keys are split into buckets of about 4 keys, and every bucket gets a
+pilot value that sends each of its keys to a distinct free slot.  There are exactly as many slots
+as keys, so a lookup is one hash, one pilot and one slot access, and one compare - no probing.
+
+Everything lives in a single relocatable blob (offsets only, no pointers): a header, the pilots,
+the key offsets, the values and the keys packed back to back.  The blob can be written to a file
+once and then mapped read only by any number of processes, without being copied: it is only
+checked once, by hashing every key back to its slot.
+
+NOTE: values are copied bit for bit, so value_type must not own resources to be frozen, and the
+blob is only portable between builds with the same value_type and byte order.
+*/
+
+#ifndef INCLUDE_FROZEN_HASHTABLE_H
+#define INCLUDE_FROZEN_HASHTABLE_H
+
+#include "hashtable.h"
+
+#define FROZEN_MAGIC 0x3130485a4e5a5246ull //"FRZNZH01"
+
+//header at the start of a frozen blob, every section follows it in this order:
+//pilots[num_buckets], key offsets[size], values[size] (8 byte aligned), keys.
+typedef struct
+{
+    uint64_t magic;
+    uint32_t value_size; //sizeof(value_type) of the build that froze the blob
+    uint32_t size;
+    uint32_t num_buckets;
+    uint32_t reserved;
+    uint64_t seed;
+    uint64_t total_bytes;
+} frozen_header_t;
+
+//struct to represent a frozen hashtable, a view over its blob.
+typedef struct
+{
+    uint32_t size;
+    uint32_t num_buckets;
+    uint64_t seed;
+    uint32_t* pilots;
+    uint32_t* offsets; //offset of the key of each slot within keys
+    value_type* values;
+    char* keys;
+    void* blob;
+    size_t blob_bytes;
+    bool owns_blob; //allocated by hashtable_freeze, as opposed to mapped or borrowed
+    bool mapped;
+} frozen_hashtable_t;
+
+//build a frozen copy of the passed hashtable, which is left unchanged. expired keys are skipped.
+//returns a pointer to the frozen hashtable, NULL if a minimal perfect hash could not be found.
+frozen_hashtable_t* hashtable_freeze(hashtable_t* hashtable);
+
+//wrap an existing frozen blob (ex shared memory) without copying it. the blob must stay valid
+//for as long as the frozen hashtable is used.
+//returns a pointer to the frozen hashtable, NULL if the blob is not a valid frozen blob (a key
+//out of its bounds, or not in the slot its pilot gives).
+frozen_hashtable_t* frozen_hashtable_from_blob(void* blob, size_t blob_bytes);
+
+//write the blob of the passed frozen hashtable to the file at path.
+//returns true if the whole blob was written.
+bool frozen_hashtable_write(frozen_hashtable_t* hashtable, const char* path);
+
+//map the frozen blob in the file at path read only, so it is shared with every other process
+//mapping it.
+//returns a pointer to the frozen hashtable, NULL if the file could not be mapped or is invalid.
+frozen_hashtable_t* frozen_hashtable_map(const char* path);
+
+//cleanup the passed frozen hashtable, unmapping or freeing its blob if it owns it.
+void frozen_hashtable_cleanup(frozen_hashtable_t* hashtable);
+
+//lookup a key in the passed frozen hashtable.
+//returns a value_info_t, with status and pointer to value if lookup succeeded (NULL otherwise).
+//NOTE: the value of a mapped frozen hashtable is read only.
+value_info_t frozen_hashtable_lookup(frozen_hashtable_t* hashtable, char* key);
+
+//returns the size of the blob of the passed frozen hashtable in bytes.
+size_t frozen_hashtable_bytes(frozen_hashtable_t* hashtable);
+
+#endif //INCLUDE_FROZEN_HASHTABLE_H
@@ -0,0 +1,300 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: impl of the batch hash methods outlined in hashtable.h
+
+hash() goes through a key one byte at a time, and every byte depends on the previous one, so a
+single key can't be sped up.  Hashing several keys at once can: each key gets a 32 bit SIMD lane
+and the lanes run the exact same djb2 steps side by side, so the results are bit for bit those of
+hash().  Keys are read 4 bytes per lane per step (gathered when the cpu can), and the 4 djb2 steps
+are folded into multiplies by powers of 33.  Variable width keys are measured first, and each
+lane masks off the bytes past the end of its key, so lanes of any length run together until the
+longest key is done.
+
+The widest kernel the cpu supports (SSE4.2, AVX2 or AVX-512) is picked at runtime.  Keys that
+don't fill a whole set of lanes, and sets with a key shorter than a word, go through hash().
+*/
+
+#include "hashtable_internal.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HASH_BATCH_X86
+#include <immintrin.h>
+#endif
+
+//powers of 33, the djb2 multiplier, to fold 4 steps into one
+#define POW33_2 1089u
+#define POW33_3 35937u
+#define POW33_4 1185921u
+
+static HASH_ISA isa_limit_ = HASH_AVX512;
+
+static uint32_t hash_fixed_(const char* key, uint32_t key_width) //local utility, scalar fixed width hash
+{
+    uint32_t val = HASHTABLE_SEED;
+    for(uint32_t i = 0; i < key_width; i++)
+    {
+        int c = key[i];
+        val = ((val << 5) + val) + c;
+    }
+    return val;
+}
+
+static void hash_scalar_(char** keys, uint32_t num_keys, uint32_t* out) //local utility
+{
+    for(uint32_t i = 0; i < num_keys; i++) out[i] = hash(keys[i]);
+}
+
+#ifdef HASH_BATCH_X86
+
+//every kernel reads 4 byte words of its keys, and left (0 to 4 per lane) says how many bytes of
+//each word are still part of the key. a word with fewer bytes left is read from the last 4 bytes
+//of its key, so the bytes to hash are its top ones and nothing past the key is ever read.
+//bytes are sign extended, like hash() does with char.
+
+//SSE4.2 KERNELS (4 lanes)
+__attribute__((target("sse4.2")))
+static __m128i step_sse42_(__m128i val, __m128i word, __m128i left) //local utility
+{
+    __m128i mult = _mm_set1_epi32(1);
+    mult = _mm_blendv_epi8(mult, _mm_set1_epi32(33), _mm_cmpeq_epi32(left, _mm_set1_epi32(1)));
+    mult = _mm_blendv_epi8(mult, _mm_set1_epi32(POW33_2), _mm_cmpeq_epi32(left, _mm_set1_epi32(2)));
+    mult = _mm_blendv_epi8(mult, _mm_set1_epi32(POW33_3), _mm_cmpeq_epi32(left, _mm_set1_epi32(3)));
+    mult = _mm_blendv_epi8(mult, _mm_set1_epi32(POW33_4), _mm_cmpeq_epi32(left, _mm_set1_epi32(4)));
+
+    __m128i sum = _mm_and_si128(_mm_cmpgt_epi32(left, _mm_set1_epi32(0)), _mm_srai_epi32(word, 24));
+    __m128i weight = _mm_and_si128(_mm_cmpgt_epi32(left, _mm_set1_epi32(1)), _mm_set1_epi32(33));
+    sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_srai_epi32(_mm_slli_epi32(word, 8), 24), weight));
+    weight = _mm_and_si128(_mm_cmpgt_epi32(left, _mm_set1_epi32(2)), _mm_set1_epi32(POW33_2));
+    sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_srai_epi32(_mm_slli_epi32(word, 16), 24), weight));
+    weight = _mm_and_si128(_mm_cmpgt_epi32(left, _mm_set1_epi32(3)), _mm_set1_epi32(POW33_3));
+    sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_srai_epi32(_mm_slli_epi32(word, 24), 24), weight));
+    return _mm_add_epi32(_mm_mullo_epi32(val, mult), sum);
+}
+
+__attribute__((target("sse4.2")))
+static bool hash_lanes_sse42_(char** keys, uint32_t* out) //local utility, false if a key is too short
+{
+    uint32_t len[4];
+    uint32_t max_len = 0;
+    for(int k = 0; k < 4; k++)
+    {
+        len[k] = (uint32_t)strlen(keys[k]);
+        if(len[k] < 4) return false;
+        if(len[k] > max_len) max_len = len[k];
+    }
+
+    __m128i lens = _mm_loadu_si128((__m128i*)len);
+    __m128i val = _mm_set1_epi32(HASHTABLE_SEED);
+    for(uint32_t j = 0; j < max_len; j += 4)
+    {
+        int32_t w[4];
+        for(int k = 0; k < 4; k++) memcpy(&w[k], keys[k] + (j < len[k] - 4 ? j : len[k] - 4), 4);
+        __m128i left = _mm_min_epi32(_mm_max_epi32(_mm_sub_epi32(lens, _mm_set1_epi32(j)), _mm_setzero_si128()), _mm_set1_epi32(4));
+        val = step_sse42_(val, _mm_loadu_si128((__m128i*)w), left);
+    }
+    _mm_storeu_si128((__m128i*)out, val);
+    return true;
+}
+
+__attribute__((target("sse4.2")))
+static void hash_lanes_fixed_sse42_(const char* keys, uint32_t key_width, uint32_t stride, uint32_t* out) //local utility
+{
+    __m128i val = _mm_set1_epi32(HASHTABLE_SEED);
+    for(uint32_t j = 0; j < key_width; j += 4)
+    {
+        uint32_t offset = j < key_width - 4 ? j : key_width - 4;
+        int32_t w[4];
+        for(int k = 0; k < 4; k++) memcpy(&w[k], keys + k * stride + offset, 4);
+        uint32_t left = key_width - j < 4 ? key_width - j : 4;
+        val = step_sse42_(val, _mm_loadu_si128((__m128i*)w), _mm_set1_epi32(left));
+    }
+    _mm_storeu_si128((__m128i*)out, val);
+}
+
+//AVX2 KERNELS (8 lanes)
+__attribute__((target("avx2")))
+static __m256i step_avx2_(__m256i val, __m256i word, __m256i left) //local utility
+{
+    __m256i mult = _mm256_permutevar8x32_epi32(_mm256_setr_epi32(1, 33, POW33_2, POW33_3, POW33_4, 0, 0, 0), left);
+
+    __m256i sum = _mm256_and_si256(_mm256_cmpgt_epi32(left, _mm256_set1_epi32(0)), _mm256_srai_epi32(word, 24));
+    __m256i weight = _mm256_and_si256(_mm256_cmpgt_epi32(left, _mm256_set1_epi32(1)), _mm256_set1_epi32(33));
+    sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(_mm256_srai_epi32(_mm256_slli_epi32(word, 8), 24), weight));
+    weight = _mm256_and_si256(_mm256_cmpgt_epi32(left, _mm256_set1_epi32(2)), _mm256_set1_epi32(POW33_2));
+    sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(_mm256_srai_epi32(_mm256_slli_epi32(word, 16), 24), weight));
+    weight = _mm256_and_si256(_mm256_cmpgt_epi32(left, _mm256_set1_epi32(3)), _mm256_set1_epi32(POW33_3));
+    sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(_mm256_srai_epi32(_mm256_slli_epi32(word, 24), 24), weight));
+    return _mm256_add_epi32(_mm256_mullo_epi32(val, mult), sum);
+}
+
+__attribute__((target("avx2")))
+static bool hash_lanes_avx2_(char** keys, uint32_t* out) //local utility, false if a key is too short
+{
+    uint32_t len[8];
+    uint32_t max_len = 0;
+    for(int k = 0; k < 8; k++)
+    {
+        len[k] = (uint32_t)strlen(keys[k]);
+        if(len[k] < 4) return false;
+        if(len[k] > max_len) max_len = len[k];
+    }
+
+    __m256i lens = _mm256_loadu_si256((__m256i*)len);
+    __m256i addrs_lo = _mm256_loadu_si256((__m256i*)keys);
+    __m256i addrs_hi = _mm256_loadu_si256((__m256i*)(keys + 4));
+    __m256i val = _mm256_set1_epi32(HASHTABLE_SEED);
+    for(uint32_t j = 0; j < max_len; j += 4)
+    {
+        __m256i left = _mm256_sub_epi32(lens, _mm256_set1_epi32(j));
+        __m256i offsets = _mm256_add_epi32(_mm256_set1_epi32(j), _mm256_min_epi32(left, _mm256_set1_epi32(4)));
+        offsets = _mm256_sub_epi32(offsets, _mm256_set1_epi32(4)); //min(j, len - 4)
+        __m128i lo = _mm256_i64gather_epi32((const int*)0, _mm256_add_epi64(addrs_lo, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(offsets))), 1);
+        __m128i hi = _mm256_i64gather_epi32((const int*)0, _mm256_add_epi64(addrs_hi, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(offsets, 1))), 1);
+        left = _mm256_min_epi32(_mm256_max_epi32(left, _mm256_setzero_si256()), _mm256_set1_epi32(4));
+        val = step_avx2_(val, _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), left);
+    }
+    _mm256_storeu_si256((__m256i*)out, val);
+    return true;
+}
+
+__attribute__((target("avx2")))
+static void hash_lanes_fixed_avx2_(const char* keys, uint32_t key_width, uint32_t stride, uint32_t* out) //local utility
+{
+    __m256i lane_offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+    __m256i val = _mm256_set1_epi32(HASHTABLE_SEED);
+    for(uint32_t j = 0; j < key_width; j += 4)
+    {
+        uint32_t offset = j < key_width - 4 ? j : key_width - 4;
+        __m256i word = _mm256_i32gather_epi32((const int*)(keys + offset), lane_offsets, 1);
+        uint32_t left = key_width - j < 4 ? key_width - j : 4;
+        val = step_avx2_(val, word, _mm256_set1_epi32(left));
+    }
+    _mm256_storeu_si256((__m256i*)out, val);
+}
+
+//AVX-512 KERNELS (16 lanes)
+__attribute__((target("avx512f")))
+static __m512i step_avx512_(__m512i val, __m512i word, __m512i left) //local utility
+{
+    __m512i mult = _mm512_permutexvar_epi32(left, _mm512_setr_epi32(1, 33, POW33_2, POW33_3, POW33_4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+
+    __m512i sum = _mm512_maskz_mov_epi32(_mm512_cmpgt_epi32_mask(left, _mm512_set1_epi32(0)), _mm512_srai_epi32(word, 24));
+    __m512i weight = _mm512_maskz_mov_epi32(_mm512_cmpgt_epi32_mask(left, _mm512_set1_epi32(1)), _mm512_set1_epi32(33));
+    sum = _mm512_add_epi32(sum, _mm512_mullo_epi32(_mm512_srai_epi32(_mm512_slli_epi32(word, 8), 24), weight));
+    weight = _mm512_maskz_mov_epi32(_mm512_cmpgt_epi32_mask(left, _mm512_set1_epi32(2)), _mm512_set1_epi32(POW33_2));
+    sum = _mm512_add_epi32(sum, _mm512_mullo_epi32(_mm512_srai_epi32(_mm512_slli_epi32(word, 16), 24), weight));
+    weight = _mm512_maskz_mov_epi32(_mm512_cmpgt_epi32_mask(left, _mm512_set1_epi32(3)), _mm512_set1_epi32(POW33_3));
+    sum = _mm512_add_epi32(sum, _mm512_mullo_epi32(_mm512_srai_epi32(_mm512_slli_epi32(word, 24), 24), weight));
+    return _mm512_add_epi32(_mm512_mullo_epi32(val, mult), sum);
+}
+
+__attribute__((target("avx512f")))
+static bool hash_lanes_avx512_(char** keys, uint32_t* out) //local utility, false if a key is too short
+{
+    uint32_t len[16];
+    uint32_t max_len = 0;
+    for(int k = 0; k < 16; k++)
+    {
+        len[k] = (uint32_t)strlen(keys[k]);
+        if(len[k] < 4) return false;
+        if(len[k] > max_len) max_len = len[k];
+    }
+
+    __m512i lens = _mm512_loadu_si512(len);
+    __m512i addrs_lo = _mm512_loadu_si512(keys);
+    __m512i addrs_hi = _mm512_loadu_si512(keys + 8);
+    __m512i val = _mm512_set1_epi32(HASHTABLE_SEED);
+    for(uint32_t j = 0; j < max_len; j += 4)
+    {
+        __m512i left = _mm512_sub_epi32(lens, _mm512_set1_epi32(j));
+        __m512i offsets = _mm512_add_epi32(_mm512_set1_epi32(j), _mm512_min_epi32(left, _mm512_set1_epi32(4)));
+        offsets = _mm512_sub_epi32(offsets, _mm512_set1_epi32(4)); //min(j, len - 4)
+        __m256i lo = _mm512_i64gather_epi32(_mm512_add_epi64(addrs_lo, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(offsets))), (const void*)0, 1);
+        __m256i hi = _mm512_i64gather_epi32(_mm512_add_epi64(addrs_hi, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(offsets, 1))), (const void*)0, 1);
+        left = _mm512_min_epi32(_mm512_max_epi32(left, _mm512_setzero_si512()), _mm512_set1_epi32(4));
+        val = step_avx512_(val, _mm512_inserti64x4(_mm512_castsi256_si512(lo), hi, 1), left);
+    }
+    _mm512_storeu_si512(out, val);
+    return true;
+}
+
+__attribute__((target("avx512f")))
+static void hash_lanes_fixed_avx512_(const char* keys, uint32_t key_width, uint32_t stride, uint32_t* out) //local utility
+{
+    __m512i lane_offsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(stride));
+    __m512i val = _mm512_set1_epi32(HASHTABLE_SEED);
+    for(uint32_t j = 0; j < key_width; j += 4)
+    {
+        uint32_t offset = j < key_width - 4 ? j : key_width - 4;
+        __m512i word = _mm512_i32gather_epi32(lane_offsets, keys + offset, 1);
+        uint32_t left = key_width - j < 4 ? key_width - j : 4;
+        val = step_avx512_(val, word, _mm512_set1_epi32(left));
+    }
+    _mm512_storeu_si512(out, val);
+}
+
+#endif //HASH_BATCH_X86
+
+HASH_ISA hash_batch_isa(void)
+{
+    HASH_ISA limit = __atomic_load_n(&isa_limit_, __ATOMIC_RELAXED);
+#ifdef HASH_BATCH_X86
+    if(limit >= HASH_AVX512 && __builtin_cpu_supports("avx512f")) return HASH_AVX512;
+    if(limit >= HASH_AVX2 && __builtin_cpu_supports("avx2")) return HASH_AVX2;
+    if(limit >= HASH_SSE42 && __builtin_cpu_supports("sse4.2")) return HASH_SSE42;
+#endif
+    (void)limit;
+    return HASH_SCALAR;
+}
+
+void hash_batch_limit_isa(HASH_ISA max_isa)
+{
+    __atomic_store_n(&isa_limit_, max_isa, __ATOMIC_RELAXED);
+}
+
+void hash_batch(char** keys, uint32_t num_keys, uint32_t* out)
+{
+    uint32_t i = 0;
+#ifdef HASH_BATCH_X86
+    switch(hash_batch_isa())
+    {
+        case HASH_AVX512:
+            for(; i + 16 <= num_keys; i += 16) if(!hash_lanes_avx512_(keys + i, out + i)) hash_scalar_(keys + i, 16, out + i);
+            break;
+        case HASH_AVX2:
+            for(; i + 8 <= num_keys; i += 8) if(!hash_lanes_avx2_(keys + i, out + i)) hash_scalar_(keys + i, 8, out + i);
+            break;
+        case HASH_SSE42:
+            for(; i + 4 <= num_keys; i += 4) if(!hash_lanes_sse42_(keys + i, out + i)) hash_scalar_(keys + i, 4, out + i);
+            break;
+        default:
+            break;
+    }
+#endif
+    hash_scalar_(keys + i, num_keys - i, out + i);
+}
+
+void hash_batch_fixed(const char* keys, uint32_t key_width, uint32_t stride, uint32_t num_keys, uint32_t* out)
+{
+    uint32_t i = 0;
+#ifdef HASH_BATCH_X86
+    //lanes read whole words of their key and gather with 32 bit offsets
+    bool fits_lanes = key_width >= 4 && stride <= (1u << 26);
+    switch(fits_lanes ? hash_batch_isa() : HASH_SCALAR)
+    {
+        case HASH_AVX512:
+            for(; i + 16 <= num_keys; i += 16) hash_lanes_fixed_avx512_(keys + (size_t)i * stride, key_width, stride, out + i);
+            break;
+        case HASH_AVX2:
+            for(; i + 8 <= num_keys; i += 8) hash_lanes_fixed_avx2_(keys + (size_t)i * stride, key_width, stride, out + i);
+            break;
+        case HASH_SSE42:
+            for(; i + 4 <= num_keys; i += 4) hash_lanes_fixed_sse42_(keys + (size_t)i * stride, key_width, stride, out + i);
+            break;
+        default:
+            break;
+    }
+#endif
+    for(; i < num_keys; i++) out[i] = hash_fixed_(keys + (size_t)i * stride, key_width);
+}
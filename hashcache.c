@@ -0,0 +1,249 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: impl of cache methods outlined in hashcache.h
+*/
+
+#include "hashcache.h"
+#include "hashtable_internal.h"
+
+hashcache_t* hashcache_init(uint32_t max_entries, hashcache_release_fn on_release, void* release_ctx)
+{
+    if(max_entries == 0 || max_entries > (1u << 30))
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "hashcache_init", "max entries %u must be nonzero and at most 2^30, aborting", max_entries);
+        return NULL;
+    }
+
+    //enough slots to stay under the max load factor when full
+    uint32_t capacity = 1;
+    while((double)max_entries / capacity > MAX_LOAD_FACTOR) capacity <<= 1;
+
+    hashcache_t* cache = (hashcache_t*)malloc(sizeof(hashcache_t));
+    cache->capacity = capacity;
+    cache->max_entries = max_entries;
+    cache->size = 0;
+    cache->tombstones = 0;
+    cache->hand = 0;
+    cache->data = (cell_t*)malloc(sizeof(cell_t) * capacity);
+    cache->meta = (uint8_t*)calloc(capacity, sizeof(uint8_t));
+    cache->on_release = on_release;
+    cache->release_ctx = release_ctx;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+
+    if(hashtable_logs) hashtable_log(INFO, "hashcache_init", "created cache of %u entries over %u slots", max_entries, capacity);
+    return cache;
+}
+
+static void release_slot_(hashcache_t* cache, uint32_t idx, bool evicted) //local utility
+{
+    cell_t* cell = &cache->data[idx];
+    if(cache->on_release) cache->on_release(cell->key, &cell->value, evicted, cache->release_ctx);
+    HASHTABLE_VALUE_DESTROY(cell->value);
+    free(cell->key);
+    cell->key = NULL;
+    cache->meta[idx] = CACHE_TOMBSTONE;
+    cache->tombstones++;
+    cache->size--;
+}
+
+void hashcache_cleanup(hashcache_t* cache)
+{
+    if(hashtable_logs) hashtable_log(INFO, "hashcache_cleanup", "destroying cache with %u entries", cache->size);
+    hashcache_clear(cache);
+    free(cache->data);
+    free(cache->meta);
+    free(cache);
+}
+
+uint32_t hashcache_clear(hashcache_t* cache)
+{
+    uint32_t num_deletions = 0;
+    for(uint32_t i = 0; i < cache->capacity; i++)
+    {
+        if(cache->meta[i] & CACHE_OCCUPIED)
+        {
+            release_slot_(cache, i, /*evicted*/ false);
+            num_deletions++;
+        }
+        cache->meta[i] = CACHE_EMPTY;
+    }
+    cache->tombstones = 0;
+    cache->hand = 0;
+
+    if(hashtable_logs) hashtable_log(INFO, "hashcache_clear", "cleared %u elements from cache", num_deletions);
+    return num_deletions;
+}
+
+//rehash every entry into fresh slots of the same capacity, dropping tombstones. reference bits
+//are kept, so recency survives the rehash.
+static void rehash_(hashcache_t* cache) //local utility
+{
+    cell_t* old_data = cache->data;
+    uint8_t* old_meta = cache->meta;
+    cache->data = (cell_t*)malloc(sizeof(cell_t) * cache->capacity);
+    cache->meta = (uint8_t*)calloc(cache->capacity, sizeof(uint8_t));
+
+    for(uint32_t i = 0; i < cache->capacity; i++)
+    {
+        if(!(old_meta[i] & CACHE_OCCUPIED)) continue;
+        uint32_t base_idx = hash(old_data[i].key);
+        int probe = 0;
+        uint32_t idx = mod(base_idx, cache->capacity);
+        while(cache->meta[idx] != CACHE_EMPTY)
+        {
+            probe++;
+            idx = probe_idx(base_idx, probe, cache->capacity);
+        }
+        cache->data[idx] = old_data[i];
+        cache->meta[idx] = old_meta[i];
+    }
+
+    free(old_data);
+    free(old_meta);
+    cache->tombstones = 0;
+    if(hashtable_logs) hashtable_log(INFO, "hashcache_rehash", "rehashed cache to drop tombstones");
+}
+
+//probe for key, returning its slot or -1 if absent. insert_idx is set to the slot the key would
+//be inserted in, the first tombstone of the chain if any.
+static int64_t find_slot_(hashcache_t* cache, char* key, uint32_t base_idx, int64_t* insert_idx) //local utility
+{
+    *insert_idx = -1;
+    int probe = 0;
+
+    do
+    {
+        uint32_t idx = probe_idx(base_idx, probe, cache->capacity);
+
+        if(probe && idx == mod(base_idx, cache->capacity)) return -1; //full table cycle case
+
+        uint8_t meta = cache->meta[idx];
+        if(meta == CACHE_EMPTY)
+        {
+            if(*insert_idx < 0) *insert_idx = idx;
+            return -1;
+        }
+        if(meta == CACHE_TOMBSTONE)
+        {
+            if(*insert_idx < 0) *insert_idx = idx;
+        }
+        else if(*key == *cache->data[idx].key && strcmp(cache->data[idx].key, key) == 0) return idx;
+        probe++;
+    } while(true);
+}
+
+static void evict_(hashcache_t* cache) //local utility, advances the clock hand to a victim
+{
+    //every pass over a referenced entry clears its bit, so this ends within two sweeps
+    while(true)
+    {
+        uint32_t idx = cache->hand;
+        cache->hand = mod(cache->hand + 1, cache->capacity);
+
+        uint8_t meta = cache->meta[idx];
+        if(!(meta & CACHE_OCCUPIED)) continue;
+        if(meta & CACHE_REFERENCED)
+        {
+            cache->meta[idx] = CACHE_OCCUPIED;
+            continue;
+        }
+
+        if(hashtable_logs) hashtable_log(INFO, "hashcache_evict", "evicting key '%s'", cache->data[idx].key);
+        release_slot_(cache, idx, /*evicted*/ true);
+        cache->evictions++;
+        return;
+    }
+}
+
+cell_info_t hashcache_insert(hashcache_t* cache, char* key, value_type value)
+{
+    cell_info_t insertion_result;
+    uint32_t base_idx = hash(key);
+    int64_t insert_idx;
+    int64_t found_idx = find_slot_(cache, key, base_idx, &insert_idx);
+
+    if(found_idx >= 0) //duplicate key
+    {
+        cache->meta[found_idx] |= CACHE_REFERENCED;
+        insertion_result.status = DUPLICATE_KEY;
+        insertion_result.cell = &cache->data[found_idx];
+        if(hashtable_logs) hashtable_log(WARN, "hashcache_insert", "insertion of key '%s' failed, duplicate key found", key);
+        return insertion_result;
+    }
+
+    if(cache->size == cache->max_entries) evict_(cache);
+
+    //tombstones make probe chains longer, so rehash once they take up too many slots
+    bool too_many_tombstones = (double)(cache->size + cache->tombstones) / cache->capacity > (1 + MAX_LOAD_FACTOR) / 2;
+    if(too_many_tombstones || insert_idx < 0)
+    {
+        rehash_(cache);
+        find_slot_(cache, key, base_idx, &insert_idx);
+    }
+
+    if(cache->meta[insert_idx] == CACHE_TOMBSTONE) cache->tombstones--;
+    cell_t* cell = &cache->data[insert_idx];
+    size_t key_len = strlen(key);
+    cell->key = (char*)malloc((sizeof(char)*key_len) + 1);
+    strcpy(cell->key, key);
+    HASHTABLE_VALUE_COPY(&cell->value, value);
+    cache->meta[insert_idx] = CACHE_OCCUPIED;
+    cache->size++;
+
+    insertion_result.status = OK;
+    insertion_result.cell = cell;
+    if(hashtable_logs) hashtable_log(INFO, "hashcache_insert", "insertion of key '%s' succeeded", key);
+    return insertion_result;
+}
+
+cell_info_t hashcache_lookup(hashcache_t* cache, char* key)
+{
+    cell_info_t lookup_result;
+    int64_t insert_idx;
+    int64_t found_idx = find_slot_(cache, key, hash(key), &insert_idx);
+
+    if(found_idx < 0)
+    {
+        cache->misses++;
+        lookup_result.status = KEY_NOT_FOUND;
+        lookup_result.cell = NULL;
+        if(hashtable_logs) hashtable_log(INFO, "hashcache_lookup", "lookup of key '%s' failed, not found", key);
+        return lookup_result;
+    }
+
+    cache->hits++;
+    cache->meta[found_idx] |= CACHE_REFERENCED;
+    lookup_result.status = OK;
+    lookup_result.cell = &cache->data[found_idx];
+    if(hashtable_logs) hashtable_log(INFO, "hashcache_lookup", "lookup of key '%s' succeeded", key);
+    return lookup_result;
+}
+
+cell_info_t hashcache_delete(hashcache_t* cache, char* key)
+{
+    cell_info_t deletion_result;
+    deletion_result.cell = NULL;
+    int64_t insert_idx;
+    int64_t found_idx = find_slot_(cache, key, hash(key), &insert_idx);
+
+    if(found_idx < 0)
+    {
+        deletion_result.status = KEY_NOT_FOUND;
+        if(hashtable_logs) hashtable_log(WARN, "hashcache_delete", "deletion of key '%s' failed, not found", key);
+        return deletion_result;
+    }
+
+    release_slot_(cache, (uint32_t)found_idx, /*evicted*/ false);
+    deletion_result.status = OK;
+    if(hashtable_logs) hashtable_log(INFO, "hashcache_delete", "deletion of key '%s' succeeded", key);
+    return deletion_result;
+}
+
+double hashcache_hit_ratio(hashcache_t* cache)
+{
+    uint64_t lookups = cache->hits + cache->misses;
+    return lookups ? (double)cache->hits / lookups : 0;
+}
@@ -0,0 +1,77 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: bounded string -> any cache built on the hashtable probing scheme
+
+This header describes the interface to a fixed capacity cache.  It stores cells the same way
+hashtable_t does (same hash, same probe sequence), but never grows: once max_entries keys are
+stored, inserting a new key evicts an old one.
+
+Victims are picked with CLOCK, an approximation of LRU.  Every slot has a metadata byte with a
+reference bit that lookups set, and a clock hand sweeps the slots clearing reference bits until it
+finds an entry that wasn't referenced since the hand last passed it.  Hits never move anything
+around, they only set a bit.  New entries start unreferenced, so keys that are never hit again
+are the first to go.  Removed slots become tombstones so probe chains stay intact.
+
+The release callback is called for every entry that leaves the cache (evicted or not), before its
+value is destroyed.  Values go through HASHTABLE_VALUE_COPY and HASHTABLE_VALUE_DESTROY as in
+hashtable_t, keys are memory managed by the cache.
+*/
+
+#ifndef INCLUDE_HASHCACHE_H
+#define INCLUDE_HASHCACHE_H
+
+#include "hashtable.h"
+
+//callback called with every entry leaving the cache, evicted is false if it was deleted/cleared.
+typedef void (*hashcache_release_fn)(char* key, value_type* value, bool evicted, void* ctx);
+
+//struct to represent a bounded cache.
+typedef struct
+{
+    uint32_t capacity;    //number of slots, always a power of 2
+    uint32_t max_entries; //number of entries stored before evicting
+    uint32_t size;
+    uint32_t tombstones;
+    uint32_t hand;        //slot the clock hand points at
+    cell_t* data;
+    uint8_t* meta;        //CACHE_* state of each slot
+    hashcache_release_fn on_release;
+    void* release_ctx;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} hashcache_t;
+
+#define CACHE_EMPTY 0x00
+#define CACHE_TOMBSTONE 0x01
+#define CACHE_OCCUPIED 0x02
+#define CACHE_REFERENCED 0x04
+
+//initialize a cache holding up to max_entries entries (nonzero), with an optional release callback.
+//returns a pointer to the new cache
+hashcache_t* hashcache_init(uint32_t max_entries, hashcache_release_fn on_release, void* release_ctx);
+
+//cleanup the passed cache, releasing every entry.
+void hashcache_cleanup(hashcache_t* cache);
+
+//clear the given cache, releasing every entry. hit/miss counters are kept.
+//returns the number of deleted items.
+uint32_t hashcache_clear(hashcache_t* cache);
+
+//insert a (copied) key value pair into the passed cache, evicting an entry if it is full.
+//returns a cell_info_t, with status and pointer to cell if insertion succeeded (NULL otherwise).
+cell_info_t hashcache_insert(hashcache_t* cache, char* key, value_type value);
+
+//lookup a key value pair in the passed cache, marking it as recently used. counts hits and misses.
+//returns a cell_info_t, with status and pointer to cell if lookup succeeded (NULL otherwise).
+cell_info_t hashcache_lookup(hashcache_t* cache, char* key);
+
+//delete a key value pair in the passed cache
+//returns a cell_info_t, with status of deletion (cell pointer always NULL)
+cell_info_t hashcache_delete(hashcache_t* cache, char* key);
+
+//returns the fraction of lookups that were hits, 0 if there were none.
+double hashcache_hit_ratio(hashcache_t* cache);
+
+#endif //INCLUDE_HASHCACHE_H
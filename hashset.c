@@ -0,0 +1,346 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: impl of hashset methods outlined in hashset.h
+*/
+
+#include "hashset.h"
+#include "hashtable_internal.h"
+
+//removed slots point at this, so they are neither empty (NULL) nor a key
+static char tombstone_;
+#define HASHSET_TOMBSTONE (&tombstone_)
+
+static bool is_key_(char* key) //local utility
+{
+    return key && key != HASHSET_TOMBSTONE;
+}
+
+static uint32_t capacity_for_(uint32_t size) //local utility, smallest capacity holding size keys
+{
+    uint32_t capacity = 1;
+    while((double)size / capacity > MAX_LOAD_FACTOR && capacity < 1u << 31) capacity <<= 1;
+    return capacity;
+}
+
+static char* copy_key_(char* key) //local utility
+{
+    char* copy = (char*)malloc(strlen(key) + 1);
+    strcpy(copy, key);
+    return copy;
+}
+
+//probe for key, returning its slot or -1 if absent. insert_idx is set to the slot the key would
+//be inserted in, the first tombstone of the chain if any.
+static int64_t find_slot_(hashset_t* set, char* key, uint32_t base_idx, int64_t* insert_idx) //local utility
+{
+    *insert_idx = -1;
+    int probe = 0;
+
+    do
+    {
+        uint32_t idx = probe_idx(base_idx, probe, set->capacity);
+
+        if(probe && idx == mod(base_idx, set->capacity)) return -1; //full table cycle case
+
+        char* slot = set->keys[idx];
+        if(slot == NULL)
+        {
+            if(*insert_idx < 0) *insert_idx = idx;
+            return -1;
+        }
+        if(slot == HASHSET_TOMBSTONE)
+        {
+            if(*insert_idx < 0) *insert_idx = idx;
+        }
+        else if(*key == *slot && strcmp(slot, key) == 0) return idx;
+        probe++;
+    } while(true);
+}
+
+//put a key known to be absent in the first free slot of its chain, without resizing.
+static void place_(hashset_t* set, char* key, uint32_t base_idx) //local utility
+{
+    int probe = 0;
+    uint32_t idx = mod(base_idx, set->capacity);
+    while(is_key_(set->keys[idx]))
+    {
+        probe++;
+        idx = probe_idx(base_idx, probe, set->capacity);
+    }
+    if(set->keys[idx] == HASHSET_TOMBSTONE) set->tombstones--;
+    set->keys[idx] = key;
+    set->size++;
+}
+
+//move every key of src into the empty dest, hashing them a batch at a time.
+static void move_keys_(hashset_t* dest, hashset_t* src, bool copy) //local utility
+{
+    char* keys[64];
+    uint32_t hashes[64];
+    uint32_t count = 0;
+    for(uint32_t i = 0; i < src->capacity; i++)
+    {
+        if(is_key_(src->keys[i])) keys[count++] = src->keys[i];
+        if(count == 64 || (i + 1 == src->capacity && count))
+        {
+            hash_batch(keys, count, hashes);
+            for(uint32_t k = 0; k < count; k++) place_(dest, copy ? copy_key_(keys[k]) : keys[k], hashes[k]);
+            count = 0;
+        }
+    }
+}
+
+hashset_t* hashset_init(uint32_t capacity)
+{
+    bool capacity_is_not_power_of_2 = capacity & (capacity - 1);
+    if(capacity == 0 || capacity_is_not_power_of_2)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "hashset_init", "capacity %u must be nonzero and a power of two, aborting", capacity);
+        return NULL;
+    }
+
+    hashset_t* set = (hashset_t*)malloc(sizeof(hashset_t));
+    set->capacity = capacity;
+    set->size = 0;
+    set->tombstones = 0;
+    set->keys = (char**)calloc(capacity, sizeof(char*));
+
+    if(hashtable_logs) hashtable_log(INFO, "hashset_init", "created and initialized hashset of capacity %u", capacity);
+    return set;
+}
+
+void hashset_cleanup(hashset_t* set)
+{
+    if(hashtable_logs) hashtable_log(INFO, "hashset_cleanup", "destroying hashset of capacity %u with %u keys", set->capacity, set->size);
+    hashset_clear(set);
+    free(set->keys);
+    free(set);
+}
+
+uint32_t hashset_resize(hashset_t* set, uint32_t new_capacity)
+{
+    if(new_capacity == set->capacity && set->tombstones == 0) return new_capacity;
+    if(new_capacity < set->size)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "hashset_resize", "new capacity %u too small to hold current keys (%u), aborting", new_capacity, set->size);
+        return set->capacity;
+    }
+    bool capacity_is_not_power_of_2 = new_capacity & (new_capacity - 1);
+    if(new_capacity == 0 || capacity_is_not_power_of_2)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "hashset_resize", "new capacity %u is not a power of 2, aborting", new_capacity);
+        return set->capacity;
+    }
+
+    hashset_t old = *set;
+    set->capacity = new_capacity;
+    set->size = 0;
+    set->tombstones = 0;
+    set->keys = (char**)calloc(new_capacity, sizeof(char*));
+    move_keys_(set, &old, /*copy*/ false);
+    free(old.keys);
+
+    if(hashtable_logs) hashtable_log(INFO, "hashset_resize", "resized hashset to new capacity %u", new_capacity);
+    return new_capacity;
+}
+
+uint32_t hashset_squash(hashset_t* set)
+{
+    uint32_t cur_size = set->size;
+    uint32_t capacity = 1;
+    while(capacity < cur_size && capacity < 1u << 31) capacity <<= 1;
+    hashset_resize(set, capacity);
+    if(hashtable_logs) hashtable_log(INFO, "hashset_squash", "squashed hashset to min capacity %u", set->capacity);
+    return set->capacity;
+}
+
+uint32_t hashset_clear(hashset_t* set)
+{
+    uint32_t num_deletions = 0;
+    for(uint32_t i = 0; i < set->capacity; i++)
+    {
+        if(is_key_(set->keys[i]))
+        {
+            free(set->keys[i]);
+            num_deletions++;
+        }
+        set->keys[i] = NULL;
+    }
+    set->size = 0;
+    set->tombstones = 0;
+
+    if(hashtable_logs) hashtable_log(INFO, "hashset_clear", "cleared %u keys from hashset", num_deletions);
+    return num_deletions;
+}
+
+static STATUS insert_hashed_(hashset_t* set, char* key, uint32_t key_hash, bool auto_resize, bool move) //local utility
+{
+    if(set->size == set->capacity)
+    {
+        if(hashtable_logs) hashtable_log(WARN, "hashset_insert", "insertion of key '%s' failed, size has reached capacity %u", key, set->capacity);
+        return HASHTABLE_FULL;
+    }
+
+    int64_t insert_idx;
+    if(find_slot_(set, key, key_hash, &insert_idx) >= 0)
+    {
+        if(hashtable_logs) hashtable_log(WARN, "hashset_insert", "insertion of key '%s' failed, duplicate key found", key);
+        return DUPLICATE_KEY;
+    }
+    if(insert_idx < 0) //the chain went through every slot without a free one, only tombstones
+    {
+        hashset_resize(set, set->capacity);
+        find_slot_(set, key, key_hash, &insert_idx);
+    }
+
+    if(set->keys[insert_idx] == HASHSET_TOMBSTONE) set->tombstones--;
+    set->keys[insert_idx] = move ? key : copy_key_(key);
+    set->size++;
+    if(hashtable_logs) hashtable_log(INFO, "hashset_insert", "insertion of key '%s' succeeded", key);
+
+    if(auto_resize && (double)set->size / set->capacity > MAX_LOAD_FACTOR && set->capacity < 1u << 31)
+    {
+        if(hashtable_logs) hashtable_log(INFO, "hashset_insert", "insertion of key '%s' triggered resize to %u", key, set->capacity << 1);
+        hashset_resize(set, set->capacity << 1);
+    }
+    else if(auto_resize && (double)(set->size + set->tombstones) / set->capacity > MAX_LOAD_FACTOR)
+    {
+        //tombstones make probe chains longer, so rehash in place once they take up too many slots
+        hashset_resize(set, set->capacity);
+    }
+    return OK;
+}
+
+STATUS hashset_insert_(hashset_t* set, char* key, bool auto_resize, bool move)
+{
+    return insert_hashed_(set, key, hash(key), auto_resize, move);
+}
+
+STATUS hashset_insert(hashset_t* set, char* key)
+{
+    return insert_hashed_(set, key, hash(key), /*resize*/ true, /*move*/ false);
+}
+
+bool hashset_contains(hashset_t* set, char* key)
+{
+    int64_t insert_idx;
+    bool found = find_slot_(set, key, hash(key), &insert_idx) >= 0;
+    if(hashtable_logs) hashtable_log(INFO, "hashset_contains", "key '%s' %s", key, found ? "found" : "not found");
+    return found;
+}
+
+static bool delete_hashed_(hashset_t* set, char* key, uint32_t key_hash) //local utility
+{
+    int64_t insert_idx;
+    int64_t found_idx = find_slot_(set, key, key_hash, &insert_idx);
+    if(found_idx < 0) return false;
+    free(set->keys[found_idx]);
+    set->keys[found_idx] = HASHSET_TOMBSTONE;
+    set->size--;
+    set->tombstones++;
+    return true;
+}
+
+STATUS hashset_delete(hashset_t* set, char* key)
+{
+    if(!delete_hashed_(set, key, hash(key)))
+    {
+        if(hashtable_logs) hashtable_log(WARN, "hashset_delete", "deletion of key '%s' failed, not found", key);
+        return KEY_NOT_FOUND;
+    }
+    if(hashtable_logs) hashtable_log(INFO, "hashset_delete", "deletion of key '%s' succeeded", key);
+    return OK;
+}
+
+hashset_t* hashset_copy(hashset_t* set)
+{
+    //same capacity and hash, so every key can stay in the same slot without probing again
+    hashset_t* copy = hashset_init(set->capacity);
+    for(uint32_t i = 0; i < set->capacity; i++)
+    {
+        char* key = set->keys[i];
+        copy->keys[i] = is_key_(key) ? copy_key_(key) : key;
+    }
+    copy->size = set->size;
+    copy->tombstones = set->tombstones;
+    return copy;
+}
+
+//copy of set with room for size keys, slot for slot if it already has it.
+static hashset_t* copy_with_room_(hashset_t* set, uint32_t size) //local utility
+{
+    uint32_t capacity = capacity_for_(size);
+    if(capacity <= set->capacity) return hashset_copy(set);
+    hashset_t* copy = hashset_init(capacity);
+    move_keys_(copy, set, /*copy*/ true);
+    return copy;
+}
+
+hashset_t* hashset_union(hashset_t* lhs, hashset_t* rhs)
+{
+    hashset_t* larger = lhs->size >= rhs->size ? lhs : rhs;
+    hashset_t* smaller = larger == lhs ? rhs : lhs;
+    hashset_t* result = copy_with_room_(larger, larger->size + smaller->size);
+
+    for(uint32_t i = 0; i < smaller->capacity; i++)
+    {
+        char* key = smaller->keys[i];
+        if(!is_key_(key)) continue;
+        int64_t insert_idx;
+        uint32_t key_hash = hash(key);
+        if(find_slot_(result, key, key_hash, &insert_idx) >= 0) continue;
+        place_(result, copy_key_(key), key_hash);
+    }
+
+    if(hashtable_logs) hashtable_log(INFO, "hashset_union", "union of %u and %u keys has %u keys", lhs->size, rhs->size, result->size);
+    return result;
+}
+
+hashset_t* hashset_intersection(hashset_t* lhs, hashset_t* rhs)
+{
+    hashset_t* larger = lhs->size >= rhs->size ? lhs : rhs;
+    hashset_t* smaller = larger == lhs ? rhs : lhs;
+    hashset_t* result = hashset_init(capacity_for_(smaller->size));
+
+    for(uint32_t i = 0; i < smaller->capacity; i++)
+    {
+        char* key = smaller->keys[i];
+        if(!is_key_(key)) continue;
+        int64_t insert_idx;
+        uint32_t key_hash = hash(key);
+        if(find_slot_(larger, key, key_hash, &insert_idx) >= 0) place_(result, copy_key_(key), key_hash);
+    }
+
+    if(hashtable_logs) hashtable_log(INFO, "hashset_intersection", "intersection of %u and %u keys has %u keys", lhs->size, rhs->size, result->size);
+    return result;
+}
+
+hashset_t* hashset_difference(hashset_t* lhs, hashset_t* rhs)
+{
+    hashset_t* result;
+    if(lhs->size <= rhs->size) //keep the keys of lhs missing from rhs
+    {
+        result = hashset_init(capacity_for_(lhs->size));
+        for(uint32_t i = 0; i < lhs->capacity; i++)
+        {
+            char* key = lhs->keys[i];
+            if(!is_key_(key)) continue;
+            int64_t insert_idx;
+            uint32_t key_hash = hash(key);
+            if(find_slot_(rhs, key, key_hash, &insert_idx) < 0) place_(result, copy_key_(key), key_hash);
+        }
+    }
+    else //remove the keys of rhs from a copy of lhs
+    {
+        result = hashset_copy(lhs);
+        for(uint32_t i = 0; i < rhs->capacity; i++)
+        {
+            char* key = rhs->keys[i];
+            if(is_key_(key)) delete_hashed_(result, key, hash(key));
+        }
+    }
+
+    if(hashtable_logs) hashtable_log(INFO, "hashset_difference", "difference of %u and %u keys has %u keys", lhs->size, rhs->size, result->size);
+    return result;
+}
@@ -0,0 +1,80 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: string hashset, a hashtable without values
+
+This header describes the interface to a hashset, for tables that only need to know whether a key
+is present (dedup, membership...).  Its slots hold nothing but the key pointer, so they take half
+the memory of cell_t slots and no dummy value has to be passed around.  It hashes and probes like
+hashtable_t (same hash, same probe sequence), and removed keys leave a tombstone so probe chains
+stay intact.  Keys are memory managed by the hashset.
+
+Set algebra (union, intersection, difference) builds a new hashset in a single pass over the
+smaller operand: each of its keys is hashed once, and that hash is used both to probe the larger
+operand and to insert into the result.  The result is sized up front so it never resizes midway.
+*/
+
+#ifndef INCLUDE_HASHSET_H
+#define INCLUDE_HASHSET_H
+
+#include "hashtable.h"
+
+//struct to represent a hashset.
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t size;
+    uint32_t tombstones; //removed keys that probes skip over, dropped by the next rehash
+    char** keys;         //NULL for empty slots
+} hashset_t;
+
+//initialize a hashset with passed capacity, which must be a power of 2.
+//returns a pointer to the new hashset
+hashset_t* hashset_init(uint32_t capacity);
+
+//cleanup the passed hashset.
+void hashset_cleanup(hashset_t* set);
+
+//resize the given hashset to new_capacity, if possible. resizing to the current capacity
+//rehashes in place, dropping tombstones.
+//returns the new capacity of the hashset.
+uint32_t hashset_resize(hashset_t* set, uint32_t new_capacity);
+
+//squash the given hashset to it's smallest possible memory footprint.
+//returns the new capacity of the hashset.
+uint32_t hashset_squash(hashset_t* set);
+
+//clear the given hashset, making it empty.
+//returns the number of deleted keys.
+uint32_t hashset_clear(hashset_t* set);
+
+//insert a key into the passed hashset, with flags to control automatic resizing and moving the key
+//(which must then be allocated with malloc) instead of copying it.
+//returns OK, DUPLICATE_KEY or HASHTABLE_FULL.
+STATUS hashset_insert_(hashset_t* set, char* key, bool auto_resize, bool move);
+
+//insert a copy of a key into the passed hashset, and automatically resize if need be.
+//returns OK, DUPLICATE_KEY or HASHTABLE_FULL.
+STATUS hashset_insert(hashset_t* set, char* key);
+
+//returns true if the key is in the passed hashset.
+bool hashset_contains(hashset_t* set, char* key);
+
+//delete a key from the passed hashset.
+//returns OK or KEY_NOT_FOUND.
+STATUS hashset_delete(hashset_t* set, char* key);
+
+//perform a deep copy of the passed hashset.
+//returns a pointer to the copy.
+hashset_t* hashset_copy(hashset_t* set);
+
+//returns a new hashset with the keys in lhs or rhs (or both).
+hashset_t* hashset_union(hashset_t* lhs, hashset_t* rhs);
+
+//returns a new hashset with the keys in both lhs and rhs.
+hashset_t* hashset_intersection(hashset_t* lhs, hashset_t* rhs);
+
+//returns a new hashset with the keys in lhs but not in rhs.
+hashset_t* hashset_difference(hashset_t* lhs, hashset_t* rhs);
+
+#endif //INCLUDE_HASHSET_H
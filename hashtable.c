@@ -1,17 +1,13 @@
 /*
 Author: Dante Crescenzi
-Last Modif: 28 Mar 2024
+Last Modif: 19 Oct 2026
 Description: impl of hashtable methods outlined in hashtable.h
 */
 
 #include "hashtable.h"
-
-typedef enum
-{
-    INFO,
-    WARN,
-    ERROR
-} LOG_TYPE;
+#include "hashtable_internal.h"
+#include <time.h>
+#include <malloc.h>
 
 void hashtable_log(LOG_TYPE type, const char* location, const char* fmt, ...)
 {
@@ -43,6 +39,317 @@ void hashtable_log(LOG_TYPE type, const char* location, const char* fmt, ...)
     fprintf(stdout, "\n");
 }
 
+//local utilities, defined below
+static cell_info_t insert_hashed_(hashtable_t* hashtable, char* key, uint32_t key_hash, value_type value, bool auto_resize, bool move, bool interned);
+static cell_info_t lookup_hashed_(hashtable_t* hashtable, char* key, uint32_t key_hash);
+static char* intern_hashed_(key_pool_t* pool, char* key, uint32_t key_hash);
+
+#define KEY_CACHE_MIN_BYTES 16
+
+static char* cached_key_buffer_(key_cache_t* key_cache, size_t bytes) //local utility
+{
+    if(bytes > (KEY_CACHE_MIN_BYTES << (KEY_CACHE_CLASSES - 1))) return (char*)malloc(bytes);
+    int key_class = 0;
+    while((size_t)(KEY_CACHE_MIN_BYTES << key_class) < bytes) key_class++;
+
+    //the allocator may have handed out more than asked, so buffers of a larger class are fine too
+    for(int c = key_class; c < KEY_CACHE_CLASSES; c++)
+    {
+        char* buffer = key_cache->free_lists[c];
+        if(buffer == NULL) continue;
+        memcpy(&key_cache->free_lists[c], buffer, sizeof(char*));
+        key_cache->bytes -= malloc_usable_size(buffer);
+        key_cache->reused++;
+        return buffer;
+    }
+    //the whole class so the buffer comes back to it once freed
+    key_cache->allocated++;
+    return (char*)malloc(KEY_CACHE_MIN_BYTES << key_class);
+}
+
+static void cache_key_buffer_(key_cache_t* key_cache, char* buffer) //local utility
+{
+    //moved in keys were allocated by the caller, so classes go by what the allocator actually
+    //handed out, which every buffer of a class is at least as large as
+    size_t usable = malloc_usable_size(buffer);
+    int key_class = -1;
+    while(key_class + 1 < KEY_CACHE_CLASSES && (size_t)(KEY_CACHE_MIN_BYTES << (key_class + 1)) <= usable) key_class++;
+    if(key_class < 0 || usable >= (KEY_CACHE_MIN_BYTES << KEY_CACHE_CLASSES) || key_cache->bytes + usable > key_cache->max_bytes)
+    {
+        free(buffer);
+        return;
+    }
+    memcpy(buffer, &key_cache->free_lists[key_class], sizeof(char*));
+    key_cache->free_lists[key_class] = buffer;
+    key_cache->bytes += usable;
+}
+
+static size_t key_cache_release_(key_cache_t* key_cache) //local utility, frees every buffer held
+{
+    size_t released = key_cache->bytes;
+    for(int c = 0; c < KEY_CACHE_CLASSES; c++)
+    {
+        while(key_cache->free_lists[c])
+        {
+            char* buffer = key_cache->free_lists[c];
+            memcpy(&key_cache->free_lists[c], buffer, sizeof(char*));
+            free(buffer);
+        }
+    }
+    key_cache->bytes = 0;
+    return released;
+}
+
+static char* copy_key_(hashtable_t* hashtable, char* key, uint32_t key_hash) //local utility
+{
+    if(hashtable->pool) return intern_hashed_(hashtable->pool, key, key_hash);
+
+    size_t key_len = strlen(key);
+    char* copy = hashtable->key_cache ? cached_key_buffer_(hashtable->key_cache, key_len + 1) : (char*)malloc((sizeof(char)*key_len) + 1);
+    memcpy(copy, key, key_len + 1);
+    return copy;
+}
+
+static void free_key_(hashtable_t* hashtable, char* key) //local utility
+{
+    if(hashtable->pool) key_pool_release(hashtable->pool, key);
+    else if(hashtable->key_cache) cache_key_buffer_(hashtable->key_cache, key);
+    else free(key);
+}
+
+static uint32_t key_hash_(hashtable_t* hashtable, char* key) //local utility, reuses the hash stored by the pool
+{
+    return hashtable->pool ? ((pooled_key_t*)key - 1)->hash : hash(key);
+}
+
+#define FILTER_WORDS_PER_BLOCK 8 //64 byte blocks
+#define FILTER_BITS_PER_KEY 6
+
+static key_filter_t* filter_init_(uint32_t capacity) //local utility, sized to about a byte per slot
+{
+    key_filter_t* filter = (key_filter_t*)malloc(sizeof(key_filter_t));
+    filter->num_blocks = capacity >= 64 ? capacity / 64 : 1;
+    filter->stale = 0;
+    filter->bits = (uint64_t*)calloc((size_t)filter->num_blocks * FILTER_WORDS_PER_BLOCK, sizeof(uint64_t));
+    return filter;
+}
+
+static void filter_cleanup_(key_filter_t* filter) //local utility
+{
+    free(filter->bits);
+    free(filter);
+}
+
+static uint64_t filter_mix_(uint32_t key_hash) //local utility, spreads the key hash over 64 bits
+{
+    uint64_t x = key_hash * 0x9E3779B97F4A7C15ull;
+    x ^= x >> 29;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 32;
+    return x;
+}
+
+static uint64_t* filter_block_(key_filter_t* filter, uint32_t key_hash) //local utility
+{
+    uint32_t x = key_hash * 0x85EBCA6Bu;
+    x ^= x >> 16;
+    return filter->bits + (size_t)(x & (filter->num_blocks - 1)) * FILTER_WORDS_PER_BLOCK;
+}
+
+//every 9 bits of the mix pick a bit of the block of the key
+static void filter_add_(key_filter_t* filter, uint32_t key_hash) //local utility
+{
+    uint64_t x = filter_mix_(key_hash);
+    uint64_t* block = filter_block_(filter, key_hash);
+    for(int i = 0; i < FILTER_BITS_PER_KEY; i++, x >>= 9) block[(x >> 6) & 7] |= 1ull << (x & 63);
+}
+
+static bool filter_maybe_contains_(key_filter_t* filter, uint32_t key_hash) //local utility
+{
+    uint64_t x = filter_mix_(key_hash);
+    uint64_t* block = filter_block_(filter, key_hash);
+    bool found = true;
+    for(int i = 0; i < FILTER_BITS_PER_KEY; i++, x >>= 9) found &= (block[(x >> 6) & 7] >> (x & 63)) & 1;
+    return found;
+}
+
+static void filter_rebuild_(hashtable_t* hashtable) //local utility
+{
+    key_filter_t* filter = filter_init_(hashtable->capacity);
+    for(uint32_t i = 0; i < hashtable->capacity; i++)
+    {
+        char* key = hashtable->data[i].key;
+        if(key) filter_add_(filter, key_hash_(hashtable, key));
+    }
+    if(hashtable->filter) filter_cleanup_(hashtable->filter);
+    hashtable->filter = filter;
+}
+
+static hot_cache_t* hot_cache_init_(uint32_t num_entries) //local utility
+{
+    hot_cache_t* hot_cache = (hot_cache_t*)malloc(sizeof(hot_cache_t));
+    hot_cache->num_entries = num_entries;
+    hot_cache->hits = 0;
+    hot_cache->misses = 0;
+    //zeroed entries can't match, any key of length 0 hashes to HASHTABLE_SEED
+    hot_cache->entries = (hot_entry_t*)calloc(num_entries, sizeof(hot_entry_t));
+    return hot_cache;
+}
+
+static void hot_cache_cleanup_(hot_cache_t* hot_cache) //local utility
+{
+    free(hot_cache->entries);
+    free(hot_cache);
+}
+
+static hot_entry_t* hot_entry_(hot_cache_t* hot_cache, uint32_t key_hash) //local utility
+{
+    //the low bits of the hash pick the slot, so mix in the high bits to pick the entry
+    uint32_t x = key_hash * 0x9E3779B1u;
+    return &hot_cache->entries[((uint64_t)x * hot_cache->num_entries) >> 32];
+}
+
+static void hot_cache_forget_(hot_cache_t* hot_cache, uint32_t key_hash) //local utility
+{
+    hot_entry_t* entry = hot_entry_(hot_cache, key_hash);
+    if(entry->hash == key_hash) memset(entry, 0, sizeof(hot_entry_t));
+}
+
+static uint32_t hash_len_(char* key, uint32_t* len) //local utility, hash() that also measures the key
+{
+    uint32_t val = HASHTABLE_SEED;
+    char* start = key;
+    int c;
+
+    while((c = *key++)) val = ((val << 5) + val) + c;
+    *len = (uint32_t)(key - start - 1);
+    return val;
+}
+
+#define EXPIRY_TICK_MS 16
+#define EXPIRY_SLOT_BITS 6 //log2 of EXPIRY_WHEEL_SLOTS
+
+static uint64_t monotonic_ms_(void) //local utility, default expiry clock
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static hashtable_expiry_t* expiry_init_(uint32_t capacity, hashtable_clock_fn clock) //local utility
+{
+    hashtable_expiry_t* expiry = (hashtable_expiry_t*)calloc(1, sizeof(hashtable_expiry_t));
+    expiry->expires_at = (uint64_t*)calloc(capacity, sizeof(uint64_t));
+    expiry->clock = clock ? clock : monotonic_ms_;
+    expiry->tick = expiry->clock() / EXPIRY_TICK_MS;
+    return expiry;
+}
+
+static void expiry_cleanup_(hashtable_expiry_t* expiry) //local utility
+{
+    for(uint32_t level = 0; level < EXPIRY_WHEEL_LEVELS; level++)
+        for(uint32_t slot = 0; slot < EXPIRY_WHEEL_SLOTS; slot++) free(expiry->wheel[level][slot].entries);
+    free(expiry->pending.entries);
+    free(expiry->expires_at);
+    free(expiry);
+}
+
+static void expiry_reset_(hashtable_expiry_t* expiry, uint32_t capacity) //local utility, forgets every deadline
+{
+    for(uint32_t level = 0; level < EXPIRY_WHEEL_LEVELS; level++)
+    {
+        for(uint32_t slot = 0; slot < EXPIRY_WHEEL_SLOTS; slot++) expiry->wheel[level][slot].size = 0;
+        expiry->level_size[level] = 0;
+    }
+    expiry->pending.size = 0;
+    expiry->tombstones = 0;
+    memset(expiry->expires_at, 0, sizeof(uint64_t) * capacity);
+}
+
+static void bucket_reserve_(expiry_bucket_t* bucket, uint32_t size) //local utility
+{
+    if(size <= bucket->capacity) return;
+    while(bucket->capacity < size) bucket->capacity = bucket->capacity ? bucket->capacity << 1 : 4;
+    bucket->entries = (expiry_entry_t*)realloc(bucket->entries, sizeof(expiry_entry_t) * bucket->capacity);
+}
+
+static void expiry_schedule_(hashtable_expiry_t* expiry, uint32_t key_hash, uint64_t expires_at) //local utility
+{
+    //deadlines already due go in the slot swept next, deadlines past the last level go in its
+    //furthest slot, and get rescheduled from there once it is cascaded
+    uint64_t tick = expires_at / EXPIRY_TICK_MS;
+    uint64_t horizon = 1ull << (EXPIRY_SLOT_BITS * EXPIRY_WHEEL_LEVELS);
+    if(tick < expiry->tick) tick = expiry->tick;
+    if(tick - expiry->tick >= horizon) tick = expiry->tick + horizon - 1;
+
+    uint32_t level = 0;
+    while(level + 1 < EXPIRY_WHEEL_LEVELS && tick - expiry->tick >= 1ull << (EXPIRY_SLOT_BITS * (level + 1))) level++;
+    expiry_bucket_t* bucket = &expiry->wheel[level][(tick >> (EXPIRY_SLOT_BITS * level)) & (EXPIRY_WHEEL_SLOTS - 1)];
+
+    bucket_reserve_(bucket, bucket->size + 1);
+    bucket->entries[bucket->size].expires_at = expires_at;
+    bucket->entries[bucket->size].hash = key_hash;
+    bucket->size++;
+    expiry->level_size[level]++;
+}
+
+static bool is_tombstone_(hashtable_t* hashtable, uint32_t idx) //local utility
+{
+    return hashtable->expiry && hashtable->expiry->expires_at[idx] == EXPIRY_TOMBSTONE;
+}
+
+static void claim_slot_(hashtable_t* hashtable, uint32_t idx) //local utility, before filling an empty slot
+{
+    if(!is_tombstone_(hashtable, idx)) return;
+    hashtable->expiry->expires_at[idx] = 0;
+    hashtable->expiry->tombstones--;
+}
+
+static bool is_expired_(hashtable_t* hashtable, uint32_t idx) //local utility
+{
+    //only keys with a ttl pay for reading the clock
+    if(hashtable->expiry == NULL) return false;
+    uint64_t expires_at = hashtable->expiry->expires_at[idx];
+    return expires_at && expires_at <= hashtable->expiry->clock();
+}
+
+static void set_deadline_(hashtable_t* hashtable, cell_t* cell, uint64_t ttl_ms) //local utility
+{
+    hashtable_expiry_t* expiry = hashtable->expiry;
+    uint64_t expires_at = ttl_ms ? expiry->clock() + ttl_ms : 0;
+    expiry->expires_at[cell - hashtable->data] = expires_at;
+    if(expires_at) expiry_schedule_(expiry, key_hash_(hashtable, cell->key), expires_at);
+}
+
+//returns the ttl left to the live key in slot idx at time now (of the hashtable's clock), 0 if it
+//never expires. used to carry deadlines over to a hashtable that may run on another clock.
+static uint64_t ttl_left_(hashtable_t* hashtable, uint32_t idx, uint64_t now) //local utility
+{
+    if(hashtable->expiry == NULL) return 0;
+    uint64_t expires_at = hashtable->expiry->expires_at[idx];
+    if(expires_at == 0 || expires_at == EXPIRY_TOMBSTONE) return 0;
+    return expires_at > now ? expires_at - now : 1;
+}
+
+static void remove_cell_(hashtable_t* hashtable, uint32_t idx) //local utility
+{
+    if(hashtable->hot_cache) hot_cache_forget_(hashtable->hot_cache, key_hash_(hashtable, hashtable->data[idx].key));
+    free_key_(hashtable, hashtable->data[idx].key);
+    hashtable->data[idx].key = NULL;
+    HASHTABLE_VALUE_DESTROY(hashtable->data[idx].value);
+    hashtable->size--;
+    //expiring hashtables empty slots in bulk, so they leave a tombstone for probes to skip over
+    //instead of cutting off the keys further down the probe chain
+    if(hashtable->expiry)
+    {
+        hashtable->expiry->expires_at[idx] = EXPIRY_TOMBSTONE;
+        hashtable->expiry->tombstones++;
+    }
+
+    //bits can't be unset (they may be shared with other keys), so rebuild once stale bits dominate
+    if(hashtable->filter && ++hashtable->filter->stale > hashtable->size) filter_rebuild_(hashtable);
+}
+
 hashtable_t* hashtable_init(uint32_t capacity)
 {
     bool capacity_is_not_power_of_2 = capacity & (capacity - 1);
@@ -57,29 +364,151 @@ hashtable_t* hashtable_init(uint32_t capacity)
     hashtable->capacity = capacity;
     hashtable->size = 0;
     hashtable->data = (cell_t*)malloc(sizeof(cell_t) * capacity);
+    hashtable->pool = NULL;
+    hashtable->lock = NULL;
+    hashtable->filter = NULL;
+    hashtable->hot_cache = NULL;
+    hashtable->key_cache = NULL;
+    hashtable->resize_threads = 1;
+    hashtable->generation = 0;
+    hashtable->expiry = NULL;
     for(uint32_t i = 0; i < hashtable->capacity; i++) hashtable->data[i].key = NULL;
 
     if(hashtable_logs) hashtable_log(INFO, "hashtable_init", "created and initialized hashtable of capacity %u", capacity);
     return hashtable;
 }
 
+hashtable_t* hashtable_init_counter(uint32_t capacity)
+{
+    hashtable_t* hashtable = hashtable_init(capacity);
+    if(hashtable == NULL) return NULL;
+    hashtable->lock = (pthread_rwlock_t*)malloc(sizeof(pthread_rwlock_t));
+    pthread_rwlock_init(hashtable->lock, NULL);
+    return hashtable;
+}
+
+hashtable_t* hashtable_init_pooled(uint32_t capacity, key_pool_t* pool)
+{
+    hashtable_t* hashtable = hashtable_init(capacity);
+    if(hashtable) hashtable->pool = pool;
+    return hashtable;
+}
+
 void hashtable_cleanup(hashtable_t* hashtable)
 {
     if(hashtable_logs) hashtable_log(INFO, "hashtable_cleanup", "destroying hashtable of capacity %u with %u elements", hashtable->capacity, hashtable->size);
+    hashtable_disable_key_cache(hashtable); //no point keeping buffers that will never be reused
     for(uint32_t i = 0; i < hashtable->capacity; i++)
     {
-        free(hashtable->data[i].key);
+        if(hashtable->data[i].key == NULL) continue;
+        free_key_(hashtable, hashtable->data[i].key);
         hashtable->data[i].key = NULL;
-        //<customize> cleanup any resources tied to value
+        HASHTABLE_VALUE_DESTROY(hashtable->data[i].value);
     }
     free(hashtable->data);
     hashtable->data = NULL;
+    if(hashtable->lock)
+    {
+        pthread_rwlock_destroy(hashtable->lock);
+        free(hashtable->lock);
+    }
+    if(hashtable->filter) filter_cleanup_(hashtable->filter);
+    if(hashtable->hot_cache) hot_cache_cleanup_(hashtable->hot_cache);
+    if(hashtable->expiry) expiry_cleanup_(hashtable->expiry);
     free(hashtable);
 }
 
+//shared state of the threads of a parallel resize
+typedef struct
+{
+    hashtable_t* hashtable;
+    cell_t* new_data;
+    uint32_t new_capacity;
+    key_filter_t* new_filter;
+    uint64_t* new_expires_at;
+    uint32_t num_threads;
+} resize_job_t;
+
+//per thread state of a parallel resize
+typedef struct
+{
+    resize_job_t* job;
+    uint32_t chunk;
+} resize_worker_t;
+
+static void* resize_worker_(void* arg) //local utility, moves the keys of one chunk of the old slots
+{
+    resize_worker_t* worker = (resize_worker_t*)arg;
+    resize_job_t* job = worker->job;
+    hashtable_t* hashtable = job->hashtable;
+    uint32_t begin = (uint32_t)(((uint64_t)hashtable->capacity * worker->chunk) / job->num_threads);
+    uint32_t end = (uint32_t)(((uint64_t)hashtable->capacity * (worker->chunk + 1)) / job->num_threads);
+
+    for(uint32_t i = begin; i < end; i++)
+    {
+        cell_t cell = hashtable->data[i];
+        if(cell.key == NULL) continue;
+        uint32_t key_hash = key_hash_(hashtable, cell.key);
+
+        //keys are unique, so the first empty slot of the probe sequence that this thread manages to
+        //claim is the key's, no comparison needed
+        int probe = 0;
+        while(true)
+        {
+            cell_t* dest = &job->new_data[probe_idx(key_hash, probe, job->new_capacity)];
+            char* empty = NULL;
+            if(__atomic_compare_exchange_n(&dest->key, &empty, cell.key, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                //values are relocated bit for bit, never copied
+                dest->value = cell.value;
+                if(job->new_expires_at) job->new_expires_at[dest - job->new_data] = hashtable->expiry->expires_at[i];
+                break;
+            }
+            probe++;
+        }
+
+        if(job->new_filter) //filter blocks are shared between threads
+        {
+            uint64_t x = filter_mix_(key_hash);
+            uint64_t* block = filter_block_(job->new_filter, key_hash);
+            for(int b = 0; b < FILTER_BITS_PER_KEY; b++, x >>= 9) __atomic_fetch_or(&block[(x >> 6) & 7], 1ull << (x & 63), __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+//move every key of the hashtable to new slots on its resize threads.
+//returns the new slots, the old ones are left as they were.
+static cell_t* move_cells_parallel_(hashtable_t* hashtable, uint32_t new_capacity, key_filter_t* new_filter, uint64_t* new_expires_at) //local utility
+{
+    resize_job_t job;
+    job.hashtable = hashtable;
+    job.new_data = (cell_t*)calloc(new_capacity, sizeof(cell_t)); //zeroed cells have NULL keys
+    job.new_capacity = new_capacity;
+    job.new_filter = new_filter;
+    job.new_expires_at = new_expires_at;
+    job.num_threads = hashtable->resize_threads;
+
+    resize_worker_t* workers = (resize_worker_t*)malloc(sizeof(resize_worker_t) * job.num_threads);
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * job.num_threads);
+    for(uint32_t t = 0; t < job.num_threads; t++)
+    {
+        workers[t].job = &job;
+        workers[t].chunk = t;
+        pthread_create(&threads[t], NULL, resize_worker_, &workers[t]);
+    }
+    for(uint32_t t = 0; t < job.num_threads; t++) pthread_join(threads[t], NULL);
+    free(workers);
+    free(threads);
+
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_resize", "moved %u elements on %u threads", hashtable->size, job.num_threads);
+    return job.new_data;
+}
+
 uint32_t hashtable_resize(hashtable_t* hashtable, uint32_t new_capacity)
 {
-    if(new_capacity == hashtable->capacity) return new_capacity;
+    bool has_tombstones = hashtable->expiry && hashtable->expiry->tombstones;
+    if(new_capacity == hashtable->capacity && !has_tombstones) return new_capacity;
     if(new_capacity == 1 << 31)
     {
         if(hashtable_logs) hashtable_log(WARN, "hashtable_resize", "resized to max capacity");
@@ -97,24 +526,65 @@ uint32_t hashtable_resize(hashtable_t* hashtable, uint32_t new_capacity)
         return hashtable->capacity;
     }
 
-    hashtable_t* tmp_hashtable = hashtable_init(new_capacity);
+    key_filter_t* new_filter = hashtable->filter ? filter_init_(new_capacity) : NULL;
+    uint64_t* new_expires_at = hashtable->expiry ? (uint64_t*)calloc(new_capacity, sizeof(uint64_t)) : NULL;
+    cell_t* new_data;
 
-    for(uint32_t i = 0; i < hashtable->capacity; i++)
+    if(hashtable->resize_threads > 1 && hashtable->size >= PARALLEL_RESIZE_MIN_KEYS)
     {
-        cell_t cell = hashtable->data[i];
-        if(cell.key == NULL) continue;
-        hashtable_insert_(tmp_hashtable, cell.key, cell.value, /*resize*/ false, /*move*/ true);
-        hashtable->data[i].key = NULL;
-        //<customize> handle the fact that value may have been moved (prevent double free)
+        new_data = move_cells_parallel_(hashtable, new_capacity, new_filter, new_expires_at);
+    }
+    else
+    {
+        hashtable_t* tmp_hashtable = hashtable_init(new_capacity);
+        tmp_hashtable->pool = hashtable->pool;
+        for(uint32_t i = 0; i < hashtable->capacity; i++)
+        {
+            cell_t cell = hashtable->data[i];
+            if(cell.key == NULL) continue;
+            //keys are unique, so they can be compared by pointer whether or not they are pooled
+            uint32_t key_hash = key_hash_(hashtable, cell.key);
+            cell_info_t moved = insert_hashed_(tmp_hashtable, cell.key, key_hash, cell.value, /*resize*/ false, /*move*/ true, /*interned*/ true);
+            if(new_filter) filter_add_(new_filter, key_hash);
+            //deadlines follow their key, the wheel refers to keys by hash so it's unaffected
+            if(new_expires_at) new_expires_at[moved.cell - tmp_hashtable->data] = hashtable->expiry->expires_at[i];
+            //the value was moved bit for bit along with the key, the old slot just forgets both
+            hashtable->data[i].key = NULL;
+        }
+        new_data = tmp_hashtable->data;
+        free(tmp_hashtable);
     }
 
-    hashtable_swap(hashtable, tmp_hashtable);
-    hashtable_cleanup(tmp_hashtable);
+    //only take over the storage (every old key has been moved out), anything else attached to
+    //the hashtable stays put
+    free(hashtable->data);
+    hashtable->data = new_data;
+    hashtable->capacity = new_capacity;
+    hashtable->generation++;
+    if(new_filter)
+    {
+        filter_cleanup_(hashtable->filter);
+        hashtable->filter = new_filter;
+    }
+    if(new_expires_at)
+    {
+        free(hashtable->expiry->expires_at);
+        hashtable->expiry->expires_at = new_expires_at;
+        hashtable->expiry->tombstones = 0;
+    }
+    //every key moved, so every entry is stale
+    if(hashtable->hot_cache) memset(hashtable->hot_cache->entries, 0, sizeof(hot_entry_t) * hashtable->hot_cache->num_entries);
 
     if(hashtable_logs) hashtable_log(INFO, "hashtable_resize", "resized hashtable to new capacity %u", new_capacity);
     return new_capacity;
 }
 
+void hashtable_set_resize_threads(hashtable_t* hashtable, uint32_t num_threads)
+{
+    hashtable->resize_threads = num_threads ? num_threads : 1;
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_set_resize_threads", "resizes will use %u threads", hashtable->resize_threads);
+}
+
 uint32_t hashtable_squash(hashtable_t* hashtable)
 {
     uint32_t cur_size = hashtable->size;
@@ -145,13 +615,21 @@ uint32_t hashtable_clear(hashtable_t* hashtable)
     uint32_t num_deletions = 0;
     for(uint32_t i = 0; i < hashtable->capacity; i++)
     {
-        num_deletions += (hashtable->data[i].key == NULL ? 0 : 1);
-        free(hashtable->data[i].key);
+        if(hashtable->data[i].key == NULL) continue;
+        num_deletions++;
+        free_key_(hashtable, hashtable->data[i].key);
         hashtable->data[i].key = NULL;
-        //<customize> cleanup any resources tied to value
+        HASHTABLE_VALUE_DESTROY(hashtable->data[i].value);
     }
 
     hashtable->size = 0;
+    if(hashtable->filter)
+    {
+        memset(hashtable->filter->bits, 0, sizeof(uint64_t) * hashtable->filter->num_blocks * FILTER_WORDS_PER_BLOCK);
+        hashtable->filter->stale = 0;
+    }
+    if(hashtable->hot_cache) memset(hashtable->hot_cache->entries, 0, sizeof(hot_entry_t) * hashtable->hot_cache->num_entries);
+    if(hashtable->expiry) expiry_reset_(hashtable->expiry, hashtable->capacity);
     if(hashtable_logs) hashtable_log(INFO, "hashtable_clear", "cleared %u elements from hashtable", num_deletions);
     return num_deletions;
 }
@@ -173,12 +651,32 @@ bool hashtable_merge(hashtable_t* dest, hashtable_t* src)
         return false;
     }
 
+    //keys interned in the same pool are shared and compared by pointer instead of copied
+    bool shared_pool = dest->pool && dest->pool == src->pool;
     bool conflict = false;
+    uint64_t src_now = src->expiry ? src->expiry->clock() : 0;
     for(uint32_t i = 0; i < src->capacity; i++)
     {
         cell_t cell = src->data[i];
         if(cell.key == NULL) continue;
-        cell_info_t info = hashtable_insert_(dest, cell.key, cell.value, /*resize*/ true, /*move*/ false);
+        //expired keys are only waiting to be swept, and keys with a ttl keep it in dest
+        uint64_t expires_at = src->expiry ? src->expiry->expires_at[i] : 0;
+        if(expires_at && expires_at <= src_now) continue;
+        uint64_t ttl_ms = ttl_left_(src, i, src_now);
+        if(ttl_ms && dest->expiry == NULL) hashtable_enable_expiry(dest, src->expiry->clock);
+        cell_info_t info;
+        if(shared_pool)
+        {
+            info = insert_hashed_(dest, cell.key, key_hash_(src, cell.key), cell.value, /*resize*/ true, /*move*/ true, /*interned*/ true);
+            //only the key is shared, src keeps its value so dest needs a copy of its own
+            if(info.status == OK)
+            {
+                key_pool_retain(cell.key);
+                HASHTABLE_VALUE_COPY(&info.cell->value, cell.value);
+            }
+        }
+        else info = insert_hashed_(dest, cell.key, key_hash_(src, cell.key), cell.value, /*resize*/ true, /*move*/ false, /*interned*/ false);
+        if(info.status == OK && dest->expiry) set_deadline_(dest, info.cell, ttl_ms);
         if(hashtable_logs && info.status != OK) hashtable_log(WARN, "hashtable_merge", "found conflicting key '%s' during merge", cell.key);
         conflict |= info.status != OK;
     }
@@ -186,118 +684,463 @@ bool hashtable_merge(hashtable_t* dest, hashtable_t* src)
     return conflict;
 }
 
-hashtable_t* hashtable_copy(hashtable_t* hashtable)
+//slot of a src key, listed by the hash pass under the partition its hash falls in
+typedef struct
 {
-    hashtable_t* copy = hashtable_init(hashtable->capacity);
-    for(uint32_t i = 0; i < hashtable->capacity; i++)
-    {
-        cell_t cell = hashtable->data[i];
-        if(cell.key == NULL) continue;
-        hashtable_insert_(copy, cell.key, cell.value, /*resize*/ false, /*move*/ false);
-    }
-    if(hashtable_logs) hashtable_log(INFO, "hashtable_copy", "copied hashtable of size %u, capacity %u", hashtable->size, hashtable->capacity);
-    return copy;
-}
+    uint32_t src;
+    uint32_t idx;
+    uint32_t hash;
+} merge_slot_t;
 
-uint32_t hash(char* key) //local utility
+typedef struct
 {
-    uint32_t val = 5381;
-    int c;
-
-    while(c = *key++) val = ((val << 5) + val) + c;
-    return val;
-}
+    merge_slot_t* slots;
+    uint32_t size;
+    uint32_t capacity;
+} merge_slot_list_t;
 
-uint32_t mod(uint32_t n, uint32_t d) //local utility
+//shared state of the threads of a parallel merge
+typedef struct
 {
-    return n & (d - 1);
-}
+    hashtable_t* dest;
+    hashtable_t** srcs;
+    uint32_t num_srcs;
+    hashtable_combine_fn combine;
+    uint32_t num_threads;
+    merge_slot_list_t** lists; //lists[t][p], keys hashed by thread t that fall in partition p
+    uint64_t* src_nows; //clock of every src with expiry, read once
+    uint64_t dest_now;
+} merge_job_t;
 
-cell_info_t hashtable_insert_(hashtable_t* hashtable, char* key, value_type value, bool auto_resize, bool move)
+//per thread state of a parallel merge
+typedef struct
 {
-    cell_info_t insertion_result;
-    insertion_result.cell = NULL;
+    merge_job_t* job;
+    uint32_t partition;
+    uint32_t inserted;
+    bool conflict;
+    uint32_t* timed; //dest slots given a deadline, scheduled once the threads are done
+    uint32_t num_timed;
+    uint32_t timed_capacity;
+} merge_worker_t;
 
-    if(hashtable->size == hashtable->capacity)
+static void list_slot_(merge_worker_t* worker, uint32_t src, uint32_t idx, uint32_t key_hash) //local utility
+{
+    merge_job_t* job = worker->job;
+    merge_slot_list_t* list = &job->lists[worker->partition][(uint32_t)(((uint64_t)key_hash * job->num_threads) >> 32)];
+    if(list->size == list->capacity)
     {
-        if(hashtable_logs) hashtable_log(WARN, "hashtable_insert", "insertion of key '%s' failed, size has reached capacity %u", key, hashtable->capacity);
-        insertion_result.status = HASHTABLE_FULL;
-        return insertion_result;
+        list->capacity = list->capacity ? list->capacity << 1 : 64;
+        list->slots = (merge_slot_t*)realloc(list->slots, sizeof(merge_slot_t) * list->capacity);
     }
+    merge_slot_t* slot = &list->slots[list->size++];
+    slot->src = src;
+    slot->idx = idx;
+    slot->hash = key_hash;
+}
 
-    uint32_t base_idx = hash(key);
-    int probe = 0;
-
-    do
+//hashes one slice of every src, listing each key under its partition so partitions never scan
+//slots that aren't theirs
+static void* merge_hash_worker_(void* arg) //local utility
+{
+    merge_worker_t* worker = (merge_worker_t*)arg;
+    merge_job_t* job = worker->job;
+    for(uint32_t s = 0; s < job->num_srcs; s++)
     {
-        uint32_t unmod_idx = base_idx + ((probe*(probe+1)) >> 1);
-        uint32_t idx = mod(unmod_idx, hashtable->capacity);
+        hashtable_t* src = job->srcs[s];
+        uint32_t begin = (uint32_t)(((uint64_t)src->capacity * worker->partition) / job->num_threads);
+        uint32_t end = (uint32_t)(((uint64_t)src->capacity * (worker->partition + 1)) / job->num_threads);
+        if(src->pool) //the pool already stored every hash
+        {
+            for(uint32_t i = begin; i < end; i++)
+            {
+                char* key = src->data[i].key;
+                if(key) list_slot_(worker, s, i, key_hash_(src, key));
+            }
+            continue;
+        }
 
-        cell_t cell = hashtable->data[idx];
-        if(!cell.key) //empty slot
+        char* keys[64];
+        uint32_t idxs[64];
+        uint32_t hashes[64];
+        uint32_t count = 0;
+        for(uint32_t i = begin; i < end; i++) //gather keys to hash them a batch at a time
         {
-            if(move) //move in key and value
+            char* key = src->data[i].key;
+            if(key)
             {
-                hashtable->data[idx].key = key;
-                //<customize> properly handle resources while moving passed value to cell value
-                hashtable->data[idx].value = value;
+                keys[count] = key;
+                idxs[count++] = i;
             }
-            else //copy over key and value
+            if(count == 64 || (i + 1 == end && count))
             {
-                size_t key_len = strlen(key);
-                hashtable->data[idx].key = (char*)malloc((sizeof(char)*key_len) + 1);
-                strcpy(hashtable->data[idx].key, key);
-                //<customize> properly handle resources while assigning passed value to cell value
-                hashtable->data[idx].value = value;
+                hash_batch(keys, count, hashes);
+                for(uint32_t k = 0; k < count; k++) list_slot_(worker, s, idxs[k], hashes[k]);
+                count = 0;
             }
-
-            insertion_result.status = OK;
-            insertion_result.cell = &hashtable->data[idx];
-            hashtable->size++;
-            if(hashtable_logs) hashtable_log(INFO, "hashtable_insert", "insertion of key '%s' succeeded", key);
-            break;
-        }
-        else if(*key == *cell.key && strcmp(cell.key, key) == 0) //duplicate key
-        {
-            insertion_result.status = DUPLICATE_KEY;
-            insertion_result.cell = &hashtable->data[idx];
-            if(hashtable_logs) hashtable_log(WARN, "hashtable_insert", "insertion of key '%s' failed, duplicate key found", key);
-            break;
         }
-        probe++;
-    } while(true); //ok since passed first check
-
-    double load_factor = (double)hashtable->size / hashtable->capacity;
-    if(auto_resize &&
-       load_factor > MAX_LOAD_FACTOR && 
-       insertion_result.status == OK && 
-       hashtable->capacity < 1 << 31)
-    {
-        if(hashtable_logs) hashtable_log(INFO, "hashtable_insert", "insertion of key '%s' triggered resize to %u", key, hashtable->capacity << 1);
-        hashtable_resize(hashtable, hashtable->capacity << 1);
-        insertion_result = hashtable_lookup(hashtable, key);
     }
-
-    return insertion_result;
+    return NULL;
 }
 
-cell_info_t hashtable_insert(hashtable_t* hashtable, char* key, value_type value)
+static void* merge_partition_worker_(void* arg) //local utility, merges one partition of every src
 {
-    return hashtable_insert_(hashtable, key, value, /*resize*/ true, /*move*/ false);
-}
+    merge_worker_t* worker = (merge_worker_t*)arg;
+    merge_job_t* job = worker->job;
+    hashtable_t* dest = job->dest;
 
-cell_info_t hashtable_lookup(hashtable_t* hashtable, char* key)
-{
-    cell_info_t lookup_result;
-    lookup_result.cell = NULL;
+    for(uint32_t t = 0; t < job->num_threads; t++)
+    {
+        merge_slot_list_t* list = &job->lists[t][worker->partition];
+        for(uint32_t l = 0; l < list->size; l++)
+        {
+            uint32_t s = list->slots[l].src;
+            uint32_t i = list->slots[l].idx;
+            uint32_t key_hash = list->slots[l].hash;
+            hashtable_t* src = job->srcs[s];
+            bool shared_keys = src->pool == dest->pool;
+            char* key = src->data[i].key;
 
-    uint32_t base_idx = hash(key);
+            //expired keys are dropped like conflicts, keys with a ttl keep the time they had left
+            uint64_t ttl_ms = ttl_left_(src, i, job->src_nows[s]);
+            uint64_t expires_at = src->expiry ? src->expiry->expires_at[i] : 0;
+            if(expires_at && expires_at <= job->src_nows[s])
+            {
+                HASHTABLE_VALUE_DESTROY(src->data[i].value);
+                free_key_(src, key);
+                src->data[i].key = NULL;
+                continue;
+            }
+
+            //only this thread ever sees keys of its partition, so the only contention over dest is
+            //for empty slots, which are claimed with a CAS on the key
+            uint32_t base_idx = key_hash;
+            int probe = 0;
+            while(true)
+            {
+                cell_t* cell = &dest->data[probe_idx(base_idx, probe, dest->capacity)];
+
+                char* cell_key = __atomic_load_n(&cell->key, __ATOMIC_ACQUIRE);
+                char* moved_key = shared_keys ? key : NULL;
+                if(cell_key == NULL)
+                {
+                    if(moved_key == NULL) moved_key = copy_key_(dest, key, key_hash);
+                    if(__atomic_compare_exchange_n(&cell->key, &cell_key, moved_key, false, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+                    {
+                        //the src slot is emptied below, so its value is moved rather than copied
+                        cell->value = src->data[i].value;
+                        if(!shared_keys) free_key_(src, key);
+                        worker->inserted++;
+                        if(ttl_ms) //the slot is this thread's now, but the wheel is shared
+                        {
+                            uint32_t dest_idx = (uint32_t)(cell - dest->data);
+                            dest->expiry->expires_at[dest_idx] = job->dest_now + ttl_ms;
+                            if(worker->num_timed == worker->timed_capacity)
+                            {
+                                worker->timed_capacity = worker->timed_capacity ? worker->timed_capacity << 1 : 64;
+                                worker->timed = (uint32_t*)realloc(worker->timed, sizeof(uint32_t) * worker->timed_capacity);
+                            }
+                            worker->timed[worker->num_timed++] = dest_idx;
+                        }
+                        break;
+                    }
+                    if(!shared_keys) free_key_(dest, moved_key);
+                }
+
+                bool same_key = shared_keys && src->pool ? cell_key == key : strcmp(cell_key, key) == 0;
+                if(same_key)
+                {
+                    if(job->combine) job->combine(&cell->value, src->data[i].value);
+                    HASHTABLE_VALUE_DESTROY(src->data[i].value);
+                    free_key_(src, key);
+                    worker->conflict = true;
+                    break;
+                }
+                probe++;
+            }
+            src->data[i].key = NULL;
+        }
+    }
+    return NULL;
+}
+
+bool hashtable_merge_parallel(hashtable_t* dest, hashtable_t** srcs, uint32_t num_srcs, hashtable_combine_fn combine, uint32_t num_threads)
+{
+    //keys can only change hands without touching a (thread unsafe) pool if it's the same one
+    uint64_t total_size = dest->size;
+    for(uint32_t s = 0; s < num_srcs; s++)
+    {
+        if(srcs[s] == dest)
+        {
+            if(hashtable_logs) hashtable_log(ERROR, "hashtable_merge_parallel", "dest passed as one of the srcs, aborting");
+            return false;
+        }
+        if(srcs[s]->pool != dest->pool && num_threads > 1)
+        {
+            if(hashtable_logs) hashtable_log(WARN, "hashtable_merge_parallel", "src %u uses a different key pool, merging on a single thread", s);
+            num_threads = 1;
+        }
+        total_size += srcs[s]->size;
+    }
+    if(num_threads == 0) num_threads = 1;
+
+    //keys with a ttl keep it, so dest needs expiry if any src may hold one
+    uint64_t* src_nows = (uint64_t*)calloc(num_srcs ? num_srcs : 1, sizeof(uint64_t));
+    for(uint32_t s = 0; s < num_srcs; s++)
+    {
+        if(srcs[s]->expiry == NULL) continue;
+        src_nows[s] = srcs[s]->expiry->clock();
+        if(dest->expiry == NULL) hashtable_enable_expiry(dest, srcs[s]->expiry->clock);
+    }
+
+    uint32_t new_capacity = dest->capacity;
+    while((double)total_size / new_capacity > MAX_LOAD_FACTOR && new_capacity < 1u << 31) new_capacity <<= 1;
+    if(total_size > new_capacity)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "hashtable_merge_parallel", "merged size %lu would exceed max capacity, aborting", (unsigned long)total_size);
+        free(src_nows);
+        return false;
+    }
+    //also drops tombstones, so any empty slot can be claimed without missing a key further on
+    hashtable_resize(dest, new_capacity);
+
+    merge_job_t job;
+    job.dest = dest;
+    job.srcs = srcs;
+    job.num_srcs = num_srcs;
+    job.combine = combine;
+    job.num_threads = num_threads;
+    job.src_nows = src_nows;
+    job.dest_now = dest->expiry ? dest->expiry->clock() : 0;
+
+    //threads free the keys of conflicts concurrently, which the key caches of the srcs are not made
+    //for, so those keys go straight back to the system meanwhile
+    key_cache_t** src_key_caches = (key_cache_t**)malloc(sizeof(key_cache_t*) * num_srcs);
+    for(uint32_t s = 0; s < num_srcs; s++)
+    {
+        src_key_caches[s] = srcs[s]->key_cache;
+        srcs[s]->key_cache = NULL;
+    }
+
+    merge_worker_t* workers = (merge_worker_t*)malloc(sizeof(merge_worker_t) * num_threads);
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * num_threads);
+    job.lists = (merge_slot_list_t**)malloc(sizeof(merge_slot_list_t*) * num_threads);
+    for(uint32_t t = 0; t < num_threads; t++) job.lists[t] = (merge_slot_list_t*)calloc(num_threads, sizeof(merge_slot_list_t));
+    for(uint32_t t = 0; t < num_threads; t++)
+    {
+        workers[t].job = &job;
+        workers[t].partition = t;
+        workers[t].inserted = 0;
+        workers[t].conflict = false;
+        workers[t].timed = NULL;
+        workers[t].num_timed = 0;
+        workers[t].timed_capacity = 0;
+    }
+
+    //hash every key once and list it under its partition, then merge each partition's lists
+    for(uint32_t t = 0; t < num_threads; t++) pthread_create(&threads[t], NULL, merge_hash_worker_, &workers[t]);
+    for(uint32_t t = 0; t < num_threads; t++) pthread_join(threads[t], NULL);
+    for(uint32_t t = 0; t < num_threads; t++) pthread_create(&threads[t], NULL, merge_partition_worker_, &workers[t]);
+    for(uint32_t t = 0; t < num_threads; t++) pthread_join(threads[t], NULL);
+
+    bool conflict = false;
+    for(uint32_t t = 0; t < num_threads; t++)
+    {
+        dest->size += workers[t].inserted;
+        conflict |= workers[t].conflict;
+        for(uint32_t k = 0; k < workers[t].num_timed; k++)
+        {
+            uint32_t idx = workers[t].timed[k];
+            expiry_schedule_(dest->expiry, key_hash_(dest, dest->data[idx].key), dest->expiry->expires_at[idx]);
+        }
+        free(workers[t].timed);
+        for(uint32_t p = 0; p < num_threads; p++) free(job.lists[t][p].slots);
+        free(job.lists[t]);
+    }
+    for(uint32_t s = 0; s < num_srcs; s++)
+    {
+        srcs[s]->size = 0;
+        srcs[s]->key_cache = src_key_caches[s];
+        if(srcs[s]->expiry) expiry_reset_(srcs[s]->expiry, srcs[s]->capacity);
+    }
+    if(dest->filter) filter_rebuild_(dest);
+    free(job.lists);
+    free(src_nows);
+    free(src_key_caches);
+    free(workers);
+    free(threads);
+
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_merge_parallel", "finished merge of %u hashtables on %u threads - new size = %u, conflicts = %s", num_srcs, num_threads, dest->size, conflict ? "Y" : "N");
+    return conflict;
+}
+
+hashtable_t* hashtable_copy(hashtable_t* hashtable)
+{
+    //same capacity and hash, so every cell can stay in the same slot without probing again
+    hashtable_t* copy = hashtable_init(hashtable->capacity);
+    copy->pool = hashtable->pool;
+    copy->resize_threads = hashtable->resize_threads;
+    copy->size = hashtable->size;
+    for(uint32_t i = 0; i < hashtable->capacity; i++)
+    {
+        cell_t cell = hashtable->data[i];
+        if(cell.key == NULL) continue;
+        copy->data[i].key = copy->pool ? key_pool_retain(cell.key) : copy_key_(copy, cell.key, /*unused*/ 0);
+        HASHTABLE_VALUE_COPY(&copy->data[i].value, cell.value);
+    }
+    if(hashtable->filter)
+    {
+        copy->filter = filter_init_(copy->capacity);
+        memcpy(copy->filter->bits, hashtable->filter->bits, sizeof(uint64_t) * copy->filter->num_blocks * FILTER_WORDS_PER_BLOCK);
+        copy->filter->stale = hashtable->filter->stale;
+    }
+    if(hashtable->hot_cache) copy->hot_cache = hot_cache_init_(hashtable->hot_cache->num_entries);
+    if(hashtable->key_cache) hashtable_enable_key_cache(copy, hashtable->key_cache->max_bytes);
+    if(hashtable->expiry)
+    {
+        copy->expiry = expiry_init_(copy->capacity, hashtable->expiry->clock);
+        copy->expiry->tick = hashtable->expiry->tick;
+        copy->expiry->tombstones = hashtable->expiry->tombstones;
+        memcpy(copy->expiry->expires_at, hashtable->expiry->expires_at, sizeof(uint64_t) * copy->capacity);
+        for(uint32_t i = 0; i < copy->capacity; i++)
+        {
+            uint64_t expires_at = copy->expiry->expires_at[i];
+            if(expires_at == 0 || copy->data[i].key == NULL) continue;
+            expiry_schedule_(copy->expiry, key_hash_(copy, copy->data[i].key), expires_at);
+        }
+    }
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_copy", "copied hashtable of size %u, capacity %u", hashtable->size, hashtable->capacity);
+    return copy;
+}
+
+uint32_t hash(char* key) //shared utility
+{
+    uint32_t val = HASHTABLE_SEED;
+    int c;
+
+    while(c = *key++) val = ((val << 5) + val) + c;
+    return val;
+}
+
+uint32_t mod(uint32_t n, uint32_t d) //shared utility
+{
+    return n & (d - 1);
+}
+
+cell_info_t hashtable_insert_(hashtable_t* hashtable, char* key, value_type value, bool auto_resize, bool move)
+{
+    return insert_hashed_(hashtable, key, hash(key), value, auto_resize, move, /*interned*/ false);
+}
+
+static cell_info_t insert_hashed_(hashtable_t* hashtable, char* key, uint32_t key_hash, value_type value, bool auto_resize, bool move, bool interned)
+{
+    cell_info_t insertion_result;
+    insertion_result.cell = NULL;
+
+    if(hashtable->size == hashtable->capacity)
+    {
+        if(hashtable_logs) hashtable_log(WARN, "hashtable_insert", "insertion of key '%s' failed, size has reached capacity %u", key, hashtable->capacity);
+        insertion_result.status = HASHTABLE_FULL;
+        return insertion_result;
+    }
+
+    uint32_t base_idx = key_hash;
     int probe = 0;
+    int64_t tombstone_idx = -1; //first tombstone of the chain, reused if the key is new
 
     do
     {
-        uint32_t unmod_idx = base_idx + ((probe*(probe+1)) >> 1);
-        uint32_t idx = mod(unmod_idx, hashtable->capacity);
+        uint32_t idx = probe_idx(base_idx, probe, hashtable->capacity);
+        bool cycled = probe && idx == mod(base_idx, hashtable->capacity); //full table cycle case, only reachable with tombstones
+
+        cell_t cell = hashtable->data[idx];
+        if(!cycled && !cell.key && is_tombstone_(hashtable, idx))
+        {
+            if(tombstone_idx < 0) tombstone_idx = idx;
+        }
+        else if(cycled || !cell.key) //empty slot, or end of the chain
+        {
+            if(tombstone_idx >= 0) idx = (uint32_t)tombstone_idx;
+            claim_slot_(hashtable, idx);
+            if(move) //move in key and value
+            {
+                hashtable->data[idx].key = key;
+                hashtable->data[idx].value = value;
+            }
+            else //copy over key and value
+            {
+                hashtable->data[idx].key = copy_key_(hashtable, key, key_hash);
+                HASHTABLE_VALUE_COPY(&hashtable->data[idx].value, value);
+            }
+
+            insertion_result.status = OK;
+            insertion_result.cell = &hashtable->data[idx];
+            hashtable->size++;
+            if(hashtable->filter) filter_add_(hashtable->filter, key_hash);
+            if(hashtable_logs) hashtable_log(INFO, "hashtable_insert", "insertion of key '%s' succeeded", key);
+            break;
+        }
+        else if(interned ? cell.key == key : *key == *cell.key && strcmp(cell.key, key) == 0) //duplicate key
+        {
+            if(is_expired_(hashtable, idx)) //expired, so the key is inserted again in the freed slot
+            {
+                remove_cell_(hashtable, idx);
+                continue;
+            }
+            insertion_result.status = DUPLICATE_KEY;
+            insertion_result.cell = &hashtable->data[idx];
+            if(hashtable_logs) hashtable_log(WARN, "hashtable_insert", "insertion of key '%s' failed, duplicate key found", key);
+            break;
+        }
+        probe++;
+    } while(true); //ok since passed first check
+
+    double load_factor = (double)hashtable->size / hashtable->capacity;
+    if(auto_resize &&
+       load_factor > MAX_LOAD_FACTOR && 
+       insertion_result.status == OK && 
+       hashtable->capacity < 1 << 31)
+    {
+        if(hashtable_logs) hashtable_log(INFO, "hashtable_insert", "insertion of key '%s' triggered resize to %u", key, hashtable->capacity << 1);
+        hashtable_resize(hashtable, hashtable->capacity << 1);
+        insertion_result = lookup_hashed_(hashtable, key, key_hash);
+    }
+    else if(auto_resize &&
+            hashtable->expiry &&
+            (double)(hashtable->size + hashtable->expiry->tombstones) / hashtable->capacity > MAX_LOAD_FACTOR &&
+            insertion_result.status == OK)
+    {
+        //tombstones make probe chains longer, so rehash in place once they take up too many slots
+        hashtable_resize(hashtable, hashtable->capacity);
+        insertion_result = lookup_hashed_(hashtable, key, key_hash);
+    }
+
+    return insertion_result;
+}
+
+cell_info_t hashtable_insert(hashtable_t* hashtable, char* key, value_type value)
+{
+    return hashtable_insert_(hashtable, key, value, /*resize*/ true, /*move*/ false);
+}
+
+static cell_info_t lookup_hashed_(hashtable_t* hashtable, char* key, uint32_t key_hash)
+{
+    cell_info_t lookup_result;
+    lookup_result.cell = NULL;
+
+    uint32_t base_idx = key_hash;
+    int probe = 0;
+
+    if(hashtable->filter && !filter_maybe_contains_(hashtable->filter, base_idx))
+    {
+        lookup_result.status = KEY_NOT_FOUND;
+        if(hashtable_logs) hashtable_log(INFO, "hashtable_lookup", "lookup of key '%s' failed, rejected by filter", key);
+        return lookup_result;
+    }
+
+    do
+    {
+        uint32_t idx = probe_idx(base_idx, probe, hashtable->capacity);
 
         if(probe && idx == mod(base_idx, hashtable->capacity)) //full table cycle case
         {
@@ -307,6 +1150,11 @@ cell_info_t hashtable_lookup(hashtable_t* hashtable, char* key)
         }
 
         cell_t cell = hashtable->data[idx];
+        if(!cell.key && is_tombstone_(hashtable, idx))
+        {
+            probe++;
+            continue;
+        }
         if(!cell.key) //empty slot
         {
             lookup_result.status = KEY_NOT_FOUND;
@@ -315,6 +1163,13 @@ cell_info_t hashtable_lookup(hashtable_t* hashtable, char* key)
         }
         else if(strcmp(cell.key, key) == 0) //key found
         {
+            if(is_expired_(hashtable, idx)) //reclaim expired keys on the spot
+            {
+                remove_cell_(hashtable, idx);
+                lookup_result.status = KEY_NOT_FOUND;
+                if(hashtable_logs) hashtable_log(INFO, "hashtable_lookup", "lookup of key '%s' failed, expired", key);
+                break;
+            }
             lookup_result.status = OK;
             if(hashtable_logs) hashtable_log(INFO, "hashtable_lookup", "lookup of key '%s' succeeded", key);
             lookup_result.cell = &hashtable->data[idx];
@@ -326,21 +1181,691 @@ cell_info_t hashtable_lookup(hashtable_t* hashtable, char* key)
     return lookup_result;
 }
 
-cell_info_t hashtable_delete(hashtable_t* hashtable, char* key)
+cell_info_t hashtable_lookup(hashtable_t* hashtable, char* key)
 {
-    cell_info_t lookup_result = hashtable_lookup(hashtable, key);
+    hot_cache_t* hot_cache = hashtable->hot_cache;
+    if(hot_cache == NULL) return lookup_hashed_(hashtable, key, hash(key));
+
+    uint32_t len;
+    uint32_t key_hash = hash_len_(key, &len);
+    hot_entry_t* entry = hot_entry_(hot_cache, key_hash);
+    if(entry->hash == key_hash && entry->len == len && entry->idx < hashtable->capacity)
+    {
+        //the entry may be stale (ex a key merged away), so it only counts if the slot agrees
+        cell_t* cell = &hashtable->data[entry->idx];
+        if(cell->key && strcmp(cell->key, key) == 0 && !is_expired_(hashtable, entry->idx))
+        {
+            hot_cache->hits++;
+            if(hashtable_logs) hashtable_log(INFO, "hashtable_lookup", "lookup of key '%s' succeeded, hot cache hit", key);
+            cell_info_t lookup_result = {cell, OK};
+            return lookup_result;
+        }
+    }
+
+    hot_cache->misses++;
+    cell_info_t lookup_result = lookup_hashed_(hashtable, key, key_hash);
+    if(lookup_result.status == OK)
+    {
+        entry->hash = key_hash;
+        entry->len = len;
+        entry->idx = (uint32_t)(lookup_result.cell - hashtable->data);
+    }
+    return lookup_result;
+}
+
+static cell_info_t delete_hashed_(hashtable_t* hashtable, char* key, uint32_t key_hash)
+{
+    cell_info_t lookup_result = lookup_hashed_(hashtable, key, key_hash);
     if(lookup_result.status == KEY_NOT_FOUND)
     {
         if(hashtable_logs) hashtable_log(WARN, "hashtable_delete", "deletion of key '%s' failed, not found", key);
         return lookup_result;
     }
 
-    free(lookup_result.cell->key);
-    lookup_result.cell->key = NULL;
-    //<customize> properly delete resources while deleting cell value
-    hashtable->size--;
-
+    remove_cell_(hashtable, (uint32_t)(lookup_result.cell - hashtable->data));
     lookup_result.cell = NULL;
     if(hashtable_logs) hashtable_log(INFO, "hashtable_delete", "deletion of key '%s' succeeded", key);
     return lookup_result;
-}
\ No newline at end of file
+}
+
+cell_info_t hashtable_delete(hashtable_t* hashtable, char* key)
+{
+    return delete_hashed_(hashtable, key, hash(key));
+}
+
+hashed_key_t hashtable_hash(char* key)
+{
+    hashed_key_t hashed;
+    hashed.key = key;
+    hashed.hash = hash(key);
+    hashed.seed = HASHTABLE_SEED;
+    return hashed;
+}
+
+void hashtable_hash_batch(char** keys, uint32_t num_keys, hashed_key_t* out)
+{
+    uint32_t hashes[64];
+    for(uint32_t begin = 0; begin < num_keys; begin += 64)
+    {
+        uint32_t count = num_keys - begin < 64 ? num_keys - begin : 64;
+        hash_batch(keys + begin, count, hashes);
+        for(uint32_t i = 0; i < count; i++)
+        {
+            out[begin + i].key = keys[begin + i];
+            out[begin + i].hash = hashes[i];
+            out[begin + i].seed = HASHTABLE_SEED;
+        }
+    }
+}
+
+static bool check_hashed_(hashed_key_t hashed, const char* location) //local utility
+{
+    if(hashed.seed == HASHTABLE_SEED && hashed.key) return true;
+    if(hashtable_logs) hashtable_log(ERROR, location, "hashed key was not made by hashtable_hash (seed %u), rejecting", hashed.seed);
+    return false;
+}
+
+cell_info_t hashtable_insert_hashed(hashtable_t* hashtable, hashed_key_t hashed, value_type value)
+{
+    if(!check_hashed_(hashed, "hashtable_insert_hashed"))
+    {
+        cell_info_t insertion_result = {NULL, HASH_MISMATCH};
+        return insertion_result;
+    }
+    return insert_hashed_(hashtable, hashed.key, hashed.hash, value, /*resize*/ true, /*move*/ false, /*interned*/ false);
+}
+
+cell_info_t hashtable_lookup_hashed(hashtable_t* hashtable, hashed_key_t hashed)
+{
+    if(!check_hashed_(hashed, "hashtable_lookup_hashed"))
+    {
+        cell_info_t lookup_result = {NULL, HASH_MISMATCH};
+        return lookup_result;
+    }
+    return lookup_hashed_(hashtable, hashed.key, hashed.hash);
+}
+
+cell_info_t hashtable_delete_hashed(hashtable_t* hashtable, hashed_key_t hashed)
+{
+    if(!check_hashed_(hashed, "hashtable_delete_hashed"))
+    {
+        cell_info_t deletion_result = {NULL, HASH_MISMATCH};
+        return deletion_result;
+    }
+    return delete_hashed_(hashtable, hashed.key, hashed.hash);
+}
+
+cell_info_t hashtable_increment(hashtable_t* hashtable, char* key, value_type delta)
+{
+    cell_info_t increment_result;
+    increment_result.cell = NULL;
+
+    uint32_t base_idx = hash(key);
+    int probe = 0;
+    int64_t tombstone_idx = -1; //first tombstone of the chain, reused if the key is new
+
+    do
+    {
+        uint32_t idx = probe_idx(base_idx, probe, hashtable->capacity);
+        bool cycled = probe && idx == mod(base_idx, hashtable->capacity); //full table cycle case
+
+        cell_t* cell = &hashtable->data[idx];
+        if(!cycled && !cell->key && is_tombstone_(hashtable, idx))
+        {
+            if(tombstone_idx < 0) tombstone_idx = idx;
+            probe++;
+            continue;
+        }
+        if((cycled || !cell->key) && tombstone_idx >= 0)
+        {
+            idx = (uint32_t)tombstone_idx;
+            cell = &hashtable->data[idx];
+            cycled = false;
+        }
+
+        if(cycled)
+        {
+            increment_result.status = HASHTABLE_FULL;
+            if(hashtable_logs) hashtable_log(WARN, "hashtable_increment", "increment of key '%s' failed, size has reached capacity %u", key, hashtable->capacity);
+            return increment_result;
+        }
+
+        if(!cell->key) //empty slot, insert the key as if it started at zero
+        {
+            claim_slot_(hashtable, idx);
+            cell->key = copy_key_(hashtable, key, base_idx);
+            cell->value = delta;
+            hashtable->size++;
+            if(hashtable->filter) filter_add_(hashtable->filter, base_idx);
+            increment_result.status = OK;
+            increment_result.cell = cell;
+            if(hashtable_logs) hashtable_log(INFO, "hashtable_increment", "inserted key '%s' while incrementing", key);
+            break;
+        }
+        else if(*key == *cell->key && strcmp(cell->key, key) == 0) //existing key
+        {
+            if(is_expired_(hashtable, idx)) //expired, so count again from zero in the freed slot
+            {
+                remove_cell_(hashtable, idx);
+                continue;
+            }
+            cell->value += delta;
+            increment_result.status = OK;
+            increment_result.cell = cell;
+            return increment_result;
+        }
+        probe++;
+    } while(true);
+
+    double load_factor = (double)hashtable->size / hashtable->capacity;
+    if(load_factor > MAX_LOAD_FACTOR && hashtable->capacity < 1u << 31)
+    {
+        if(hashtable_logs) hashtable_log(INFO, "hashtable_increment", "increment of key '%s' triggered resize to %u", key, hashtable->capacity << 1);
+        hashtable_resize(hashtable, hashtable->capacity << 1);
+        increment_result = hashtable_lookup(hashtable, key);
+    }
+    else if(hashtable->expiry && (double)(hashtable->size + hashtable->expiry->tombstones) / hashtable->capacity > MAX_LOAD_FACTOR)
+    {
+        hashtable_resize(hashtable, hashtable->capacity);
+        increment_result = hashtable_lookup(hashtable, key);
+    }
+
+    return increment_result;
+}
+
+STATUS hashtable_increment_concurrent(hashtable_t* hashtable, char* key, value_type delta)
+{
+    if(hashtable->lock == NULL)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "hashtable_increment_concurrent", "hashtable was not created with hashtable_init_counter, aborting");
+        assert(false);
+        return KEY_NOT_FOUND;
+    }
+
+    //fast path, existing keys only need the shared lock since they never move while it is held
+    pthread_rwlock_rdlock(hashtable->lock);
+    uint32_t base_idx = hash(key);
+    int probe = 0;
+
+    do
+    {
+        uint32_t idx = probe_idx(base_idx, probe, hashtable->capacity);
+        if(probe && idx == mod(base_idx, hashtable->capacity)) break; //full table cycle case
+
+        cell_t* cell = &hashtable->data[idx];
+        if(!cell->key) break; //empty slot, key is new
+        if(*key == *cell->key && strcmp(cell->key, key) == 0)
+        {
+            if(is_expired_(hashtable, idx)) break; //reclaiming needs the exclusive lock
+            __atomic_fetch_add(&cell->value, delta, __ATOMIC_RELAXED);
+            pthread_rwlock_unlock(hashtable->lock);
+            return OK;
+        }
+        probe++;
+    } while(true);
+    pthread_rwlock_unlock(hashtable->lock);
+
+    //slow path, another thread may have inserted the key in between so increment handles both cases
+    pthread_rwlock_wrlock(hashtable->lock);
+    STATUS status = hashtable_increment(hashtable, key, delta).status;
+    pthread_rwlock_unlock(hashtable->lock);
+    return status;
+}
+
+static void sift_down_(cell_t** heap, uint32_t count, uint32_t i) //local utility, min heap on value
+{
+    while(true)
+    {
+        uint32_t smallest = i;
+        uint32_t left = 2*i + 1;
+        uint32_t right = 2*i + 2;
+        if(left < count && heap[left]->value < heap[smallest]->value) smallest = left;
+        if(right < count && heap[right]->value < heap[smallest]->value) smallest = right;
+        if(smallest == i) return;
+
+        cell_t* tmp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+uint32_t hashtable_top_k(hashtable_t* hashtable, uint32_t k, cell_t** out)
+{
+    //keep the k largest cells seen so far in a min heap built in out itself
+    uint32_t count = 0;
+    for(uint32_t i = 0; i < hashtable->capacity && k > 0; i++)
+    {
+        cell_t* cell = &hashtable->data[i];
+        if(cell->key == NULL) continue;
+
+        if(count < k)
+        {
+            out[count++] = cell;
+            if(count == k) for(uint32_t j = k/2; j-- > 0;) sift_down_(out, count, j);
+        }
+        else if(cell->value > out[0]->value)
+        {
+            out[0] = cell;
+            sift_down_(out, count, 0);
+        }
+    }
+    if(count < k) for(uint32_t j = count/2; j-- > 0;) sift_down_(out, count, j);
+
+    //pop the heap from the back, which leaves out sorted largest first
+    for(uint32_t end = count; end > 1; end--)
+    {
+        cell_t* tmp = out[0];
+        out[0] = out[end - 1];
+        out[end - 1] = tmp;
+        sift_down_(out, end - 1, 0);
+    }
+
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_top_k", "found top %u of %u elements", count, hashtable->size);
+    return count;
+}
+
+hashtable_cursor_t hashtable_cursor(hashtable_t* hashtable)
+{
+    hashtable_cursor_t cursor;
+    cursor.next = 0;
+    cursor.generation = hashtable->generation;
+    cursor.restarts = 0;
+    return cursor;
+}
+
+cell_t* hashtable_next(hashtable_t* hashtable, hashtable_cursor_t* cursor)
+{
+    //keys only move on resize, and then to unrelated slots, so only starting over can't miss any
+    if(cursor->generation != hashtable->generation)
+    {
+        if(hashtable_logs) hashtable_log(WARN, "hashtable_next", "hashtable resized during the walk, starting over");
+        cursor->next = 0;
+        cursor->generation = hashtable->generation;
+        cursor->restarts++;
+    }
+    while(cursor->next < hashtable->capacity)
+    {
+        uint32_t idx = cursor->next++;
+        if(hashtable->data[idx].key && !is_expired_(hashtable, idx)) return &hashtable->data[idx];
+    }
+    return NULL;
+}
+
+uint32_t hashtable_for_each_range(hashtable_t* hashtable, uint32_t begin, uint32_t end, hashtable_visit_fn visit, void* ctx)
+{
+    if(end > hashtable->capacity) end = hashtable->capacity;
+    uint32_t visited = 0;
+    for(uint32_t i = begin; i < end; i++)
+    {
+        //slots are read in order, which the hardware prefetches, but keys are scattered on the heap
+        if(i + HASHTABLE_SCAN_PREFETCH < end)
+        {
+            char* upcoming = hashtable->data[i + HASHTABLE_SCAN_PREFETCH].key;
+            if(upcoming) __builtin_prefetch(upcoming);
+        }
+        if(hashtable->data[i].key == NULL || is_expired_(hashtable, i)) continue;
+        visit(&hashtable->data[i], ctx);
+        visited++;
+    }
+    return visited;
+}
+
+//range of slots scanned by one thread of hashtable_for_each_parallel
+typedef struct
+{
+    hashtable_t* hashtable;
+    uint32_t begin;
+    uint32_t end;
+    hashtable_visit_fn visit;
+    void* ctx;
+    uint32_t visited;
+} range_worker_t;
+
+static void* range_worker_(void* arg) //local utility, scans one range of a parallel scan
+{
+    range_worker_t* worker = (range_worker_t*)arg;
+    worker->visited = hashtable_for_each_range(worker->hashtable, worker->begin, worker->end, worker->visit, worker->ctx);
+    return NULL;
+}
+
+uint32_t hashtable_for_each_parallel(hashtable_t* hashtable, hashtable_visit_fn visit, void** ctxs, uint32_t num_threads)
+{
+    if(num_threads == 0) num_threads = 1;
+    if(num_threads > hashtable->capacity) num_threads = hashtable->capacity;
+
+    range_worker_t* workers = (range_worker_t*)malloc(sizeof(range_worker_t) * num_threads);
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * num_threads);
+    for(uint32_t t = 0; t < num_threads; t++)
+    {
+        workers[t].hashtable = hashtable;
+        workers[t].begin = (uint32_t)(((uint64_t)hashtable->capacity * t) / num_threads);
+        workers[t].end = (uint32_t)(((uint64_t)hashtable->capacity * (t + 1)) / num_threads);
+        workers[t].visit = visit;
+        workers[t].ctx = ctxs ? ctxs[t] : NULL;
+        workers[t].visited = 0;
+    }
+    //the calling thread scans the first range itself
+    for(uint32_t t = 1; t < num_threads; t++) pthread_create(&threads[t], NULL, range_worker_, &workers[t]);
+    range_worker_(&workers[0]);
+    uint32_t visited = workers[0].visited;
+    for(uint32_t t = 1; t < num_threads; t++)
+    {
+        pthread_join(threads[t], NULL);
+        visited += workers[t].visited;
+    }
+    free(workers);
+    free(threads);
+
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_for_each_parallel", "visited %u cells on %u threads", visited, num_threads);
+    return visited;
+}
+
+void hashtable_enable_filter(hashtable_t* hashtable)
+{
+    filter_rebuild_(hashtable);
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_enable_filter", "enabled filter of %u bytes", (uint32_t)hashtable_filter_bytes(hashtable));
+}
+
+void hashtable_disable_filter(hashtable_t* hashtable)
+{
+    if(hashtable->filter == NULL) return;
+    filter_cleanup_(hashtable->filter);
+    hashtable->filter = NULL;
+}
+
+bool hashtable_filter_contains(hashtable_t* hashtable, char* key)
+{
+    return hashtable->filter == NULL || filter_maybe_contains_(hashtable->filter, hash(key));
+}
+
+size_t hashtable_filter_bytes(hashtable_t* hashtable)
+{
+    if(hashtable->filter == NULL) return 0;
+    return sizeof(key_filter_t) + sizeof(uint64_t) * (size_t)hashtable->filter->num_blocks * FILTER_WORDS_PER_BLOCK;
+}
+
+void hashtable_enable_hot_cache(hashtable_t* hashtable, uint32_t num_entries)
+{
+    uint32_t rounded = 1;
+    while(rounded < num_entries && rounded < 1u << 31) rounded <<= 1;
+    if(hashtable->hot_cache) hot_cache_cleanup_(hashtable->hot_cache);
+    hashtable->hot_cache = hot_cache_init_(rounded);
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_enable_hot_cache", "enabled hot cache of %u entries", rounded);
+}
+
+void hashtable_enable_key_cache(hashtable_t* hashtable, size_t max_bytes)
+{
+    hashtable_disable_key_cache(hashtable);
+    hashtable->key_cache = (key_cache_t*)calloc(1, sizeof(key_cache_t));
+    hashtable->key_cache->max_bytes = max_bytes;
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_enable_key_cache", "enabled key cache of up to %zu bytes", max_bytes);
+}
+
+void hashtable_disable_key_cache(hashtable_t* hashtable)
+{
+    if(hashtable->key_cache == NULL) return;
+    key_cache_release_(hashtable->key_cache);
+    free(hashtable->key_cache);
+    hashtable->key_cache = NULL;
+}
+
+size_t hashtable_trim(hashtable_t* hashtable)
+{
+    size_t released = hashtable->key_cache ? key_cache_release_(hashtable->key_cache) : 0;
+    malloc_trim(0);
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_trim", "released %zu bytes of key buffers", released);
+    return released;
+}
+
+void hashtable_disable_hot_cache(hashtable_t* hashtable)
+{
+    if(hashtable->hot_cache == NULL) return;
+    hot_cache_cleanup_(hashtable->hot_cache);
+    hashtable->hot_cache = NULL;
+}
+
+void hashtable_enable_expiry(hashtable_t* hashtable, hashtable_clock_fn clock)
+{
+    if(hashtable->expiry)
+    {
+        hashtable->expiry->clock = clock ? clock : monotonic_ms_;
+        return;
+    }
+    hashtable->expiry = expiry_init_(hashtable->capacity, clock);
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_enable_expiry", "enabled expiry");
+}
+
+void hashtable_disable_expiry(hashtable_t* hashtable)
+{
+    if(hashtable->expiry == NULL) return;
+    //without their tombstones, emptied slots would cut the probe chains going through them
+    if(hashtable->expiry->tombstones) hashtable_resize(hashtable, hashtable->capacity);
+    expiry_cleanup_(hashtable->expiry);
+    hashtable->expiry = NULL;
+}
+
+cell_info_t hashtable_insert_ttl(hashtable_t* hashtable, char* key, value_type value, uint64_t ttl_ms)
+{
+    if(hashtable->expiry == NULL) hashtable_enable_expiry(hashtable, NULL);
+    cell_info_t insertion_result = hashtable_insert(hashtable, key, value);
+    if(insertion_result.status == OK) set_deadline_(hashtable, insertion_result.cell, ttl_ms);
+    return insertion_result;
+}
+
+STATUS hashtable_set_ttl(hashtable_t* hashtable, char* key, uint64_t ttl_ms)
+{
+    if(hashtable->expiry == NULL) hashtable_enable_expiry(hashtable, NULL);
+    cell_info_t lookup_result = hashtable_lookup(hashtable, key);
+    if(lookup_result.status == OK) set_deadline_(hashtable, lookup_result.cell, ttl_ms);
+    return lookup_result.status;
+}
+
+//a deadline only says some key of the chain of its hash may be due, so the whole chain is checked
+static uint32_t reclaim_chain_(hashtable_t* hashtable, uint32_t key_hash, uint64_t now) //local utility
+{
+    uint32_t num_expired = 0;
+    int probe = 0;
+    do
+    {
+        uint32_t idx = probe_idx(key_hash, probe, hashtable->capacity);
+        if(probe && idx == mod(key_hash, hashtable->capacity)) break; //full table cycle case
+        if(hashtable->data[idx].key == NULL)
+        {
+            if(!is_tombstone_(hashtable, idx)) break;
+            probe++;
+            continue;
+        }
+
+        uint64_t expires_at = hashtable->expiry->expires_at[idx];
+        if(expires_at && expires_at <= now)
+        {
+            if(hashtable_logs) hashtable_log(INFO, "hashtable_expire_step", "key '%s' expired", hashtable->data[idx].key);
+            remove_cell_(hashtable, idx);
+            num_expired++;
+        }
+        probe++;
+    } while(true);
+    return num_expired;
+}
+
+static uint64_t next_tick_(hashtable_expiry_t* expiry, uint64_t now_tick) //local utility
+{
+    //while a level (and every level below it) is empty nothing can be due before the next slot of
+    //the level above starts, so whole runs of empty ticks are skipped at once
+    uint64_t next = expiry->tick + 1;
+    for(uint32_t level = 0; level < EXPIRY_WHEEL_LEVELS && expiry->level_size[level] == 0; level++)
+    {
+        if(level + 1 == EXPIRY_WHEEL_LEVELS) return now_tick; //nothing scheduled at all
+        uint64_t span = 1ull << (EXPIRY_SLOT_BITS * (level + 1));
+        next = (expiry->tick | (span - 1)) + 1;
+    }
+    return next < now_tick ? next : now_tick;
+}
+
+uint32_t hashtable_expire_step(hashtable_t* hashtable, uint32_t budget)
+{
+    hashtable_expiry_t* expiry = hashtable->expiry;
+    if(expiry == NULL) return 0;
+
+    uint64_t now = expiry->clock();
+    uint64_t now_tick = now / EXPIRY_TICK_MS;
+    uint32_t num_expired = 0;
+
+    //only ticks that are over get swept, so every deadline of a swept slot is due
+    for(; budget > 0 && expiry->tick < now_tick; budget--)
+    {
+        uint64_t tick = expiry->tick;
+        if(!expiry->cascaded)
+        {
+            //a tick starting a slot of a coarser level detaches that slot, its entries are then
+            //rescheduled into the finer levels one unit of work at a time
+            for(uint32_t level = 1; level < EXPIRY_WHEEL_LEVELS; level++)
+            {
+                if(tick & ((1ull << (EXPIRY_SLOT_BITS * level)) - 1)) break;
+                expiry_bucket_t* bucket = &expiry->wheel[level][(tick >> (EXPIRY_SLOT_BITS * level)) & (EXPIRY_WHEEL_SLOTS - 1)];
+                if(bucket->size == 0) continue;
+                bucket_reserve_(&expiry->pending, expiry->pending.size + bucket->size);
+                memcpy(expiry->pending.entries + expiry->pending.size, bucket->entries, sizeof(expiry_entry_t) * bucket->size);
+                expiry->pending.size += bucket->size;
+                expiry->level_size[level] -= bucket->size;
+                bucket->size = 0;
+            }
+            expiry->cascaded = true;
+        }
+
+        expiry_bucket_t* due = &expiry->wheel[0][tick & (EXPIRY_WHEEL_SLOTS - 1)];
+        if(expiry->pending.size)
+        {
+            expiry_entry_t entry = expiry->pending.entries[--expiry->pending.size];
+            expiry_schedule_(expiry, entry.hash, entry.expires_at);
+        }
+        else if(due->size)
+        {
+            expiry_entry_t entry = due->entries[--due->size];
+            expiry->level_size[0]--;
+            num_expired += reclaim_chain_(hashtable, entry.hash, now);
+        }
+        else
+        {
+            expiry->tick = next_tick_(expiry, now_tick);
+            expiry->cascaded = false;
+        }
+    }
+
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_expire_step", "reclaimed %u expired keys", num_expired);
+    return num_expired;
+}
+
+key_pool_t* key_pool_init(uint32_t capacity)
+{
+    bool capacity_is_not_power_of_2 = capacity & (capacity - 1);
+    if(capacity == 0 || capacity_is_not_power_of_2)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "key_pool_init", "capacity %u must be nonzero and a power of two, aborting", capacity);
+        return NULL;
+    }
+
+    key_pool_t* pool = (key_pool_t*)malloc(sizeof(key_pool_t));
+    pool->capacity = capacity;
+    pool->size = 0;
+    pool->data = (pooled_key_t**)calloc(capacity, sizeof(pooled_key_t*));
+
+    if(hashtable_logs) hashtable_log(INFO, "key_pool_init", "created key pool of capacity %u", capacity);
+    return pool;
+}
+
+void key_pool_cleanup(key_pool_t* pool)
+{
+    if(hashtable_logs) hashtable_log(INFO, "key_pool_cleanup", "destroying key pool with %u interned keys", pool->size);
+    for(uint32_t i = 0; i < pool->capacity; i++) free(pool->data[i]);
+    free(pool->data);
+    free(pool);
+}
+
+//the pool probes linearly, which lets release shift entries back instead of leaving holes in
+//probe chains. entries remember their hash, so neither growing nor shifting rehashes strings.
+static void key_pool_grow_(key_pool_t* pool) //local utility
+{
+    uint32_t new_capacity = pool->capacity << 1;
+    pooled_key_t** new_data = (pooled_key_t**)calloc(new_capacity, sizeof(pooled_key_t*));
+    for(uint32_t i = 0; i < pool->capacity; i++)
+    {
+        pooled_key_t* entry = pool->data[i];
+        if(entry == NULL) continue;
+        uint32_t idx = mod(entry->hash, new_capacity);
+        while(new_data[idx]) idx = mod(idx + 1, new_capacity);
+        new_data[idx] = entry;
+    }
+    free(pool->data);
+    pool->data = new_data;
+    pool->capacity = new_capacity;
+    if(hashtable_logs) hashtable_log(INFO, "key_pool_grow", "grew key pool to capacity %u", new_capacity);
+}
+
+static char* intern_hashed_(key_pool_t* pool, char* key, uint32_t key_hash)
+{
+    uint32_t idx = mod(key_hash, pool->capacity);
+    while(pool->data[idx])
+    {
+        pooled_key_t* entry = pool->data[idx];
+        char* interned = (char*)(entry + 1);
+        if(entry->hash == key_hash && strcmp(interned, key) == 0)
+        {
+            entry->refcount++;
+            return interned;
+        }
+        idx = mod(idx + 1, pool->capacity);
+    }
+
+    size_t key_len = strlen(key);
+    pooled_key_t* entry = (pooled_key_t*)malloc(sizeof(pooled_key_t) + (sizeof(char)*key_len) + 1);
+    entry->refcount = 1;
+    entry->hash = key_hash;
+    char* interned = (char*)(entry + 1);
+    strcpy(interned, key);
+
+    pool->data[idx] = entry;
+    pool->size++;
+    if((double)pool->size / pool->capacity > MAX_LOAD_FACTOR) key_pool_grow_(pool);
+    return interned;
+}
+
+char* key_pool_intern(key_pool_t* pool, char* key)
+{
+    return intern_hashed_(pool, key, hash(key));
+}
+
+char* key_pool_retain(char* interned_key)
+{
+    ((pooled_key_t*)interned_key - 1)->refcount++;
+    return interned_key;
+}
+
+void key_pool_release(key_pool_t* pool, char* interned_key)
+{
+    pooled_key_t* entry = (pooled_key_t*)interned_key - 1;
+    if(--entry->refcount > 0) return;
+
+    uint32_t idx = mod(entry->hash, pool->capacity);
+    while(pool->data[idx] != entry) idx = mod(idx + 1, pool->capacity);
+
+    //backward shift deletion, pull later entries of the cluster into the hole if their home allows it
+    uint32_t hole = idx;
+    uint32_t next = mod(hole + 1, pool->capacity);
+    while(pool->data[next])
+    {
+        uint32_t home = mod(pool->data[next]->hash, pool->capacity);
+        bool can_move = mod(next - home, pool->capacity) >= mod(next - hole, pool->capacity);
+        if(can_move)
+        {
+            pool->data[hole] = pool->data[next];
+            hole = next;
+        }
+        next = mod(next + 1, pool->capacity);
+    }
+    pool->data[hole] = NULL;
+
+    pool->size--;
+    free(entry);
+}
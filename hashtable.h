@@ -1,23 +1,75 @@
 /*
 Author: Dante Crescenzi
-Last Modif: 28 Mar 2024
+Last Modif: 19 Oct 2026
 Description: string -> any hashtable interface
 
 This header describes the interface to create, interact with and cleanup a string -> any
 hashtable. The user can specify whatever value type needed in the hashmap via the typedef
 below, simply use it to typedef the desired type to 'value_type'.
 
-NOTE: the stock hashmap was developed without memory management of value in mind. However, if
-it is needed (ex if value_type is char*), ctrl+f for "<customize>" in hashtable.c and add in 
-whatever resource management is needed. Keys are memory managed automatically - please leave
-all memory mamangement of keys (and eventually values, once customized) to the provided
-functions.
+Values that own resources (ex if value_type is char*) are managed through two operations resolved
+at compile time, HASHTABLE_VALUE_COPY and HASHTABLE_VALUE_DESTROY below, which do nothing special by
+default.  Define them before this header is first included (ex with -D, so every file agrees) and
+hashtable_t copies values only where they are duplicated (insert without move, copy, merge) and
+destroys them only where they are dropped (delete, clear, cleanup, expiry, merge conflicts).
+Values are otherwise moved bit for bit, including by resize and squash, so value_type must be
+relocatable with a memcpy.  Keys are memory managed automatically - please leave all memory
+management of keys and values to the provided functions.
+NOTE: cow_hashtable_t, buffer_hashtable_t, durable_hashtable_t, frozen_hashtable_t and
+shm_hashtable_t copy values bit for bit, so value_type must not own resources to be used with them.
 
 The user can specify the max load factor to reach before automatic resizing (default 0.75),
 and whether or not logs should be printed.  If logs are off performance is not affected,
 as with a high enough -O level the compiler will optimize all log calls and checks away
 if logs are off.
 
+Tables can optionally share a key_pool_t, which interns keys and refcounts them.  Pooled tables
+store a reference to the interned key instead of their own copy, so copy/merge between tables on
+the same pool never reallocate keys, and keys from the same pool are compared by pointer.
+
+Counter hashtables (hashtable_init_counter) are made for counting key occurrences.  They can be
+incremented from several threads at once with hashtable_increment_concurrent, which only takes an
+exclusive lock when a new key has to be inserted.  Counting requires an integral value_type.
+
+Tables that mostly see lookups of missing keys can enable a key filter (hashtable_enable_filter),
+a bloom filter of about one byte per slot that is kept up to date by insert, delete and resize.
+
+Tables with a few very popular keys can enable a hot cache (hashtable_enable_hot_cache), a small
+direct mapped array remembering where recently found keys live, tagged by hash and length.  A
+hashtable_lookup of a cached key goes straight to its slot instead of walking the probe sequence.
+Deletes drop the key's entry and resizes empty the cache, and every hit is checked against the
+slot's key, so a stale entry only ever costs a miss.
+
+Tables that churn through keys (deletes followed by inserts of similar keys) can enable a key cache
+(hashtable_enable_key_cache), free lists of key buffers in size classes of 16 to 256 bytes.  Keys
+freed by delete, clear or expiry are kept in them, up to a retention limit, and reused by the next
+inserts of a key that fits instead of going through malloc and free.  hashtable_trim gives the kept
+buffers, and whatever the allocator can spare, back to the system.
+
+Keys can be given a time to live (hashtable_insert_ttl, hashtable_set_ttl) once expiry is enabled.
+Expired keys are misses from then on and are reclaimed by the first lookup, insert or increment
+that runs into them, and hashtable_expire_step reclaims the rest a bounded amount of work at a time.
+Keys removed from an expiring hashtable (expired or deleted) leave a tombstone, so removing them
+never cuts off the keys further down their probe chains.
+
+Resizing very large tables can be spread over several threads (hashtable_set_resize_threads): the
+old slots are split in one chunk per thread, and every thread moves the keys of its chunk to the
+new slots, claiming each empty slot with a CAS.  Explicit resizes, squashes and automatic resizes
+all go through it once a hashtable holds at least PARALLEL_RESIZE_MIN_KEYS keys.
+
+Hashtables can be walked with a cursor (hashtable_cursor, hashtable_next) that stays valid across
+inserts and deletes, as keys never move between resizes: every key present for the whole walk is
+visited exactly once.  A resize does move them, so a cursor that notices one starts over, and keys
+are then visited at least once.  For scans over every core, hashtable_for_each_range visits one
+range of slots, and ranges are independent of each other, so hashtable_for_each_parallel simply
+splits the slots in one range per thread.  Range scans prefetch the keys of upcoming slots, which
+otherwise cost a cache miss each.
+
+Every hashtable hashes keys with the same function and seed, so a key can be hashed once
+(hashtable_hash, or hashtable_hash_batch for many keys) and the result reused to probe any number
+of tables with the _hashed variants of insert/lookup/delete.  A hashed key carries its key and the
+seed it was hashed with, and is rejected with HASH_MISMATCH if it was not made by hashtable_hash.
+
 The unit tests only work with int value_type but can be converted to use any.  To run them,
 run 'make test' or just 'make'.
 */
@@ -32,13 +84,31 @@ run 'make test' or just 'make'.
 #include <stdbool.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
 
 typedef /*value type here ->*/ int /*<-*/ value_type;
 
+//operations on values that own resources, see above. dest points at a slot without a value.
+#ifndef HASHTABLE_VALUE_COPY
+#define HASHTABLE_VALUE_COPY(dest, src) (*(dest) = (src))
+#endif
+#ifndef HASHTABLE_VALUE_DESTROY
+#define HASHTABLE_VALUE_DESTROY(value) ((void)(value))
+#endif
+
 //specify max load factor, and logging
 #define MAX_LOAD_FACTOR 0.75
 #define hashtable_logs false
 
+//seed of the hash shared by every hashtable, recorded in each hashed_key_t
+#define HASHTABLE_SEED 5381
+
+//keys a hashtable must hold before its resizes are spread over its resize threads
+#define PARALLEL_RESIZE_MIN_KEYS (1 << 14)
+
+//slots ahead of the current one whose key is prefetched by range scans
+#define HASHTABLE_SCAN_PREFETCH 8
+
 //struct to represent a cell of the hashtable.
 typedef struct
 {
@@ -46,12 +116,114 @@ typedef struct
     value_type value;
 } cell_t;
 
+//header of an interned key, the key string itself is stored directly after it.
+typedef struct
+{
+    uint32_t refcount;
+    uint32_t hash;
+} pooled_key_t;
+
+//struct to represent a pool of interned, refcounted keys that can be shared between hashtables.
+//NOTE: not thread safe, and must outlive every hashtable using it.
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t size;
+    pooled_key_t** data;
+} key_pool_t;
+
+//struct to represent a blocked bloom filter over the keys of a hashtable. every key sets its bits
+//within a single 64 byte block, so most lookups of missing keys are answered from one cache line.
+typedef struct
+{
+    uint32_t num_blocks;
+    uint32_t stale; //deleted keys whose bits are still set, rebuilt away once they outnumber keys
+    uint64_t* bits;
+} key_filter_t;
+
+//entry of a hot cache, the slot a key with this hash and length was last found in.
+typedef struct
+{
+    uint32_t hash;
+    uint32_t len;
+    uint32_t idx;
+} hot_entry_t;
+
+//struct to represent a direct mapped cache of recently found slots, see hashtable_enable_hot_cache.
+typedef struct
+{
+    uint32_t num_entries;
+    uint64_t hits;
+    uint64_t misses;
+    hot_entry_t* entries;
+} hot_cache_t;
+
+#define KEY_CACHE_CLASSES 5 //size classes of 16, 32, 64, 128 and 256 bytes
+
+//struct to represent the free lists of key buffers of a hashtable, see hashtable_enable_key_cache.
+//buffers are linked through their first bytes.
+typedef struct
+{
+    size_t bytes; //bytes of the buffers held
+    size_t max_bytes; //retention limit, buffers freed past it go back to the system
+    uint64_t reused;
+    uint64_t allocated;
+    char* free_lists[KEY_CACHE_CLASSES];
+} key_cache_t;
+
+//clock used by expiring hashtables, returns the current time in milliseconds.
+typedef uint64_t (*hashtable_clock_fn)(void);
+
+#define EXPIRY_WHEEL_LEVELS 4
+#define EXPIRY_WHEEL_SLOTS 64
+#define EXPIRY_TOMBSTONE UINT64_MAX //deadline of the emptied slots that probes skip over
+
+//deadline of a key in the expiry timing wheel. keys are referred to by hash, so entries survive
+//resizes, and entries whose key was deleted or given a new ttl in the meantime are just skipped.
+typedef struct
+{
+    uint64_t expires_at;
+    uint32_t hash;
+} expiry_entry_t;
+
+//growable list of the deadlines that fall in one slot of the timing wheel.
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t size;
+    expiry_entry_t* entries;
+} expiry_bucket_t;
+
+//struct to represent the expiry of a hashtable: a deadline per slot, plus a hierarchical timing
+//wheel of those deadlines so due keys can be found without scanning the hashtable. every level
+//has slots 64 times as wide as the level below, and a slot is cascaded into the levels below
+//once the sweep reaches it.
+typedef struct
+{
+    uint64_t* expires_at; //per slot of the hashtable, 0 if the key never expires (or no key)
+    uint32_t tombstones; //emptied slots that probes skip over, dropped by the next rehash
+    hashtable_clock_fn clock;
+    uint64_t tick; //next tick of the wheel to sweep
+    bool cascaded; //whether tick's coarser slots were already moved to pending
+    uint32_t level_size[EXPIRY_WHEEL_LEVELS];
+    expiry_bucket_t pending; //entries of cascaded slots, waiting to be rescheduled
+    expiry_bucket_t wheel[EXPIRY_WHEEL_LEVELS][EXPIRY_WHEEL_SLOTS];
+} hashtable_expiry_t;
+
 //struct to represent a hashtable.
 typedef struct
 {
     uint32_t capacity;
     uint32_t size;
     cell_t* data;
+    key_pool_t* pool; //NULL if keys are owned by the hashtable itself
+    pthread_rwlock_t* lock; //NULL unless created as a counter hashtable
+    key_filter_t* filter; //NULL unless enabled with hashtable_enable_filter
+    hot_cache_t* hot_cache; //NULL unless enabled with hashtable_enable_hot_cache
+    key_cache_t* key_cache; //NULL unless enabled with hashtable_enable_key_cache
+    uint32_t resize_threads; //1 unless set with hashtable_set_resize_threads
+    uint32_t generation; //bumped by every resize, so cursors know keys may have moved
+    hashtable_expiry_t* expiry; //NULL unless enabled with hashtable_enable_expiry
 } hashtable_t;
 
 //possible results of insert/lookup/delete
@@ -60,9 +232,34 @@ typedef enum
     OK,
     DUPLICATE_KEY,
     KEY_NOT_FOUND,
-    HASHTABLE_FULL
+    HASHTABLE_FULL,
+    HASH_MISMATCH,
+    IO_ERROR //a durable change could not be committed to disk, see durable_hashtable.h
 } STATUS;
 
+//a key along with its precomputed hash, made by hashtable_hash and valid for every hashtable.
+typedef struct
+{
+    char* key;
+    uint32_t hash;
+    uint32_t seed;
+} hashed_key_t;
+
+//callback to combine the value of a key found in more than one hashtable during a merge.
+//into points at the value kept in the destination and is updated in place, from is destroyed after.
+typedef void (*hashtable_combine_fn)(value_type* into, value_type from);
+
+//position of a walk over the cells of a hashtable, see hashtable_next.
+typedef struct
+{
+    uint32_t next; //next slot to visit
+    uint32_t generation; //generation of the hashtable next refers to
+    uint32_t restarts; //number of times a resize made the walk start over
+} hashtable_cursor_t;
+
+//callback called with every cell visited by a range scan, along with the ctx of its range.
+typedef void (*hashtable_visit_fn)(cell_t* cell, void* ctx);
+
 //iterator-like struct to return insert/lookup/delete info
 typedef struct
 {
@@ -70,43 +267,100 @@ typedef struct
     STATUS status;
 } cell_info_t;
 
+//iterator-like struct to return insert/lookup/delete info, for layouts without a cell_t
+typedef struct
+{
+    value_type* value;
+    STATUS status;
+} value_info_t;
+
+//instruction sets the batch hash can run on, from narrowest to widest
+typedef enum
+{
+    HASH_SCALAR,
+    HASH_SSE42,
+    HASH_AVX2,
+    HASH_AVX512
+} HASH_ISA;
+
+//hash num_keys keys into out, several keys at a time on SIMD lanes if the cpu supports it.
+//out[i] is always the hash hashtable_t gives keys[i].
+void hash_batch(char** keys, uint32_t num_keys, uint32_t* out);
+
+//hash num_keys keys of exactly key_width chars each (none of them '\0'), the i-th key starting at
+//keys + i * stride, into out. used for keys laid out in a flat array (ex char[n][width + 1]).
+//out[i] is always the hash hashtable_t gives the i-th key.
+void hash_batch_fixed(const char* keys, uint32_t key_width, uint32_t stride, uint32_t num_keys, uint32_t* out);
+
+//returns the instruction set the batch hash runs on, the widest one the cpu supports.
+HASH_ISA hash_batch_isa(void);
+
+//cap the instruction set the batch hash runs on to max_isa (ex to compare against the scalar
+//path). HASH_AVX512 by default, so the widest supported one is used.
+void hash_batch_limit_isa(HASH_ISA max_isa);
+
 //initialize a hashtable with passed capacity, which must be a power of 2.
 //returns a pointer to the new hashtable
 hashtable_t* hashtable_init(uint32_t capacity);
 
+//initialize a hashtable with passed capacity, which must be a power of 2, whose keys are
+//interned in (and shared through) the passed pool.
+//returns a pointer to the new hashtable
+hashtable_t* hashtable_init_pooled(uint32_t capacity, key_pool_t* pool);
+
+//initialize a counter hashtable with passed capacity, which must be a power of 2, that also
+//supports hashtable_increment_concurrent.
+//returns a pointer to the new hashtable
+hashtable_t* hashtable_init_counter(uint32_t capacity);
+
 //cleanup the passed hashtable.
-//NOTE: needs customization if value_type requires special management.
 void hashtable_cleanup(hashtable_t* hashtable);
 
-//resize the given hashtable to new_capacity, if possible.
+//resize the given hashtable to new_capacity, if possible. resizing to the current capacity
+//rehashes in place, dropping the tombstones of an expiring hashtable.
 //returns the new capacity of the hashtable. 
 uint32_t hashtable_resize(hashtable_t* hashtable, uint32_t new_capacity);
 
+//set the number of threads that move keys whenever the passed hashtable is resized (explicitly,
+//by squash or automatically), 1 by default.
+void hashtable_set_resize_threads(hashtable_t* hashtable, uint32_t num_threads);
+
 //squash the given hashtable to it's smallest possible memory footprint.
 //returns the new capacity of the hashtable.
 uint32_t hashtable_squash(hashtable_t* hashtable);
 
 //clear the given hashtable, making it empty.
 //returns the number of deleted items.
-//NOTE: needs customization if value_type requires special management.
 uint32_t hashtable_clear(hashtable_t* hashtable);
 
 //swap the 2 passed hashtables.
 void hashtable_swap(hashtable_t* rhs, hashtable_t* lhs);
 
 //merge the src hashtable into dest, leaving src unchanged
-//if there is a key conflict, the value in dest takes precedence.
+//if there is a key conflict, the value in dest takes precedence. expired keys of src are skipped,
+//and keys with a ttl keep the time they have left (enabling expiry on dest, with the clock of
+//src, if need be).
 //returns true if there was a key conflict found, false otherwise.
 bool hashtable_merge(hashtable_t* dest, hashtable_t* src);
 
-//perform a deep copy of the passed hashtable.
+//merge every src hashtable into dest with num_threads threads, moving keys out of the srcs, which
+//are left empty. dest is resized once to fit everything, then each thread merges the keys of one
+//partition of the hash space from all srcs. values of keys found more than once are combined with
+//combine, or the value already in dest takes precedence if combine is NULL. expired keys are
+//dropped, and keys with a ttl keep the time they have left (dest gets expiry, with the clock of
+//the first src having it, if need be).
+//NOTE: runs on a single thread unless every src shares dest's key pool (or none are pooled).
+//returns true if there was a key conflict found, false otherwise.
+bool hashtable_merge_parallel(hashtable_t* dest, hashtable_t** srcs, uint32_t num_srcs, hashtable_combine_fn combine, uint32_t num_threads);
+
+//perform a deep copy of the passed hashtable. keys of pooled hashtables are shared, not copied.
 //returns a pointer to the copy.
 hashtable_t* hashtable_copy(hashtable_t* hashtable);
 
 //insert a key value pair into the passed hashtable, with flags to control automatic resizing and
-//moving keys/values behavior.
+//moving keys/values behavior. for pooled hashtables a moved key must be a reference obtained from
+//key_pool_intern on the same pool.
 //returns a cell_info_t, with status and pointer to cell if insertion succeeded (NULL otherwise).
-//NOTE: needs customization if value_type requires special management.
 cell_info_t hashtable_insert_(hashtable_t* hashtable, char* key, value_type value, bool auto_resize, bool move);
 
 //insert a key value pair into the passed hashtable, and automatically resize if need be.
@@ -120,7 +374,138 @@ cell_info_t hashtable_lookup(hashtable_t* hashtable, char* key);
 
 //delete a key value pair in the passed hashtable
 //returns a cell_info_t, with status of deletion (cell pointer always NULL)
-//NOTE: needs customization if value_type requires special management.
 cell_info_t hashtable_delete(hashtable_t* hashtable, char* key);
 
+//hash a key once, to be passed to the _hashed variants of insert/lookup/delete of any hashtable.
+//the key is not copied, so it must outlive the returned hashed key.
+hashed_key_t hashtable_hash(char* key);
+
+//hash num_keys keys up front into out, which must hold num_keys hashed keys.
+void hashtable_hash_batch(char** keys, uint32_t num_keys, hashed_key_t* out);
+
+//same as hashtable_insert, with the hash of the key already computed by hashtable_hash.
+//returns a cell_info_t like hashtable_insert, with status HASH_MISMATCH if hashed is not valid.
+cell_info_t hashtable_insert_hashed(hashtable_t* hashtable, hashed_key_t hashed, value_type value);
+
+//same as hashtable_lookup, with the hash of the key already computed by hashtable_hash.
+//returns a cell_info_t like hashtable_lookup, with status HASH_MISMATCH if hashed is not valid.
+cell_info_t hashtable_lookup_hashed(hashtable_t* hashtable, hashed_key_t hashed);
+
+//same as hashtable_delete, with the hash of the key already computed by hashtable_hash.
+//returns a cell_info_t like hashtable_delete, with status HASH_MISMATCH if hashed is not valid.
+cell_info_t hashtable_delete_hashed(hashtable_t* hashtable, hashed_key_t hashed);
+
+//add delta to the value of the passed key, inserting it with value delta if not present, in a
+//single probe. automatically resizes if need be.
+//returns a cell_info_t, with status and pointer to cell if the increment succeeded (NULL otherwise).
+cell_info_t hashtable_increment(hashtable_t* hashtable, char* key, value_type delta);
+
+//thread safe hashtable_increment for counter hashtables. existing keys are incremented atomically
+//while sharing the lock with other incrementing threads, new keys take it exclusively.
+//returns the status of the increment (no cell, as it may move as soon as the lock is released).
+STATUS hashtable_increment_concurrent(hashtable_t* hashtable, char* key, value_type delta);
+
+//find the (up to) k cells with the largest values, without copying the hashtable.
+//fills out with pointers to those cells, largest value first.
+//returns the number of cells written to out.
+uint32_t hashtable_top_k(hashtable_t* hashtable, uint32_t k, cell_t** out);
+
+//start a walk over the cells of the passed hashtable.
+//returns a cursor on its first slot.
+hashtable_cursor_t hashtable_cursor(hashtable_t* hashtable);
+
+//advance cursor to the next cell of the passed hashtable, skipping expired keys. the hashtable can
+//be changed between calls (including the returned cell being deleted), if it was resized the walk
+//starts over.
+//returns a pointer to the cell, or NULL once every slot was visited.
+cell_t* hashtable_next(hashtable_t* hashtable, hashtable_cursor_t* cursor);
+
+//call visit with every cell in slots [begin, end) of the passed hashtable, skipping expired keys.
+//end is clamped to the capacity. ranges that don't overlap can be scanned on different threads.
+//NOTE: visit may update values, but nothing may insert, delete or resize while ranges are scanned.
+//returns the number of cells visited.
+uint32_t hashtable_for_each_range(hashtable_t* hashtable, uint32_t begin, uint32_t end, hashtable_visit_fn visit, void* ctx);
+
+//call visit with every cell of the passed hashtable, splitting the slots in num_threads ranges
+//scanned on as many threads. cells of the t-th range are visited with ctxs[t] (NULL if ctxs is).
+//returns the number of cells visited.
+uint32_t hashtable_for_each_parallel(hashtable_t* hashtable, hashtable_visit_fn visit, void** ctxs, uint32_t num_threads);
+
+//attach a key filter to the passed hashtable, built from the keys already in it. lookups (and
+//deletes) check it before probing.
+void hashtable_enable_filter(hashtable_t* hashtable);
+
+//detach and free the key filter of the passed hashtable, if any.
+void hashtable_disable_filter(hashtable_t* hashtable);
+
+//check the key filter of the passed hashtable.
+//returns false if the key is definitely not in the hashtable, true if it may be (or no filter).
+bool hashtable_filter_contains(hashtable_t* hashtable, char* key);
+
+//returns the memory used by the key filter of the passed hashtable in bytes, 0 if none.
+size_t hashtable_filter_bytes(hashtable_t* hashtable);
+
+//attach an empty hot cache of num_entries entries (rounded up to a power of 2) to the passed
+//hashtable, replacing any previous one. keys found by hashtable_lookup are cached as they are hit.
+//NOTE: 12 bytes per entry, keep it small enough to stay in L1/L2 (ex 1024 to 16384 entries).
+void hashtable_enable_hot_cache(hashtable_t* hashtable, uint32_t num_entries);
+
+//detach and free the hot cache of the passed hashtable, if any.
+void hashtable_disable_hot_cache(hashtable_t* hashtable);
+
+//attach an empty key cache holding at most max_bytes of key buffers to the passed hashtable,
+//replacing any previous one. pooled hashtables share their keys through the pool instead.
+void hashtable_enable_key_cache(hashtable_t* hashtable, size_t max_bytes);
+
+//detach the key cache of the passed hashtable, if any, freeing every buffer it holds.
+void hashtable_disable_key_cache(hashtable_t* hashtable);
+
+//free every key buffer held by the key cache of the passed hashtable, and ask the allocator to
+//return its free memory to the system.
+//returns the number of bytes of key buffers freed.
+size_t hashtable_trim(hashtable_t* hashtable);
+
+//enable per key expiry on the passed hashtable, timed by clock (or a monotonic millisecond clock
+//if NULL). keys already in the hashtable never expire until given a ttl. if expiry is already
+//enabled, only the clock is replaced.
+void hashtable_enable_expiry(hashtable_t* hashtable, hashtable_clock_fn clock);
+
+//disable expiry on the passed hashtable, every key it holds is kept and never expires. the
+//hashtable is rehashed in place first if deletes left tombstones.
+void hashtable_disable_expiry(hashtable_t* hashtable);
+
+//insert a key value pair that expires ttl_ms milliseconds from now (never if 0), enabling expiry
+//with the default clock if need be. an existing (unexpired) key keeps its value and ttl.
+//returns a cell_info_t, with status and pointer to cell if insertion succeeded (NULL otherwise).
+cell_info_t hashtable_insert_ttl(hashtable_t* hashtable, char* key, value_type value, uint64_t ttl_ms);
+
+//make the passed key expire ttl_ms milliseconds from now (never if 0), enabling expiry with the
+//default clock if need be.
+//returns OK, or KEY_NOT_FOUND if the key is not in the hashtable (or already expired).
+STATUS hashtable_set_ttl(hashtable_t* hashtable, char* key, uint64_t ttl_ms);
+
+//reclaim expired keys of the passed hashtable, doing at most budget units of work (one per due
+//deadline, rescheduled deadline or run of empty ticks), so sweeping never stalls on the whole
+//hashtable. deadlines are swept with a resolution of a few milliseconds, lookups stay exact.
+//returns the number of keys reclaimed.
+uint32_t hashtable_expire_step(hashtable_t* hashtable, uint32_t budget);
+
+//initialize a key pool with passed capacity, which must be a power of 2.
+//returns a pointer to the new pool
+key_pool_t* key_pool_init(uint32_t capacity);
+
+//cleanup the passed key pool, freeing any keys still interned in it.
+void key_pool_cleanup(key_pool_t* pool);
+
+//intern the passed key, copying it into the pool if not already present.
+//returns a new reference to the interned key, to be released with key_pool_release.
+char* key_pool_intern(key_pool_t* pool, char* key);
+
+//add a reference to an already interned key.
+//returns the same interned key.
+char* key_pool_retain(char* interned_key);
+
+//drop a reference to an interned key, freeing it once unreferenced.
+void key_pool_release(key_pool_t* pool, char* interned_key);
+
 #endif //INCLUDE_HASHTABLE_H
\ No newline at end of file
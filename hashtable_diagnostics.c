@@ -0,0 +1,199 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: impl of hashtable diagnostics outlined in hashtable_diagnostics.h
+*/
+
+#include "hashtable_diagnostics.h"
+#include "hashtable_internal.h"
+#include <math.h>
+
+#define CHI_SQUARED_MIN_EXPECTED 5 //keys expected per bin for the test to mean anything
+
+static bool is_tombstone_(hashtable_t* hashtable, uint32_t idx) //local utility
+{
+    return hashtable->expiry && hashtable->expiry->expires_at[idx] == EXPIRY_TOMBSTONE;
+}
+
+static void diagnose_clusters_(hashtable_t* hashtable, hashtable_diagnostics_t* diagnostics) //local utility
+{
+    //tombstones are walked through like keys, so they extend clusters just the same
+    uint32_t capacity = hashtable->capacity;
+    uint32_t start = 0;
+    while(start < capacity && (hashtable->data[start].key || is_tombstone_(hashtable, start))) start++;
+    if(start == capacity)
+    {
+        diagnostics->clusters = 1;
+        diagnostics->max_cluster = capacity;
+        diagnostics->avg_cluster = capacity;
+        return;
+    }
+
+    //start from an empty slot so no cluster wraps around the end of the slots
+    uint32_t run = 0;
+    uint64_t total = 0;
+    for(uint32_t i = 1; i <= capacity; i++)
+    {
+        uint32_t idx = (start + i) & (capacity - 1);
+        if(hashtable->data[idx].key || is_tombstone_(hashtable, idx))
+        {
+            run++;
+            continue;
+        }
+        if(run == 0) continue;
+        diagnostics->clusters++;
+        if(run > diagnostics->max_cluster) diagnostics->max_cluster = run;
+        total += run;
+        run = 0;
+    }
+    if(diagnostics->clusters) diagnostics->avg_cluster = (double)total / diagnostics->clusters;
+}
+
+static void diagnose_uniformity_(uint32_t* hashes, uint32_t num_hashes, uint32_t capacity, hashtable_diagnostics_t* diagnostics) //local utility
+{
+    //bins are the low bits of the hash, like home slots, as few as needed to expect enough keys
+    uint32_t bins = 1;
+    while(bins < capacity && (uint64_t)(bins << 1) * CHI_SQUARED_MIN_EXPECTED <= num_hashes) bins <<= 1;
+    if(bins < 2) return;
+
+    uint32_t* observed = (uint32_t*)calloc(bins, sizeof(uint32_t));
+    for(uint32_t k = 0; k < num_hashes; k++) observed[hashes[k] & (bins - 1)]++;
+    double expected = (double)num_hashes / bins;
+    double chi_squared = 0;
+    for(uint32_t b = 0; b < bins; b++) chi_squared += (observed[b] - expected) * (observed[b] - expected) / expected;
+    free(observed);
+
+    double degrees = bins - 1;
+    diagnostics->chi_squared_bins = bins;
+    diagnostics->chi_squared = chi_squared;
+    diagnostics->chi_squared_z = (chi_squared - degrees) / sqrt(2 * degrees);
+}
+
+static probe_projection_t project_(uint32_t* hashes, uint32_t num_hashes, uint32_t capacity) //local utility
+{
+    probe_projection_t projection;
+    projection.capacity = capacity;
+    projection.load_factor = (double)num_hashes / capacity;
+
+    char* occupied = (char*)calloc(capacity, sizeof(char));
+    uint64_t hit_probes = 0;
+    for(uint32_t k = 0; k < num_hashes; k++)
+    {
+        uint32_t probe = 0;
+        while(occupied[probe_idx(hashes[k], probe, capacity)]) probe++;
+        occupied[probe_idx(hashes[k], probe, capacity)] = 1;
+        hit_probes += probe + 1;
+    }
+
+    //a miss probes until the first empty slot, from homes spread evenly over the slots
+    uint32_t samples = capacity < DIAGNOSTICS_MISS_SAMPLES ? capacity : DIAGNOSTICS_MISS_SAMPLES;
+    uint64_t miss_probes = 0;
+    for(uint32_t s = 0; s < samples; s++)
+    {
+        uint32_t home = (uint32_t)(((uint64_t)s * capacity) / samples);
+        uint32_t probe = 0;
+        while(occupied[probe_idx(home, probe, capacity)]) probe++;
+        miss_probes += probe + 1;
+    }
+    free(occupied);
+
+    projection.hit_probes = num_hashes ? (double)hit_probes / num_hashes : 0;
+    projection.miss_probes = (double)miss_probes / samples;
+    return projection;
+}
+
+hashtable_diagnostics_t hashtable_diagnose(hashtable_t* hashtable)
+{
+    hashtable_diagnostics_t diagnostics;
+    memset(&diagnostics, 0, sizeof(diagnostics));
+    uint32_t capacity = hashtable->capacity;
+    diagnostics.capacity = capacity;
+    diagnostics.size = hashtable->size;
+    diagnostics.load_factor = (double)hashtable->size / capacity;
+
+    uint32_t* homes = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+    uint32_t* hashes = (uint32_t*)malloc(sizeof(uint32_t) * (hashtable->size ? hashtable->size : 1));
+    uint32_t num_hashes = 0;
+    uint64_t total_probes = 0;
+    for(uint32_t i = 0; i < capacity; i++)
+    {
+        char* key = hashtable->data[i].key;
+        if(key == NULL)
+        {
+            if(is_tombstone_(hashtable, i)) diagnostics.tombstones++;
+            continue;
+        }
+        uint32_t key_hash = hash(key);
+        if(num_hashes < hashtable->size) hashes[num_hashes++] = key_hash;
+        homes[mod(key_hash, capacity)]++;
+
+        //follow the probe sequence of the key like a lookup would, until it reaches the key's slot
+        for(uint32_t probe = 0; probe < capacity; probe++)
+        {
+            uint32_t idx = probe_idx(key_hash, probe, capacity);
+            if(idx == i)
+            {
+                total_probes += probe + 1;
+                if(probe + 1 > diagnostics.max_probes) diagnostics.max_probes = probe + 1;
+                break;
+            }
+            if(hashtable->data[idx].key == NULL && !is_tombstone_(hashtable, idx))
+            {
+                diagnostics.unreachable++;
+                break;
+            }
+        }
+    }
+    uint32_t reachable = num_hashes - diagnostics.unreachable;
+    if(reachable) diagnostics.avg_probes = (double)total_probes / reachable;
+
+    for(uint32_t i = 0; i < capacity; i++)
+    {
+        uint32_t count = homes[i];
+        diagnostics.home_counts[count < DIAGNOSTICS_HOME_COUNTS ? count : DIAGNOSTICS_HOME_COUNTS - 1]++;
+        if(count < 2) continue;
+        diagnostics.shared_homes++;
+        if(count > diagnostics.max_shared_home) diagnostics.max_shared_home = count;
+    }
+    free(homes);
+
+    diagnose_clusters_(hashtable, &diagnostics);
+    diagnose_uniformity_(hashes, num_hashes, capacity, &diagnostics);
+
+    //from the smallest capacity the keys fit in at a load factor of at most 0.9, then doubling
+    if(num_hashes)
+    {
+        uint64_t projected_capacity = 1;
+        while(projected_capacity <= num_hashes || (double)num_hashes / projected_capacity > 0.9) projected_capacity <<= 1;
+        for(; diagnostics.num_projections < DIAGNOSTICS_PROJECTIONS && projected_capacity <= (1u << 31); projected_capacity <<= 1)
+        {
+            diagnostics.projections[diagnostics.num_projections++] = project_(hashes, num_hashes, (uint32_t)projected_capacity);
+        }
+    }
+    free(hashes);
+
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_diagnose", "diagnosed hashtable of size %u, capacity %u - %u unreachable keys", diagnostics.size, capacity, diagnostics.unreachable);
+    return diagnostics;
+}
+
+void hashtable_print_diagnostics(FILE* out, hashtable_diagnostics_t* diagnostics)
+{
+    fprintf(out, "capacity %u, size %u, tombstones %u, load factor %.3f\n", diagnostics->capacity, diagnostics->size, diagnostics->tombstones, diagnostics->load_factor);
+    fprintf(out, "home slots by keys:");
+    for(int c = 0; c < DIAGNOSTICS_HOME_COUNTS; c++) fprintf(out, " %d%s: %u", c, c + 1 == DIAGNOSTICS_HOME_COUNTS ? "+" : "", diagnostics->home_counts[c]);
+    fprintf(out, "\n");
+    fprintf(out, "primary clusters: %u, average length %.2f, longest %u\n", diagnostics->clusters, diagnostics->avg_cluster, diagnostics->max_cluster);
+    fprintf(out, "secondary clusters: %u shared home slots, largest %u keys\n", diagnostics->shared_homes, diagnostics->max_shared_home);
+    fprintf(out, "probes per lookup: average %.3f, max %u\n", diagnostics->avg_probes, diagnostics->max_probes);
+    fprintf(out, "unreachable keys (broken probe chains): %u\n", diagnostics->unreachable);
+    if(diagnostics->chi_squared_bins)
+    {
+        fprintf(out, "hash uniformity: chi-squared %.1f over %u bins, z = %.2f (%s)\n", diagnostics->chi_squared, diagnostics->chi_squared_bins, diagnostics->chi_squared_z, fabs(diagnostics->chi_squared_z) < 3 ? "uniform" : "NOT uniform");
+    }
+    else fprintf(out, "hash uniformity: too few keys to test\n");
+    for(uint32_t p = 0; p < diagnostics->num_projections; p++)
+    {
+        probe_projection_t* projection = &diagnostics->projections[p];
+        fprintf(out, "at capacity %u (load factor %.3f): %.3f probes per hit, %.3f per miss\n", projection->capacity, projection->load_factor, projection->hit_probes, projection->miss_probes);
+    }
+}
@@ -0,0 +1,77 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: hash quality and clustering diagnostics of a hashtable
+
+This header describes the interface to diagnose a slow hashtable_t from what it actually holds,
+to tell whether hash() clusters its keys, the load factor is too high or deletes broke probe
+chains.  hashtable_diagnose walks every slot once and reports:
+
+- how many slots are home (first slot of the probe sequence) to 0, 1, 2... keys.
+- primary clusters, runs of consecutive occupied slots.
+- secondary clusters, keys sharing a home slot and so their whole probe sequence.
+- the probes a lookup of every key takes, on average and at most.
+- keys no lookup can reach, because an empty slot (not a tombstone) cuts their probe chain.  Only
+  deletes from a hashtable without expiry do that.
+- a chi-squared test of how uniformly hash() spreads the keys over their home slots.
+- the probes hits and misses would take at other load factors, by replaying the hashes of the keys
+  into empty slots of each power of 2 capacity from the smallest one that fits.
+
+It reads the hashtable without changing it, so it can be run on a copy (or a loaded dump) of a
+live hashtable. 'make diagnose' builds a command line tool doing the same with a dump or a file of
+keys, see benchmark/hashtable_diagnose.c.
+*/
+
+#ifndef INCLUDE_HASHTABLE_DIAGNOSTICS_H
+#define INCLUDE_HASHTABLE_DIAGNOSTICS_H
+
+#include "hashtable.h"
+
+#define DIAGNOSTICS_HOME_COUNTS 8 //home slot histogram, the last count is for 7 keys or more
+#define DIAGNOSTICS_PROJECTIONS 4
+#define DIAGNOSTICS_MISS_SAMPLES (1 << 16) //home slots a miss is projected from, at most
+
+//probe costs of the keys of a hashtable replayed at another capacity
+typedef struct
+{
+    uint32_t capacity;
+    double load_factor;
+    double hit_probes;  //average probes to find a key
+    double miss_probes; //average probes to find a key is missing
+} probe_projection_t;
+
+//struct to represent the diagnostics of a hashtable, see hashtable_diagnose.
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t size;
+    uint32_t tombstones;
+    double load_factor;
+
+    uint32_t home_counts[DIAGNOSTICS_HOME_COUNTS]; //slots that are home to 0, 1, ... keys
+    uint32_t clusters; //primary clusters, runs of occupied slots
+    uint32_t max_cluster;
+    double avg_cluster;
+    uint32_t shared_homes; //secondary clusters, home slots of more than one key
+    uint32_t max_shared_home;
+
+    double avg_probes; //probes to look up a reachable key
+    uint32_t max_probes;
+    uint32_t unreachable; //keys behind a broken probe chain
+
+    uint32_t chi_squared_bins; //0 if there are too few keys for the test
+    double chi_squared;
+    double chi_squared_z; //standard deviations away from a uniform hash, |z| < 3 is fine
+
+    uint32_t num_projections;
+    probe_projection_t projections[DIAGNOSTICS_PROJECTIONS];
+} hashtable_diagnostics_t;
+
+//walk every slot of the passed hashtable to diagnose it.
+//returns the diagnostics of the hashtable.
+hashtable_diagnostics_t hashtable_diagnose(hashtable_t* hashtable);
+
+//print the passed diagnostics to out in a readable form.
+void hashtable_print_diagnostics(FILE* out, hashtable_diagnostics_t* diagnostics);
+
+#endif //INCLUDE_HASHTABLE_DIAGNOSTICS_H
@@ -0,0 +1,322 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: impl of hashtable dump methods outlined in hashtable_dump.h
+*/
+
+#include "hashtable_dump.h"
+#include "hashtable_internal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+//record layout: key hash (4) | key length (4) | value | key, no '\0'
+#define DUMP_RECORD_HEADER_BYTES 8
+#define DUMP_FLUSH_BYTES (1 << 20)
+
+//what the dump of one chunk needs, passed to every visited cell
+typedef struct
+{
+    int fd;
+    bool written;
+    char* data;
+    size_t size;
+    size_t capacity;
+    dump_chunk_t chunk;
+} dump_writer_t;
+
+//shared state of the threads of a load
+typedef struct
+{
+    hashtable_t* hashtable;
+    int fd;
+    dump_chunk_t* chunks;
+    uint32_t num_chunks;
+    uint32_t next_chunk; //next chunk to be claimed by a thread
+    uint32_t inserted;
+    bool failed;
+} load_job_t;
+
+static uint32_t checksum_(uint32_t val, const char* data, size_t bytes) //local utility, FNV-1a from val
+{
+    for(size_t i = 0; i < bytes; i++) val = (val ^ (uint8_t)data[i]) * 16777619u;
+    return val;
+}
+
+//checksum of the header, with its checksum field zeroed, followed by the directory of its chunks
+static uint32_t header_checksum_(dump_header_t header, const dump_chunk_t* chunks) //local utility
+{
+    header.checksum = 0;
+    uint32_t val = checksum_(2166136261u, (const char*)&header, sizeof(header));
+    return checksum_(val, (const char*)chunks, sizeof(dump_chunk_t) * header.num_chunks);
+}
+
+static bool write_all_(int fd, const char* data, size_t bytes) //local utility
+{
+    while(bytes)
+    {
+        ssize_t put = write(fd, data, bytes);
+        if(put < 0 && errno == EINTR) continue;
+        if(put <= 0) return false;
+        data += put;
+        bytes -= put;
+    }
+    return true;
+}
+
+static bool read_all_(int fd, char* data, size_t bytes, uint64_t offset) //local utility
+{
+    while(bytes)
+    {
+        ssize_t got = pread(fd, data, bytes, (off_t)offset);
+        if(got < 0 && errno == EINTR) continue;
+        if(got <= 0) return false;
+        data += got;
+        bytes -= got;
+        offset += got;
+    }
+    return true;
+}
+
+static void flush_chunk_(dump_writer_t* writer) //local utility
+{
+    writer->chunk.checksum = checksum_(writer->chunk.checksum, writer->data, writer->size);
+    writer->written = writer->written && write_all_(writer->fd, writer->data, writer->size);
+    writer->chunk.bytes += writer->size;
+    writer->size = 0;
+}
+
+static void dump_cell_(cell_t* cell, void* ctx) //local utility, appends the record of one cell
+{
+    dump_writer_t* writer = (dump_writer_t*)ctx;
+    uint32_t key_hash = hash(cell->key);
+    uint32_t key_len = (uint32_t)strlen(cell->key);
+    size_t bytes = DUMP_RECORD_HEADER_BYTES + sizeof(value_type) + key_len;
+    if(writer->size + bytes > writer->capacity)
+    {
+        size_t capacity = writer->capacity ? writer->capacity : 4096;
+        while(capacity < writer->size + bytes) capacity <<= 1;
+        writer->data = (char*)realloc(writer->data, capacity);
+        writer->capacity = capacity;
+    }
+
+    char* record = writer->data + writer->size;
+    memcpy(record, &key_hash, sizeof(uint32_t));
+    memcpy(record + 4, &key_len, sizeof(uint32_t));
+    memcpy(record + DUMP_RECORD_HEADER_BYTES, &cell->value, sizeof(value_type));
+    memcpy(record + DUMP_RECORD_HEADER_BYTES + sizeof(value_type), cell->key, key_len);
+    writer->size += bytes;
+    writer->chunk.num_keys++;
+    if(writer->size >= DUMP_FLUSH_BYTES) flush_chunk_(writer);
+}
+
+bool hashtable_dump(hashtable_t* hashtable, const char* path, uint32_t num_chunks)
+{
+    if(num_chunks == 0) num_chunks = 1;
+    if(num_chunks > hashtable->capacity) num_chunks = hashtable->capacity;
+
+    char tmp_path[4096];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "hashtable_dump", "could not open '%s' for writing", tmp_path);
+        return false;
+    }
+
+    //chunks are streamed after room left for the header and directory, written once known
+    size_t directory_bytes = sizeof(dump_chunk_t) * num_chunks;
+    dump_chunk_t* chunks = (dump_chunk_t*)malloc(directory_bytes);
+    dump_writer_t writer;
+    writer.fd = fd;
+    writer.data = NULL;
+    writer.size = 0;
+    writer.capacity = 0;
+    uint64_t offset = sizeof(dump_header_t) + directory_bytes;
+    writer.written = lseek(fd, (off_t)offset, SEEK_SET) == (off_t)offset;
+
+    uint64_t size = 0;
+    for(uint32_t c = 0; c < num_chunks && writer.written; c++)
+    {
+        writer.chunk.offset = offset;
+        writer.chunk.bytes = 0;
+        writer.chunk.num_keys = 0;
+        writer.chunk.checksum = 2166136261u;
+        uint32_t begin = (uint32_t)(((uint64_t)hashtable->capacity * c) / num_chunks);
+        uint32_t end = (uint32_t)(((uint64_t)hashtable->capacity * (c + 1)) / num_chunks);
+        hashtable_for_each_range(hashtable, begin, end, dump_cell_, &writer);
+        flush_chunk_(&writer);
+        chunks[c] = writer.chunk;
+        offset += writer.chunk.bytes;
+        size += writer.chunk.num_keys;
+    }
+    free(writer.data);
+
+    //squashed hashtables can be fuller than loads accept, those are loaded into a bigger capacity
+    uint32_t load_capacity = hashtable->capacity;
+    while(size > (uint64_t)(load_capacity * MAX_LOAD_FACTOR) && load_capacity < 1u << 31) load_capacity <<= 1;
+    dump_header_t header = {DUMP_MAGIC, (uint32_t)sizeof(value_type), HASHTABLE_SEED, load_capacity, num_chunks, size, 0, 0};
+    header.checksum = header_checksum_(header, chunks);
+    bool written = writer.written;
+    written = written && pwrite(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header);
+    written = written && pwrite(fd, chunks, directory_bytes, sizeof(header)) == (ssize_t)directory_bytes;
+    written = written && fsync(fd) == 0;
+    written &= close(fd) == 0;
+    written = written && rename(tmp_path, path) == 0;
+    free(chunks);
+
+    if(!written)
+    {
+        unlink(tmp_path);
+        if(hashtable_logs) hashtable_log(ERROR, "hashtable_dump", "could not write dump to '%s'", path);
+        return false;
+    }
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_dump", "dumped %lu keys to '%s' in %u chunks", (unsigned long)size, path, num_chunks);
+    return true;
+}
+
+//insert every record of a chunk, checked against its directory entry.
+//returns the number of keys inserted, or -1 if the chunk is not valid.
+static int64_t load_chunk_(load_job_t* job, dump_chunk_t* chunk, const char* data) //local utility
+{
+    hashtable_t* hashtable = job->hashtable;
+    if(checksum_(2166136261u, data, chunk->bytes) != chunk->checksum) return -1;
+
+    uint64_t offset = 0;
+    uint32_t num_keys = 0;
+    while(offset < chunk->bytes)
+    {
+        if(chunk->bytes - offset < DUMP_RECORD_HEADER_BYTES + sizeof(value_type)) return -1;
+        const char* record = data + offset;
+        uint32_t key_hash, key_len;
+        memcpy(&key_hash, record, sizeof(uint32_t));
+        memcpy(&key_len, record + 4, sizeof(uint32_t));
+        size_t record_bytes = DUMP_RECORD_HEADER_BYTES + sizeof(value_type) + (size_t)key_len;
+        if(chunk->bytes - offset < record_bytes || num_keys == chunk->num_keys) return -1;
+
+        char* key = (char*)malloc(key_len + 1);
+        memcpy(key, record + DUMP_RECORD_HEADER_BYTES + sizeof(value_type), key_len);
+        key[key_len] = '\0';
+
+        //dumped keys are unique, so the first empty slot of the chain is the key's, and the only
+        //contention is with threads loading keys whose probes ran into this region
+        for(int probe = 0;; probe++)
+        {
+            cell_t* cell = &hashtable->data[probe_idx(key_hash, probe, hashtable->capacity)];
+            char* empty = NULL;
+            if(__atomic_compare_exchange_n(&cell->key, &empty, key, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                memcpy(&cell->value, record + DUMP_RECORD_HEADER_BYTES, sizeof(value_type));
+                break;
+            }
+        }
+        num_keys++;
+        offset += record_bytes;
+    }
+    return num_keys == chunk->num_keys ? (int64_t)num_keys : -1;
+}
+
+static void* load_worker_(void* arg) //local utility, reads and inserts chunks until none are left
+{
+    load_job_t* job = (load_job_t*)arg;
+    char* data = NULL;
+    size_t capacity = 0;
+    while(!__atomic_load_n(&job->failed, __ATOMIC_RELAXED))
+    {
+        uint32_t c = __atomic_fetch_add(&job->next_chunk, 1, __ATOMIC_RELAXED);
+        if(c >= job->num_chunks) break;
+        dump_chunk_t* chunk = &job->chunks[c];
+        if(chunk->bytes > capacity)
+        {
+            capacity = chunk->bytes;
+            data = (char*)realloc(data, capacity);
+        }
+
+        int64_t inserted = read_all_(job->fd, data, chunk->bytes, chunk->offset) ? load_chunk_(job, chunk, data) : -1;
+        if(inserted < 0)
+        {
+            if(hashtable_logs) hashtable_log(ERROR, "hashtable_load", "chunk %u could not be read or is corrupted", c);
+            __atomic_store_n(&job->failed, true, __ATOMIC_RELAXED);
+            break;
+        }
+        __atomic_fetch_add(&job->inserted, (uint32_t)inserted, __ATOMIC_RELAXED);
+    }
+    free(data);
+    return NULL;
+}
+
+hashtable_t* hashtable_load(const char* path, uint32_t num_threads)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "hashtable_load", "could not open '%s'", path);
+        return NULL;
+    }
+
+    struct stat file_stat;
+    dump_header_t header;
+    bool valid = fstat(fd, &file_stat) == 0 && read_all_(fd, (char*)&header, sizeof(header), 0);
+    valid = valid && header.magic == DUMP_MAGIC && header.value_size == sizeof(value_type) && header.seed == HASHTABLE_SEED;
+    bool capacity_is_not_power_of_2 = header.capacity & (header.capacity - 1);
+    valid = valid && header.capacity && !capacity_is_not_power_of_2 && header.num_chunks > 0 && header.num_chunks <= header.capacity;
+    valid = valid && header.size <= (uint64_t)(header.capacity * MAX_LOAD_FACTOR);
+    uint64_t directory_bytes = sizeof(dump_chunk_t) * (uint64_t)header.num_chunks;
+    valid = valid && sizeof(header) + directory_bytes <= (uint64_t)file_stat.st_size;
+    dump_chunk_t* chunks = NULL;
+    if(valid)
+    {
+        chunks = (dump_chunk_t*)malloc(directory_bytes);
+        valid = read_all_(fd, (char*)chunks, directory_bytes, sizeof(header)) && header_checksum_(header, chunks) == header.checksum;
+
+        //chunks follow the directory back to back up to the end of the file, and every key takes at
+        //least a record header and a value, so the dump can't claim more keys than it holds
+        uint64_t offset = sizeof(header) + directory_bytes;
+        uint64_t num_keys = 0;
+        for(uint32_t c = 0; c < header.num_chunks && valid; c++)
+        {
+            valid = chunks[c].offset == offset && chunks[c].bytes <= (uint64_t)file_stat.st_size - offset;
+            valid = valid && (uint64_t)chunks[c].num_keys * (DUMP_RECORD_HEADER_BYTES + sizeof(value_type)) <= chunks[c].bytes;
+            offset += chunks[c].bytes;
+            num_keys += chunks[c].num_keys;
+        }
+        valid = valid && offset == (uint64_t)file_stat.st_size && num_keys == header.size;
+    }
+    hashtable_t* hashtable = valid ? hashtable_init(header.capacity) : NULL;
+    if(hashtable == NULL)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "hashtable_load", "'%s' is not a valid dump", path);
+        free(chunks);
+        close(fd);
+        return NULL;
+    }
+
+    load_job_t job;
+    job.hashtable = hashtable;
+    job.fd = fd;
+    job.chunks = chunks;
+    job.num_chunks = header.num_chunks;
+    job.next_chunk = 0;
+    job.inserted = 0;
+    job.failed = false;
+
+    if(num_threads == 0) num_threads = 1;
+    if(num_threads > header.num_chunks) num_threads = header.num_chunks;
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * num_threads);
+    for(uint32_t t = 1; t < num_threads; t++) pthread_create(&threads[t], NULL, load_worker_, &job);
+    load_worker_(&job);
+    for(uint32_t t = 1; t < num_threads; t++) pthread_join(threads[t], NULL);
+    free(threads);
+    free(chunks);
+    close(fd);
+
+    hashtable->size = job.inserted;
+    if(job.failed)
+    {
+        hashtable_cleanup(hashtable);
+        return NULL;
+    }
+    if(hashtable_logs) hashtable_log(INFO, "hashtable_load", "loaded %u keys from '%s' on %u threads", hashtable->size, path, num_threads);
+    return hashtable;
+}
@@ -0,0 +1,68 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: chunked dumps of a hashtable, loaded back on several threads
+
+This header describes the interface to save a hashtable_t to a file and load it back, for restores
+that must not be bound to one thread reading and inserting a record at a time.  A dump splits the
+slots of the hashtable in num_chunks ranges, and writes the keys of each range as an independent
+chunk: a directory at the start of the file gives the offset, size, key count and checksum of
+every chunk.
+
+Loading creates a hashtable of the dumped capacity up front (doubled if need be to stay within
+MAX_LOAD_FACTOR, ex for squashed hashtables), then every thread claims chunks one at a time, reads
+a whole chunk with pread, checks it and inserts its keys.  While a thread inserts,
+the others are reading, so I/O overlaps insertion.  Records carry the hash of their key, so keys are
+never hashed again, and the keys of a chunk come from one range of slots, so each thread mostly
+fills its own region of the table.  Probes that spill into another region claim slots with a CAS,
+like hashtable_merge_parallel.
+
+A dump holds every unexpired key (ttls are not kept) and the seed it was hashed with.  Dumps of
+another value_type or seed are rejected before the hashtable is created, and so are dumps whose
+header and directory don't match their checksum or each other (a size past MAX_LOAD_FACTOR of the
+capacity, chunks that don't tile the file or hold more keys than their bytes fit).  A chunk whose
+checksum doesn't match fails the load.
+NOTE: values are written bit for bit, so value_type must not own resources to be dumped.
+*/
+
+#ifndef INCLUDE_HASHTABLE_DUMP_H
+#define INCLUDE_HASHTABLE_DUMP_H
+
+#include "hashtable.h"
+
+#define DUMP_MAGIC 0x324b484348534148ull //"HASHCHK2"
+
+//header at the start of a dump, followed by the directory of its chunks
+typedef struct
+{
+    uint64_t magic;
+    uint32_t value_size; //sizeof(value_type) of the build that wrote the dump
+    uint32_t seed;       //HASHTABLE_SEED of the build that wrote the dump
+    uint32_t capacity;
+    uint32_t num_chunks;
+    uint64_t size;
+    uint32_t checksum; //of the header (with this field 0) and the directory
+    uint32_t reserved;
+} dump_header_t;
+
+//entry of the directory of a dump, one per chunk
+typedef struct
+{
+    uint64_t offset;
+    uint64_t bytes;
+    uint32_t num_keys;
+    uint32_t checksum;
+} dump_chunk_t;
+
+//write every unexpired key value pair of the passed hashtable to path, in num_chunks chunks
+//(clamped to the capacity, 1 if 0). the file is written under a temporary name and fsynced before
+//being renamed to path, so path is never left half written.
+//returns true if the dump was written.
+bool hashtable_dump(hashtable_t* hashtable, const char* path, uint32_t num_chunks);
+
+//load the dump at path into a new hashtable of the capacity in its header, with num_threads threads
+//(1 if 0) reading and inserting chunks concurrently.
+//returns a pointer to the new hashtable, NULL if the dump could not be read or is not valid.
+hashtable_t* hashtable_load(const char* path, uint32_t num_threads);
+
+#endif //INCLUDE_HASHTABLE_DUMP_H
@@ -0,0 +1,42 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: utilities shared by the hashtable layouts, private to the library
+
+This header describes the logging, hash, index reduction and probe sequence that every layout
+(hashtable_t and its siblings) shares.  It is only included by the library's own .c files (and
+its tests and benchmarks), so programs including hashtable.h don't get the bare LOG_TYPE names or
+the hash and mod globals.
+*/
+
+#ifndef INCLUDE_HASHTABLE_INTERNAL_H
+#define INCLUDE_HASHTABLE_INTERNAL_H
+
+#include "hashtable.h"
+
+//type of a log message
+typedef enum
+{
+    INFO,
+    WARN,
+    ERROR
+} LOG_TYPE;
+
+//print a log message from location, shared by every hashtable layout.
+void hashtable_log(LOG_TYPE type, const char* location, const char* fmt, ...);
+
+//hash a key to its base index, shared by every hashtable layout.
+uint32_t hash(char* key);
+
+//reduce n modulo d, which must be a power of 2.
+uint32_t mod(uint32_t n, uint32_t d);
+
+//returns the slot of the probe-th step (from 0) of the probe sequence starting at base_idx, in
+//slots of passed capacity (a power of 2).  Every string keyed layout probes with it: triangular
+//steps, which visit every slot once in the first capacity probes.
+static inline uint32_t probe_idx(uint32_t base_idx, uint32_t probe, uint32_t capacity)
+{
+    return (base_idx + (uint32_t)(((uint64_t)probe * (probe + 1)) >> 1)) & (capacity - 1);
+}
+
+#endif //INCLUDE_HASHTABLE_INTERNAL_H
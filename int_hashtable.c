@@ -0,0 +1,10 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: impl of integer keyed hashtable methods outlined in int_hashtable.h
+*/
+
+//compiles the definitions of int_hashtable_template.h for every key type
+#define INT_HASHTABLE_IMPL
+#include "hashtable_internal.h"
+#include "int_hashtable.h"
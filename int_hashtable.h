@@ -0,0 +1,40 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: uint32_t/uint64_t -> any hashtables
+
+This header describes the interface to hashtables keyed by integers (ex numeric IDs), which
+store the key inline in the slot instead of a pointer to a copied string.  Keys are hashed with
+a multiply-shift mixer and compared with a single instruction, so no formatting, allocation or
+strcmp is needed on any operation.
+
+There are two variants with the same operations and status codes as hashtable_t:
+u32_hashtable_* (8 byte slots with int values) and u64_hashtable_* (16 byte slots).  Both probe
+linearly and delete with a backward shift, so there are no tombstones.  Key 0 marks empty slots,
+so its value is kept aside in the hashtable itself - any key can be stored.
+
+Both variants are generated from int_hashtable_template.h.
+*/
+
+#ifndef INCLUDE_INT_HASHTABLE_H
+#define INCLUDE_INT_HASHTABLE_H
+
+#include "hashtable.h"
+
+#define INT_KEY_TYPE uint32_t
+#define INT_HASHTABLE(name) u32_hashtable_##name
+#define INT_HASHTABLE_NAME "u32_hashtable"
+#include "int_hashtable_template.h"
+#undef INT_KEY_TYPE
+#undef INT_HASHTABLE
+#undef INT_HASHTABLE_NAME
+
+#define INT_KEY_TYPE uint64_t
+#define INT_HASHTABLE(name) u64_hashtable_##name
+#define INT_HASHTABLE_NAME "u64_hashtable"
+#include "int_hashtable_template.h"
+#undef INT_KEY_TYPE
+#undef INT_HASHTABLE
+#undef INT_HASHTABLE_NAME
+
+#endif //INCLUDE_INT_HASHTABLE_H
@@ -0,0 +1,289 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: template of an integer keyed hashtable, see int_hashtable.h
+
+NOTE: meant to be included by int_hashtable.h only, once per key type, with INT_KEY_TYPE,
+INT_HASHTABLE(name) and INT_HASHTABLE_NAME defined.  The definitions are only compiled when
+INT_HASHTABLE_IMPL is defined (by int_hashtable.c).
+*/
+
+//struct to represent a cell of the hashtable, the key is stored inline.
+typedef struct
+{
+    INT_KEY_TYPE key;
+    value_type value;
+} INT_HASHTABLE(cell_t);
+
+//struct to represent an integer keyed hashtable.
+typedef struct
+{
+    uint32_t capacity;
+    uint32_t size; //including key 0
+    INT_HASHTABLE(cell_t)* data; //key 0 marks an empty slot
+    bool has_zero;
+    value_type zero_value; //value of key 0, which can't be stored in a slot
+} INT_HASHTABLE(t);
+
+//initialize an integer keyed hashtable with passed capacity, which must be a power of 2.
+//returns a pointer to the new hashtable
+INT_HASHTABLE(t)* INT_HASHTABLE(init)(uint32_t capacity);
+
+//cleanup the passed hashtable, destroying its values.
+void INT_HASHTABLE(cleanup)(INT_HASHTABLE(t)* hashtable);
+
+//resize the given hashtable to new_capacity, if possible.
+//returns the new capacity of the hashtable.
+uint32_t INT_HASHTABLE(resize)(INT_HASHTABLE(t)* hashtable, uint32_t new_capacity);
+
+//squash the given hashtable to it's smallest possible memory footprint.
+//returns the new capacity of the hashtable.
+uint32_t INT_HASHTABLE(squash)(INT_HASHTABLE(t)* hashtable);
+
+//clear the given hashtable, making it empty.
+//returns the number of deleted items.
+uint32_t INT_HASHTABLE(clear)(INT_HASHTABLE(t)* hashtable);
+
+//insert a key value pair into the passed hashtable, with a flag to control automatic resizing.
+//returns a value_info_t, with status and pointer to value if insertion succeeded (NULL otherwise).
+value_info_t INT_HASHTABLE(insert_)(INT_HASHTABLE(t)* hashtable, INT_KEY_TYPE key, value_type value, bool auto_resize);
+
+//insert a key value pair into the passed hashtable, and automatically resize if need be.
+//returns a value_info_t, with status and pointer to value if insertion succeeded (NULL otherwise).
+value_info_t INT_HASHTABLE(insert)(INT_HASHTABLE(t)* hashtable, INT_KEY_TYPE key, value_type value);
+
+//lookup a key value pair in the passed hashtable
+//returns a value_info_t, with status and pointer to value if lookup succeeded (NULL otherwise).
+value_info_t INT_HASHTABLE(lookup)(INT_HASHTABLE(t)* hashtable, INT_KEY_TYPE key);
+
+//delete a key value pair in the passed hashtable
+//returns a value_info_t, with status of deletion (value pointer always NULL)
+value_info_t INT_HASHTABLE(delete)(INT_HASHTABLE(t)* hashtable, INT_KEY_TYPE key);
+
+//add delta to the value of the passed key, inserting it with value delta if not present.
+//automatically resizes if need be.
+//returns a value_info_t, with status and pointer to value if the increment succeeded (NULL otherwise).
+value_info_t INT_HASHTABLE(increment)(INT_HASHTABLE(t)* hashtable, INT_KEY_TYPE key, value_type delta);
+
+#ifdef INT_HASHTABLE_IMPL
+
+//multiply-shift: only the top bits of the product depend on every bit of the key, so the slot is
+//taken from the top log2(capacity) bits (lower bits only see the low bits of the key)
+static uint32_t INT_HASHTABLE(slot_of_)(INT_HASHTABLE(t)* hashtable, INT_KEY_TYPE key) //local utility
+{
+    uint32_t bits = (uint32_t)__builtin_ctz(hashtable->capacity);
+    return bits ? (uint32_t)(((uint64_t)key * 0x9E3779B97F4A7C15ull) >> (64 - bits)) : 0;
+}
+
+static value_info_t INT_HASHTABLE(result_)(STATUS status, value_type* value) //local utility
+{
+    value_info_t result;
+    result.status = status;
+    result.value = value;
+    return result;
+}
+
+//probe for key, returning its slot or the empty slot that ends its chain (-1 if neither, which
+//only happens in a full hashtable)
+static int64_t INT_HASHTABLE(find_slot_)(INT_HASHTABLE(t)* hashtable, INT_KEY_TYPE key) //local utility
+{
+    uint32_t idx = INT_HASHTABLE(slot_of_)(hashtable, key);
+    for(uint32_t probe = 0; probe < hashtable->capacity; probe++)
+    {
+        INT_KEY_TYPE cell_key = hashtable->data[idx].key;
+        if(cell_key == key || cell_key == 0) return idx;
+        idx = mod(idx + 1, hashtable->capacity);
+    }
+    return -1;
+}
+
+INT_HASHTABLE(t)* INT_HASHTABLE(init)(uint32_t capacity)
+{
+    bool capacity_is_not_power_of_2 = capacity & (capacity - 1);
+    if(capacity == 0 || capacity_is_not_power_of_2)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, INT_HASHTABLE_NAME "_init", "capacity %u must be nonzero and a power of two, aborting", capacity);
+        return NULL;
+    }
+
+    INT_HASHTABLE(t)* hashtable = (INT_HASHTABLE(t)*)malloc(sizeof(INT_HASHTABLE(t)));
+    hashtable->capacity = capacity;
+    hashtable->size = 0;
+    hashtable->data = (INT_HASHTABLE(cell_t)*)calloc(capacity, sizeof(INT_HASHTABLE(cell_t)));
+    hashtable->has_zero = false;
+
+    if(hashtable_logs) hashtable_log(INFO, INT_HASHTABLE_NAME "_init", "created and initialized hashtable of capacity %u", capacity);
+    return hashtable;
+}
+
+void INT_HASHTABLE(cleanup)(INT_HASHTABLE(t)* hashtable)
+{
+    if(hashtable_logs) hashtable_log(INFO, INT_HASHTABLE_NAME "_cleanup", "destroying hashtable of capacity %u with %u elements", hashtable->capacity, hashtable->size);
+    INT_HASHTABLE(clear)(hashtable);
+    free(hashtable->data);
+    free(hashtable);
+}
+
+uint32_t INT_HASHTABLE(resize)(INT_HASHTABLE(t)* hashtable, uint32_t new_capacity)
+{
+    if(new_capacity == hashtable->capacity) return new_capacity;
+    bool capacity_is_not_power_of_2 = new_capacity & (new_capacity - 1);
+    if(new_capacity == 0 || capacity_is_not_power_of_2 || new_capacity > 1u << 31)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, INT_HASHTABLE_NAME "_resize", "new capacity %u is not a power of 2, aborting", new_capacity);
+        return hashtable->capacity;
+    }
+    if(new_capacity < hashtable->size - hashtable->has_zero)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, INT_HASHTABLE_NAME "_resize", "new capacity %u too small to hold current elements (%u), aborting", new_capacity, hashtable->size);
+        return hashtable->capacity;
+    }
+
+    INT_HASHTABLE(cell_t)* old_data = hashtable->data;
+    uint32_t old_capacity = hashtable->capacity;
+    hashtable->data = (INT_HASHTABLE(cell_t)*)calloc(new_capacity, sizeof(INT_HASHTABLE(cell_t)));
+    hashtable->capacity = new_capacity;
+    for(uint32_t i = 0; i < old_capacity; i++)
+    {
+        if(old_data[i].key == 0) continue;
+        uint32_t idx = INT_HASHTABLE(slot_of_)(hashtable, old_data[i].key);
+        while(hashtable->data[idx].key) idx = mod(idx + 1, new_capacity);
+        hashtable->data[idx] = old_data[i]; //moved bit for bit, old_data is freed without destroying it
+    }
+    free(old_data);
+
+    if(hashtable_logs) hashtable_log(INFO, INT_HASHTABLE_NAME "_resize", "resized hashtable to new capacity %u", new_capacity);
+    return new_capacity;
+}
+
+uint32_t INT_HASHTABLE(squash)(INT_HASHTABLE(t)* hashtable)
+{
+    uint32_t slots_needed = hashtable->size - hashtable->has_zero;
+    uint32_t new_capacity = 1;
+    while(new_capacity < slots_needed && new_capacity < 1u << 31) new_capacity <<= 1;
+    INT_HASHTABLE(resize)(hashtable, new_capacity);
+    if(hashtable_logs) hashtable_log(INFO, INT_HASHTABLE_NAME "_squash", "squashed hashtable to min capacity %u", hashtable->capacity);
+    return hashtable->capacity;
+}
+
+uint32_t INT_HASHTABLE(clear)(INT_HASHTABLE(t)* hashtable)
+{
+    uint32_t num_deletions = hashtable->size;
+    for(uint32_t i = 0; i < hashtable->capacity; i++) if(hashtable->data[i].key) HASHTABLE_VALUE_DESTROY(hashtable->data[i].value);
+    if(hashtable->has_zero) HASHTABLE_VALUE_DESTROY(hashtable->zero_value);
+    memset(hashtable->data, 0, sizeof(INT_HASHTABLE(cell_t)) * hashtable->capacity);
+    hashtable->size = 0;
+    hashtable->has_zero = false;
+
+    if(hashtable_logs) hashtable_log(INFO, INT_HASHTABLE_NAME "_clear", "cleared %u elements from hashtable", num_deletions);
+    return num_deletions;
+}
+
+value_info_t INT_HASHTABLE(insert_)(INT_HASHTABLE(t)* hashtable, INT_KEY_TYPE key, value_type value, bool auto_resize)
+{
+    if(key == 0)
+    {
+        if(hashtable->has_zero) return INT_HASHTABLE(result_)(DUPLICATE_KEY, &hashtable->zero_value);
+        hashtable->has_zero = true;
+        HASHTABLE_VALUE_COPY(&hashtable->zero_value, value);
+        hashtable->size++;
+        return INT_HASHTABLE(result_)(OK, &hashtable->zero_value);
+    }
+
+    int64_t idx = INT_HASHTABLE(find_slot_)(hashtable, key);
+    if(idx < 0)
+    {
+        if(hashtable_logs) hashtable_log(WARN, INT_HASHTABLE_NAME "_insert", "insertion of key %llu failed, size has reached capacity %u", (unsigned long long)key, hashtable->capacity);
+        return INT_HASHTABLE(result_)(HASHTABLE_FULL, NULL);
+    }
+    INT_HASHTABLE(cell_t)* cell = &hashtable->data[idx];
+    if(cell->key == key)
+    {
+        if(hashtable_logs) hashtable_log(WARN, INT_HASHTABLE_NAME "_insert", "insertion of key %llu failed, duplicate key found", (unsigned long long)key);
+        return INT_HASHTABLE(result_)(DUPLICATE_KEY, &cell->value);
+    }
+
+    cell->key = key;
+    HASHTABLE_VALUE_COPY(&cell->value, value);
+    hashtable->size++;
+
+    double load_factor = (double)(hashtable->size - hashtable->has_zero) / hashtable->capacity;
+    if(auto_resize && load_factor > MAX_LOAD_FACTOR && hashtable->capacity < 1u << 31)
+    {
+        if(hashtable_logs) hashtable_log(INFO, INT_HASHTABLE_NAME "_insert", "insertion of key %llu triggered resize to %u", (unsigned long long)key, hashtable->capacity << 1);
+        INT_HASHTABLE(resize)(hashtable, hashtable->capacity << 1);
+        return INT_HASHTABLE(lookup)(hashtable, key);
+    }
+    return INT_HASHTABLE(result_)(OK, &cell->value);
+}
+
+value_info_t INT_HASHTABLE(insert)(INT_HASHTABLE(t)* hashtable, INT_KEY_TYPE key, value_type value)
+{
+    return INT_HASHTABLE(insert_)(hashtable, key, value, /*resize*/ true);
+}
+
+value_info_t INT_HASHTABLE(lookup)(INT_HASHTABLE(t)* hashtable, INT_KEY_TYPE key)
+{
+    if(key == 0) return hashtable->has_zero ? INT_HASHTABLE(result_)(OK, &hashtable->zero_value) : INT_HASHTABLE(result_)(KEY_NOT_FOUND, NULL);
+
+    int64_t idx = INT_HASHTABLE(find_slot_)(hashtable, key);
+    if(idx < 0 || hashtable->data[idx].key != key) return INT_HASHTABLE(result_)(KEY_NOT_FOUND, NULL);
+    return INT_HASHTABLE(result_)(OK, &hashtable->data[idx].value);
+}
+
+value_info_t INT_HASHTABLE(delete)(INT_HASHTABLE(t)* hashtable, INT_KEY_TYPE key)
+{
+    if(key == 0)
+    {
+        if(!hashtable->has_zero) return INT_HASHTABLE(result_)(KEY_NOT_FOUND, NULL);
+        HASHTABLE_VALUE_DESTROY(hashtable->zero_value);
+        hashtable->has_zero = false;
+        hashtable->size--;
+        return INT_HASHTABLE(result_)(OK, NULL);
+    }
+
+    int64_t idx = INT_HASHTABLE(find_slot_)(hashtable, key);
+    if(idx < 0 || hashtable->data[idx].key != key)
+    {
+        if(hashtable_logs) hashtable_log(WARN, INT_HASHTABLE_NAME "_delete", "deletion of key %llu failed, not found", (unsigned long long)key);
+        return INT_HASHTABLE(result_)(KEY_NOT_FOUND, NULL);
+    }
+    HASHTABLE_VALUE_DESTROY(hashtable->data[idx].value);
+
+    //backward shift deletion, pull later cells of the cluster into the hole if their home allows it
+    uint32_t hole = (uint32_t)idx;
+    hashtable->data[hole].key = 0;
+    uint32_t next = mod(hole + 1, hashtable->capacity);
+    while(hashtable->data[next].key)
+    {
+        uint32_t home = INT_HASHTABLE(slot_of_)(hashtable, hashtable->data[next].key);
+        bool can_move = mod(next - home, hashtable->capacity) >= mod(next - hole, hashtable->capacity);
+        if(can_move)
+        {
+            hashtable->data[hole] = hashtable->data[next];
+            hashtable->data[next].key = 0;
+            hole = next;
+        }
+        next = mod(next + 1, hashtable->capacity);
+    }
+    hashtable->size--;
+
+    if(hashtable_logs) hashtable_log(INFO, INT_HASHTABLE_NAME "_delete", "deletion of key %llu succeeded", (unsigned long long)key);
+    return INT_HASHTABLE(result_)(OK, NULL);
+}
+
+value_info_t INT_HASHTABLE(increment)(INT_HASHTABLE(t)* hashtable, INT_KEY_TYPE key, value_type delta)
+{
+    if(key == 0 && hashtable->has_zero)
+    {
+        hashtable->zero_value += delta;
+        return INT_HASHTABLE(result_)(OK, &hashtable->zero_value);
+    }
+
+    int64_t idx = key ? INT_HASHTABLE(find_slot_)(hashtable, key) : -1;
+    if(idx < 0 || hashtable->data[idx].key != key) return INT_HASHTABLE(insert_)(hashtable, key, delta, /*resize*/ true);
+    hashtable->data[idx].value += delta;
+    return INT_HASHTABLE(result_)(OK, &hashtable->data[idx].value);
+}
+
+#endif //INT_HASHTABLE_IMPL
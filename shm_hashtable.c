@@ -0,0 +1,290 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: impl of shared hashtable methods outlined in shm_hashtable.h
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE //memfd_create
+#endif
+#include "shm_hashtable.h"
+#include "hashtable_internal.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static size_t slots_bytes_(uint32_t capacity) //local utility
+{
+    return SHM_HEADER_BYTES + sizeof(shm_cell_t) * (size_t)capacity;
+}
+
+//map the segment behind fd, checking it holds a shared hashtable that fits in it.
+//returns a pointer to the hashtable (owning fd), NULL if fd is not valid.
+static shm_hashtable_t* map_(int fd, bool writable) //local utility
+{
+    struct stat file_stat;
+    if(fstat(fd, &file_stat) != 0 || (size_t)file_stat.st_size < SHM_HEADER_BYTES) return NULL;
+    size_t bytes = (size_t)file_stat.st_size;
+    void* segment = mmap(NULL, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if(segment == MAP_FAILED) return NULL;
+
+    //capacity and keys_capacity never change once the segment is created, so check them once
+    shm_header_t* header = (shm_header_t*)segment;
+    uint32_t capacity = header->capacity;
+    bool valid = header->magic == SHM_MAGIC && header->value_size == sizeof(value_type);
+    valid = valid && capacity && !(capacity & (capacity - 1)) && slots_bytes_(capacity) <= bytes;
+    valid = valid && header->keys_capacity <= bytes - slots_bytes_(capacity);
+    if(!valid)
+    {
+        munmap(segment, bytes);
+        return NULL;
+    }
+
+    shm_hashtable_t* hashtable = (shm_hashtable_t*)malloc(sizeof(shm_hashtable_t));
+    hashtable->header = header;
+    hashtable->data = (shm_cell_t*)((char*)segment + SHM_HEADER_BYTES);
+    hashtable->keys = (char*)segment + slots_bytes_(capacity);
+    hashtable->bytes = bytes;
+    hashtable->fd = fd;
+    hashtable->writable = writable;
+    return hashtable;
+}
+
+static void write_begin_(shm_header_t* header) //local utility, readers retry until write_end_
+{
+    __atomic_store_n(&header->seq, header->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void write_end_(shm_header_t* header) //local utility, publishes the write
+{
+    __atomic_store_n(&header->seq, header->seq + 1, __ATOMIC_RELEASE);
+}
+
+//probe for key like the writer does (nothing changes under it).
+//returns the slot of the key, or -1 with the slot a new key would go in (or -1 if none) in free_idx.
+static int64_t find_(shm_hashtable_t* hashtable, char* key, uint32_t key_hash, uint32_t key_len, int64_t* free_idx) //local utility
+{
+    uint32_t capacity = hashtable->header->capacity;
+    *free_idx = -1;
+    for(uint32_t probe = 0; probe < capacity; probe++)
+    {
+        uint32_t idx = probe_idx(key_hash, probe, capacity);
+        shm_cell_t* cell = &hashtable->data[idx];
+        if(cell->key == SHM_TOMBSTONE)
+        {
+            if(*free_idx < 0) *free_idx = idx;
+            continue;
+        }
+        if(cell->key == 0)
+        {
+            if(*free_idx < 0) *free_idx = idx;
+            return -1;
+        }
+        if(cell->hash == key_hash && cell->len == key_len && memcmp(hashtable->keys + cell->key - 1, key, key_len) == 0) return idx;
+    }
+    return -1;
+}
+
+size_t shm_hashtable_size(uint32_t capacity, size_t key_bytes)
+{
+    return slots_bytes_(capacity) + key_bytes;
+}
+
+shm_hashtable_t* shm_hashtable_create(const char* name, uint32_t capacity, size_t key_bytes)
+{
+    bool capacity_is_not_power_of_2 = capacity & (capacity - 1);
+    if(capacity == 0 || capacity_is_not_power_of_2)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "shm_hashtable_create", "capacity %u must be nonzero and a power of two, aborting", capacity);
+        return NULL;
+    }
+
+    int fd = name ? shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644) : memfd_create("shm_hashtable", 0);
+    if(fd < 0)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "shm_hashtable_create", "could not create segment '%s'", name ? name : "(memfd)");
+        return NULL;
+    }
+    //a new segment is all zeros, which is an empty hashtable once the header is filled
+    size_t bytes = shm_hashtable_size(capacity, key_bytes);
+    bool created = ftruncate(fd, (off_t)bytes) == 0;
+    void* segment = created ? mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if(segment == MAP_FAILED)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "shm_hashtable_create", "could not allocate %zu bytes of shared memory", bytes);
+        close(fd);
+        if(name) shm_unlink(name);
+        return NULL;
+    }
+    shm_header_t* header = (shm_header_t*)segment;
+    header->value_size = (uint32_t)sizeof(value_type);
+    header->capacity = capacity;
+    header->keys_capacity = key_bytes;
+    //the magic goes last, so a reader attaching early never sees a half made header as valid
+    __atomic_store_n(&header->magic, SHM_MAGIC, __ATOMIC_RELEASE);
+    munmap(segment, bytes);
+
+    shm_hashtable_t* hashtable = map_(fd, /*writable*/ true);
+    if(hashtable_logs) hashtable_log(INFO, "shm_hashtable_create", "created shared hashtable of capacity %u with %zu bytes of keys", capacity, key_bytes);
+    return hashtable;
+}
+
+shm_hashtable_t* shm_hashtable_open(const char* name)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    shm_hashtable_t* hashtable = fd >= 0 ? map_(fd, /*writable*/ false) : NULL;
+    if(hashtable == NULL)
+    {
+        if(fd >= 0) close(fd);
+        if(hashtable_logs) hashtable_log(ERROR, "shm_hashtable_open", "'%s' is not a valid shared hashtable", name);
+    }
+    return hashtable;
+}
+
+shm_hashtable_t* shm_hashtable_attach(int fd)
+{
+    int own_fd = dup(fd);
+    shm_hashtable_t* hashtable = own_fd >= 0 ? map_(own_fd, /*writable*/ false) : NULL;
+    if(hashtable == NULL)
+    {
+        if(own_fd >= 0) close(own_fd);
+        if(hashtable_logs) hashtable_log(ERROR, "shm_hashtable_attach", "fd %d is not a valid shared hashtable", fd);
+    }
+    return hashtable;
+}
+
+void shm_hashtable_close(shm_hashtable_t* hashtable)
+{
+    munmap(hashtable->header, hashtable->bytes);
+    close(hashtable->fd);
+    free(hashtable);
+}
+
+bool shm_hashtable_unlink(const char* name)
+{
+    return shm_unlink(name) == 0;
+}
+
+//insert (or overwrite, if overwrite) a key value pair from the writer.
+static STATUS insert_(shm_hashtable_t* hashtable, char* key, value_type value, bool overwrite) //local utility
+{
+    if(!hashtable->writable)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "shm_hashtable_insert", "only the writer can change a shared hashtable");
+        return HASHTABLE_FULL;
+    }
+    shm_header_t* header = hashtable->header;
+    uint32_t key_hash = hash(key);
+    size_t key_len = strlen(key);
+    int64_t free_idx;
+    int64_t idx = key_len > UINT32_MAX ? -1 : find_(hashtable, key, key_hash, (uint32_t)key_len, &free_idx);
+    if(idx >= 0)
+    {
+        if(!overwrite) return DUPLICATE_KEY;
+        write_begin_(header);
+        memcpy(&hashtable->data[idx].value, &value, sizeof(value_type));
+        write_end_(header);
+        return OK;
+    }
+
+    bool reuses_tombstone = free_idx >= 0 && hashtable->data[free_idx].key == SHM_TOMBSTONE;
+    bool slots_full = (double)(header->size + header->tombstones + !reuses_tombstone) > header->capacity * MAX_LOAD_FACTOR;
+    if(free_idx < 0 || (slots_full && !reuses_tombstone) || key_len > header->keys_capacity - header->keys_used)
+    {
+        if(hashtable_logs) hashtable_log(WARN, "shm_hashtable_insert", "no room left for key '%s'", key);
+        return HASHTABLE_FULL;
+    }
+
+    //the key is written past the end of the arena, where no slot refers yet
+    uint64_t key_offset = header->keys_used;
+    memcpy(hashtable->keys + key_offset, key, key_len);
+
+    write_begin_(header);
+    shm_cell_t* cell = &hashtable->data[free_idx];
+    cell->hash = key_hash;
+    cell->len = (uint32_t)key_len;
+    memcpy(&cell->value, &value, sizeof(value_type));
+    __atomic_store_n(&cell->key, key_offset + 1, __ATOMIC_RELAXED);
+    header->keys_used += key_len;
+    header->size++;
+    if(reuses_tombstone) header->tombstones--;
+    write_end_(header);
+    return OK;
+}
+
+STATUS shm_hashtable_insert(shm_hashtable_t* hashtable, char* key, value_type value)
+{
+    return insert_(hashtable, key, value, /*overwrite*/ false);
+}
+
+STATUS shm_hashtable_put(shm_hashtable_t* hashtable, char* key, value_type value)
+{
+    return insert_(hashtable, key, value, /*overwrite*/ true);
+}
+
+STATUS shm_hashtable_delete(shm_hashtable_t* hashtable, char* key)
+{
+    if(!hashtable->writable)
+    {
+        if(hashtable_logs) hashtable_log(ERROR, "shm_hashtable_delete", "only the writer can change a shared hashtable");
+        return HASHTABLE_FULL;
+    }
+    size_t key_len = strlen(key);
+    int64_t free_idx;
+    int64_t idx = key_len > UINT32_MAX ? -1 : find_(hashtable, key, hash(key), (uint32_t)key_len, &free_idx);
+    if(idx < 0) return KEY_NOT_FOUND;
+
+    //the slot leaves a tombstone so keys further down the chain stay reachable
+    write_begin_(hashtable->header);
+    __atomic_store_n(&hashtable->data[idx].key, SHM_TOMBSTONE, __ATOMIC_RELAXED);
+    hashtable->header->size--;
+    hashtable->header->tombstones++;
+    write_end_(hashtable->header);
+    return OK;
+}
+
+STATUS shm_hashtable_lookup(shm_hashtable_t* hashtable, char* key, value_type* value)
+{
+    shm_header_t* header = hashtable->header;
+    uint32_t key_hash = hash(key);
+    size_t key_len = strlen(key);
+    uint32_t capacity = header->capacity;
+    uint64_t keys_capacity = header->keys_capacity;
+
+    while(true)
+    {
+        uint64_t seq = __atomic_load_n(&header->seq, __ATOMIC_ACQUIRE);
+        if(seq & 1) continue; //the writer is in the middle of a change
+
+        //anything read here may be torn by the writer, so offsets are checked before being followed
+        //and the result only counts if the sequence didn't move meanwhile
+        STATUS status = KEY_NOT_FOUND;
+        value_type found;
+        for(uint32_t probe = 0; probe < capacity; probe++)
+        {
+            uint32_t idx = probe_idx(key_hash, probe, capacity);
+            shm_cell_t* cell = &hashtable->data[idx];
+            uint64_t key_ref = __atomic_load_n(&cell->key, __ATOMIC_RELAXED);
+            if(key_ref == 0) break;
+            if(key_ref == SHM_TOMBSTONE) continue;
+            if(__atomic_load_n(&cell->hash, __ATOMIC_RELAXED) != key_hash || __atomic_load_n(&cell->len, __ATOMIC_RELAXED) != key_len) continue;
+            if(key_ref - 1 > keys_capacity || key_len > keys_capacity - (key_ref - 1)) continue;
+            if(memcmp(hashtable->keys + key_ref - 1, key, key_len) != 0) continue;
+            memcpy(&found, &cell->value, sizeof(value_type));
+            status = OK;
+            break;
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&header->seq, __ATOMIC_RELAXED) != seq) continue;
+        if(status == OK) *value = found;
+        return status;
+    }
+}
+
+uint64_t shm_hashtable_version(shm_hashtable_t* hashtable)
+{
+    return __atomic_load_n(&hashtable->header->seq, __ATOMIC_ACQUIRE) >> 1;
+}
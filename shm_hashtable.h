@@ -0,0 +1,117 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: string -> any hashtable shared between processes
+
+This header describes the interface to a fixed capacity hashtable living in shared memory, so that
+one copy of a big table serves every process of a host instead of each one building its own.  The
+header, the slots and a key arena are laid out in a POSIX shared memory segment (shm_open), or in
+a memfd when no name is given, whose fd is handed to the other processes (ex through fork).  Slots
+refer to their key by offset into the arena, never by pointer, so the segment means the same thing
+wherever it is mapped.
+
+A single writer process creates the segment and inserts, puts and deletes.  Any number of reader
+processes attach it read only and look keys up.  Writes are published through a seqlock: the
+writer bumps a sequence number to odd before changing anything and back to even once done, and a
+reader retries its lookup if the sequence changed (or was odd) while it probed.  Readers never
+block the writer, and never see a half written key or value.  The sequence number only grows, so
+it doubles as the version of the table (shm_hashtable_version).
+
+It uses the same hash and probe sequence as hashtable_t, with the same status codes.  Nothing
+grows: inserts past the max load factor of the slots, or past the room left in the key arena,
+return HASHTABLE_FULL, so size the segment up front.  Deleted slots leave a tombstone and deleted
+keys keep their arena space.
+NOTE: values are shared bit for bit, so value_type must not own resources (or hold pointers).
+*/
+
+#ifndef INCLUDE_SHM_HASHTABLE_H
+#define INCLUDE_SHM_HASHTABLE_H
+
+#include "hashtable.h"
+#include <stddef.h>
+
+#define SHM_MAGIC 0x314d485348534148ull //"HASHSHM1"
+#define SHM_TOMBSTONE UINT64_MAX
+#define SHM_HEADER_BYTES 64 //the header is padded to a cache line, the slots follow it
+
+//header at the start of a shared hashtable segment
+typedef struct
+{
+    uint64_t magic;
+    uint32_t value_size; //sizeof(value_type) of the build that created the segment
+    uint32_t capacity;
+    uint64_t keys_capacity;
+    uint64_t seq;        //seqlock, odd while the writer is changing the hashtable
+    uint32_t size;
+    uint32_t tombstones;
+    uint64_t keys_used;
+} shm_header_t;
+
+//slot of a shared hashtable, addressed by offset so it is valid in every process
+typedef struct
+{
+    uint64_t key; //offset of the key in the arena + 1, 0 if empty, SHM_TOMBSTONE if deleted
+    uint32_t hash;
+    uint32_t len;
+    value_type value;
+} shm_cell_t;
+
+//struct to represent the mapping of a shared hashtable in one process.
+typedef struct
+{
+    shm_header_t* header;
+    shm_cell_t* data;
+    char* keys;
+    size_t bytes; //size of the mapping
+    int fd;
+    bool writable;
+} shm_hashtable_t;
+
+//returns the number of bytes of a segment holding a shared hashtable of passed capacity with
+//key_bytes of keys (each key takes its length, with no '\0').
+size_t shm_hashtable_size(uint32_t capacity, size_t key_bytes);
+
+//create a shared hashtable with passed capacity, which must be a power of 2, and key_bytes of key
+//arena, in the new shared memory segment name (ex "/sessions"), or in a memfd if name is NULL.
+//the calling process is its writer.
+//returns a pointer to the new hashtable, NULL if the segment could not be created (or exists).
+shm_hashtable_t* shm_hashtable_create(const char* name, uint32_t capacity, size_t key_bytes);
+
+//attach the shared hashtable in the shared memory segment name, read only.
+//returns a pointer to the hashtable, NULL if the segment doesn't exist or is not valid.
+shm_hashtable_t* shm_hashtable_open(const char* name);
+
+//attach the shared hashtable in the segment or memfd behind fd, read only. fd is duplicated, so
+//the caller keeps ownership of it.
+//returns a pointer to the hashtable, NULL if fd is not a valid shared hashtable.
+shm_hashtable_t* shm_hashtable_attach(int fd);
+
+//unmap the passed shared hashtable from this process. the segment lives on until every process
+//closed it and, if named, it was unlinked.
+void shm_hashtable_close(shm_hashtable_t* hashtable);
+
+//remove the name of a shared memory segment, processes that have it attached keep their mapping.
+//returns true if the name was removed.
+bool shm_hashtable_unlink(const char* name);
+
+//insert a key value pair into the passed shared hashtable, from its writer.
+//returns OK, DUPLICATE_KEY, or HASHTABLE_FULL if there is no room left (or the handle is read only).
+STATUS shm_hashtable_insert(shm_hashtable_t* hashtable, char* key, value_type value);
+
+//insert a key value pair, or overwrite the value of the key if it's already present, from the
+//writer of the passed shared hashtable.
+//returns OK, or HASHTABLE_FULL if there is no room left (or the handle is read only).
+STATUS shm_hashtable_put(shm_hashtable_t* hashtable, char* key, value_type value);
+
+//delete a key value pair from the passed shared hashtable, from its writer.
+//returns OK, KEY_NOT_FOUND, or HASHTABLE_FULL if the handle is read only.
+STATUS shm_hashtable_delete(shm_hashtable_t* hashtable, char* key);
+
+//lookup a key in the passed shared hashtable, from any process, copying its value to value.
+//returns OK, or KEY_NOT_FOUND (value is then left untouched).
+STATUS shm_hashtable_lookup(shm_hashtable_t* hashtable, char* key, value_type* value);
+
+//returns the version of the passed shared hashtable, which grows with every published change.
+uint64_t shm_hashtable_version(shm_hashtable_t* hashtable);
+
+#endif //INCLUDE_SHM_HASHTABLE_H
@@ -0,0 +1,118 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: compile time string -> any hashtables for C++17
+
+This header describes a hashtable whose keys are all known at compile time (protocol keywords,
+fixed enumerations...).  static_hashtable_make places every key with the same hash() and probe
+sequence as hashtable_insert, but in a constexpr function, so the whole slot array is computed by
+the compiler and stored as a constant in read only memory: no startup cost, no heap use.
+
+Lookups follow the same probe sequence and statuses as hashtable_lookup, and are constexpr too,
+so a lookup of a constant key can be checked at compile time:
+
+    static constexpr static_cell_t keyword_cells[] = {{"GET", 1}, {"PUT", 2}, {"DELETE", 3}};
+    static constexpr auto keywords = static_hashtable_make(keyword_cells);
+    static_assert(keywords.lookup("PUT").cell->value == 2);
+
+Keys must have static storage (ex string literals), since only pointers to them are stored, and
+value_type must be a literal type.  A duplicate key fails the build.
+*/
+
+#ifndef INCLUDE_STATIC_HASHTABLE_HPP
+#define INCLUDE_STATIC_HASHTABLE_HPP
+
+#include "hashtable.h"
+#include <stddef.h>
+
+//struct to represent a cell of a static hashtable.
+struct static_cell_t
+{
+    const char* key;
+    value_type value;
+};
+
+//iterator-like struct to return lookup info, read only.
+struct static_cell_info_t
+{
+    const static_cell_t* cell;
+    STATUS status;
+};
+
+//same as hash(), usable at compile time.
+constexpr uint32_t static_hash(const char* key)
+{
+    uint32_t val = HASHTABLE_SEED;
+    int c = 0;
+
+    while((c = *key++)) val = ((val << 5) + val) + c;
+    return val;
+}
+
+//returns the capacity hashtable_insert would have grown to for num_keys keys.
+constexpr uint32_t static_capacity(size_t num_keys)
+{
+    uint32_t capacity = 1;
+    while((double)num_keys / capacity > MAX_LOAD_FACTOR) capacity <<= 1;
+    return capacity;
+}
+
+constexpr bool static_key_equal_(const char* lhs, const char* rhs) //local utility, strcmp(...) == 0
+{
+    while(*lhs && *lhs == *rhs)
+    {
+        lhs++;
+        rhs++;
+    }
+    return *lhs == *rhs;
+}
+
+//struct to represent a static hashtable, built by static_hashtable_make.
+template <uint32_t Capacity>
+struct static_hashtable_t
+{
+    static constexpr uint32_t capacity = Capacity;
+    uint32_t size;
+    static_cell_t data[Capacity];
+
+    //lookup a key value pair in the static hashtable
+    //returns a static_cell_info_t, with status and pointer to cell if lookup succeeded (NULL otherwise).
+    constexpr static_cell_info_t lookup(const char* key) const
+    {
+        uint32_t base_idx = static_hash(key);
+        for(uint32_t probe = 0; probe < Capacity; probe++) //a full cycle visits every slot once
+        {
+            uint32_t idx = (base_idx + ((probe*(probe+1)) >> 1)) & (Capacity - 1);
+            if(data[idx].key == nullptr) break; //empty slot
+            if(static_key_equal_(data[idx].key, key)) return {&data[idx], OK};
+        }
+        return {nullptr, KEY_NOT_FOUND};
+    }
+};
+
+//build a static hashtable holding the passed cells, inserted in order like with hashtable_insert.
+//returns the static hashtable, only fit to initialize a constexpr variable.
+template <size_t N>
+constexpr static_hashtable_t<static_capacity(N)> static_hashtable_make(const static_cell_t (&cells)[N])
+{
+    constexpr uint32_t capacity = static_capacity(N);
+    static_hashtable_t<capacity> hashtable{};
+
+    for(size_t i = 0; i < N; i++)
+    {
+        uint32_t base_idx = static_hash(cells[i].key);
+        uint32_t probe = 0;
+        uint32_t idx = base_idx & (capacity - 1);
+        while(hashtable.data[idx].key != nullptr)
+        {
+            if(static_key_equal_(hashtable.data[idx].key, cells[i].key)) throw "static_hashtable_make: duplicate key";
+            probe++;
+            idx = (base_idx + ((probe*(probe+1)) >> 1)) & (capacity - 1);
+        }
+        hashtable.data[idx] = cells[i];
+        hashtable.size++;
+    }
+    return hashtable;
+}
+
+#endif //INCLUDE_STATIC_HASHTABLE_HPP
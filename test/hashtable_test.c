@@ -1,11 +1,23 @@
 /*
 Author: Dante Crescenzi
-Last Modif: 28 Mar 2024
+Last Modif: 19 Oct 2026
 Description: unit tests for hashtable functionality
 */
 
 #include "hashtable_test.h"
 
+//clock of the expiring hashtables of the tests, set by hand
+static uint64_t fake_now = 0;
+
+uint64_t fake_clock()
+{
+    return fake_now;
+}
+
+//values copied and destroyed by the hashtables, counted by test/value_hooks.h
+unsigned long test_value_copies = 0;
+unsigned long test_value_destroys = 0;
+
 //INIT TESTS (prefixed with hashtable_init_should)
 bool reject_empty_size()
 {
@@ -89,6 +101,78 @@ bool properly_downsize()
     return pass;
 }
 
+bool move_every_key_on_several_threads()
+{
+    bool pass = true;
+    char key[16];
+    int num_keys = PARALLEL_RESIZE_MIN_KEYS * 2;
+    hashtable_t* htb = hashtable_init(1);
+    hashtable_set_resize_threads(htb, 4);
+    pass &= htb->resize_threads == 4;
+
+    //automatic resizes go parallel once past PARALLEL_RESIZE_MIN_KEYS
+    for(int i = 0; i < num_keys; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(htb, key, i);
+    }
+    pass &= htb->size == (uint32_t)num_keys;
+
+    hashtable_resize(htb, htb->capacity << 2);
+    pass &= hashtable_insert(htb, (char*)"key0", 0).status == DUPLICATE_KEY;
+    hashtable_t* copy = hashtable_copy(htb);
+    pass &= copy->resize_threads == 4;
+    pass &= hashtable_squash(htb) == (uint32_t)num_keys;
+    for(int i = 0; i < num_keys; i++)
+    {
+        sprintf(key, "key%d", i);
+        cell_info_t lookup = hashtable_lookup(htb, key);
+        pass &= lookup.status == OK && lookup.cell->value == i;
+    }
+
+    hashtable_set_resize_threads(htb, 0);
+    pass &= htb->resize_threads == 1;
+    hashtable_cleanup(copy);
+    hashtable_cleanup(htb);
+    return pass;
+}
+
+bool keep_filter_and_expiry_through_parallel_resize()
+{
+    bool pass = true;
+    char key[16];
+    int num_keys = PARALLEL_RESIZE_MIN_KEYS + 100;
+    fake_now = 1000;
+    key_pool_t* pool = key_pool_init(16);
+    hashtable_t* htb = hashtable_init_pooled(1 << 16, pool);
+    hashtable_enable_filter(htb);
+    hashtable_enable_expiry(htb, fake_clock);
+    hashtable_set_resize_threads(htb, 3);
+    for(int i = 0; i < num_keys; i++)
+    {
+        sprintf(key, "key%d", i);
+        if(i % 2) hashtable_insert_ttl(htb, key, i, 100);
+        else hashtable_insert(htb, key, i);
+    }
+
+    hashtable_resize(htb, 1 << 17);
+    for(int i = 0; i < num_keys; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= hashtable_filter_contains(htb, key) && hashtable_lookup(htb, key).status == OK;
+    }
+    fake_now += 100;
+    for(int i = 0; i < num_keys; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= hashtable_lookup(htb, key).status == (i % 2 ? KEY_NOT_FOUND : OK);
+    }
+
+    hashtable_cleanup(htb);
+    key_pool_cleanup(pool);
+    return pass;
+}
+
 //SQUASH TESTS (prefixed with hashtable_squash_should)
 bool squash_for_power_of_2_size()
 {
@@ -689,4 +773,2560 @@ bool merge_squash()
     hashtable_cleanup(htb);
     hashtable_cleanup(htb2);
     return pass;
-}
\ No newline at end of file
+}
+
+//KEY POOL TESTS (prefixed with key_pool_should)
+bool share_keys_on_copy()
+{
+    bool pass = true;
+    key_pool_t* pool = key_pool_init(1 << 3);
+    hashtable_t* htb = hashtable_init_pooled(1 << 3, pool);
+
+    hashtable_insert(htb, "key1", 1);
+    hashtable_insert(htb, "key2", 2);
+    hashtable_insert(htb, "key3", 3);
+    pass &= pool->size == 3;
+
+    hashtable_t* htb2 = hashtable_copy(htb);
+    pass &= htb2->size == 3;
+    pass &= pool->size == 3;
+
+    cell_info_t lookup = hashtable_lookup(htb, "key2");
+    cell_info_t lookup2 = hashtable_lookup(htb2, "key2");
+    pass &= lookup2.status == OK;
+    pass &= lookup2.cell->value == 2;
+    pass &= lookup.cell->key == lookup2.cell->key;
+
+    hashtable_cleanup(htb);
+    lookup2 = hashtable_lookup(htb2, "key3");
+    pass &= lookup2.status == OK;
+    pass &= lookup2.cell->value == 3;
+
+    hashtable_cleanup(htb2);
+    key_pool_cleanup(pool);
+    return pass;
+}
+
+bool share_keys_on_merge()
+{
+    bool pass = true;
+    key_pool_t* pool = key_pool_init(1 << 3);
+    hashtable_t* htb = hashtable_init_pooled(1 << 3, pool);
+    hashtable_t* htb2 = hashtable_init_pooled(1 << 3, pool);
+
+    hashtable_insert(htb, "1key1", 1);
+    hashtable_insert(htb, "1key2", 2);
+    hashtable_insert(htb, "shared", 3);
+
+    hashtable_insert(htb2, "shared", 7);
+    hashtable_insert(htb2, "2key2", 2);
+    hashtable_insert(htb2, "2key3", 3);
+    hashtable_insert(htb2, "2key4", 4);
+    pass &= pool->size == 6;
+
+    pass &= hashtable_merge(htb, htb2);
+    pass &= htb->size == 6;
+    pass &= pool->size == 6;
+
+    cell_info_t lookup = hashtable_lookup(htb, "shared");
+    pass &= lookup.status == OK;
+    pass &= lookup.cell->value == 3;
+
+    lookup = hashtable_lookup(htb, "2key4");
+    pass &= lookup.status == OK;
+    pass &= lookup.cell->key == hashtable_lookup(htb2, "2key4").cell->key;
+
+    hashtable_cleanup(htb2);
+    pass &= pool->size == 6;
+
+    hashtable_cleanup(htb);
+    key_pool_cleanup(pool);
+    return pass;
+}
+
+bool release_keys_on_cleanup()
+{
+    bool pass = true;
+    key_pool_t* pool = key_pool_init(1 << 2);
+    hashtable_t* htb = hashtable_init_pooled(1 << 3, pool);
+
+    char key[8];
+    for(int i = 0; i < 20; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(htb, key, i);
+    }
+    pass &= pool->size == 20;
+    pass &= pool->capacity == 32; //should have grown
+
+    for(int i = 0; i < 20; i += 2)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_delete(htb, key);
+    }
+    pass &= pool->size == 10;
+
+    for(int i = 1; i < 20; i += 2)
+    {
+        sprintf(key, "key%d", i);
+        cell_info_t lookup = hashtable_lookup(htb, key);
+        pass &= lookup.status == OK && lookup.cell->value == i;
+    }
+
+    hashtable_clear(htb);
+    pass &= pool->size == 0;
+
+    hashtable_cleanup(htb);
+    key_pool_cleanup(pool);
+    return pass;
+}
+
+//INCREMENT TESTS (prefixed with hashtable_increment_should)
+bool increment_new_and_existing_keys()
+{
+    bool pass = true;
+    cell_info_t lookup;
+    hashtable_t* htb = hashtable_init(1 << 1);
+
+    lookup = hashtable_increment(htb, "key1", 1);
+    pass &= lookup.status == OK;
+    pass &= lookup.cell->value == 1;
+
+    hashtable_increment(htb, "key2", 5);
+    hashtable_increment(htb, "key1", 1);
+    hashtable_increment(htb, "key3", 1);
+    lookup = hashtable_increment(htb, "key1", 1);
+    pass &= lookup.cell->value == 3;
+
+    pass &= htb->size == 3;
+    pass &= htb->capacity == 4; //should have resized
+
+    lookup = hashtable_lookup(htb, "key2");
+    pass &= lookup.status == OK;
+    pass &= lookup.cell->value == 5;
+
+    hashtable_cleanup(htb);
+    return pass;
+}
+
+typedef struct
+{
+    hashtable_t* htb;
+    int offset;
+} increment_args_t;
+
+void* increment_worker(void* arg)
+{
+    increment_args_t* args = (increment_args_t*)arg;
+    char key[8];
+    for(int i = 0; i < 1000; i++)
+    {
+        sprintf(key, "key%d", (i + args->offset) % 100);
+        hashtable_increment_concurrent(args->htb, key, 1);
+    }
+    return NULL;
+}
+
+bool increment_concurrently()
+{
+    bool pass = true;
+    hashtable_t* htb = hashtable_init_counter(1 << 2);
+
+    pthread_t threads[4];
+    increment_args_t args[4];
+    for(int t = 0; t < 4; t++)
+    {
+        args[t].htb = htb;
+        args[t].offset = t * 7;
+        pthread_create(&threads[t], NULL, increment_worker, &args[t]);
+    }
+    for(int t = 0; t < 4; t++) pthread_join(threads[t], NULL);
+
+    pass &= htb->size == 100;
+
+    char key[8];
+    for(int i = 0; i < 100; i++)
+    {
+        sprintf(key, "key%d", i);
+        cell_info_t lookup = hashtable_lookup(htb, key);
+        pass &= lookup.status == OK && lookup.cell->value == 40;
+    }
+
+    hashtable_cleanup(htb);
+    return pass;
+}
+
+bool extract_top_k()
+{
+    bool pass = true;
+    hashtable_t* htb = hashtable_init(1 << 4);
+
+    hashtable_insert(htb, "key1", 4);
+    hashtable_insert(htb, "key2", 9);
+    hashtable_insert(htb, "key3", 1);
+    hashtable_insert(htb, "key4", 7);
+    hashtable_insert(htb, "key5", 3);
+
+    cell_t* top[8];
+    pass &= hashtable_top_k(htb, 3, top) == 3;
+    pass &= strcmp(top[0]->key, "key2") == 0;
+    pass &= strcmp(top[1]->key, "key4") == 0;
+    pass &= strcmp(top[2]->key, "key1") == 0;
+
+    pass &= hashtable_top_k(htb, 8, top) == 5;
+    pass &= top[0]->value == 9;
+    pass &= top[4]->value == 1;
+
+    hashtable_cleanup(htb);
+    return pass;
+}
+
+//PARALLEL MERGE TESTS (prefixed with hashtable_merge_parallel_should)
+void sum_values(value_type* into, value_type from)
+{
+    *into += from;
+}
+
+bool merge_partitions_with_combine()
+{
+    bool pass = true;
+    char key[8];
+    hashtable_t* dest = hashtable_init(1 << 1);
+    hashtable_t* srcs[3];
+    for(int s = 0; s < 3; s++)
+    {
+        srcs[s] = hashtable_init(1 << 3);
+        for(int i = 0; i < 50; i++)
+        {
+            sprintf(key, "key%d", i + s * 25);
+            hashtable_increment(srcs[s], key, 1);
+        }
+    }
+
+    pass &= hashtable_merge_parallel(dest, srcs, 3, sum_values, 4);
+    pass &= dest->size == 100;
+    pass &= dest->capacity == 256; //should have been sized once for all 150 keys
+
+    for(int i = 0; i < 100; i++)
+    {
+        sprintf(key, "key%d", i);
+        cell_info_t lookup = hashtable_lookup(dest, key);
+        bool overlapped = i >= 25 && i < 75;
+        pass &= lookup.status == OK && lookup.cell->value == (overlapped ? 2 : 1);
+    }
+
+    for(int s = 0; s < 3; s++)
+    {
+        pass &= srcs[s]->size == 0;
+        pass &= hashtable_lookup(srcs[s], "key30").status == KEY_NOT_FOUND;
+        hashtable_cleanup(srcs[s]);
+    }
+    hashtable_cleanup(dest);
+    return pass;
+}
+
+bool keep_dest_value_without_combine()
+{
+    bool pass = true;
+    cell_info_t lookup;
+    key_pool_t* pool = key_pool_init(1 << 3);
+    hashtable_t* dest = hashtable_init_pooled(1 << 3, pool);
+    hashtable_t* src = hashtable_init_pooled(1 << 3, pool);
+
+    hashtable_insert(dest, "1key1", 1);
+    hashtable_insert(dest, "shared", 3);
+
+    hashtable_insert(src, "shared", 7);
+    hashtable_insert(src, "2key2", 2);
+    hashtable_insert(src, "2key3", 3);
+
+    pass &= hashtable_merge_parallel(dest, &src, 1, NULL, 2);
+    pass &= dest->size == 4;
+    pass &= src->size == 0;
+    pass &= pool->size == 4;
+
+    lookup = hashtable_lookup(dest, "shared");
+    pass &= lookup.status == OK;
+    pass &= lookup.cell->value == 3;
+
+    lookup = hashtable_lookup(dest, "2key3");
+    pass &= lookup.status == OK;
+    pass &= lookup.cell->value == 3;
+
+    hashtable_cleanup(src);
+    hashtable_cleanup(dest);
+    pass &= pool->size == 0;
+    key_pool_cleanup(pool);
+    return pass;
+}
+
+//FILTER TESTS (prefixed with hashtable_filter_should)
+bool reject_missing_keys()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* htb = hashtable_init(1 << 10);
+    for(int i = 0; i < 700; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(htb, key, i);
+    }
+
+    hashtable_enable_filter(htb);
+    pass &= hashtable_filter_bytes(htb) > 0;
+
+    for(int i = 0; i < 700; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= hashtable_filter_contains(htb, key);
+    }
+
+    int false_positives = 0;
+    for(int i = 0; i < 1000; i++)
+    {
+        sprintf(key, "missing%d", i);
+        false_positives += hashtable_filter_contains(htb, key);
+        pass &= hashtable_lookup(htb, key).status == KEY_NOT_FOUND;
+    }
+    pass &= false_positives < 100;
+
+    hashtable_disable_filter(htb);
+    pass &= hashtable_filter_bytes(htb) == 0;
+    pass &= hashtable_lookup(htb, "key5").status == OK;
+
+    hashtable_cleanup(htb);
+    return pass;
+}
+
+bool stay_coherent_through_resize_and_delete()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* htb = hashtable_init(1 << 2);
+    hashtable_enable_filter(htb);
+
+    for(int i = 0; i < 200; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(htb, key, i);
+    }
+    pass &= htb->capacity == 512; //should have resized
+
+    for(int i = 0; i < 200; i++)
+    {
+        sprintf(key, "key%d", i);
+        cell_info_t lookup = hashtable_lookup(htb, key);
+        pass &= lookup.status == OK && lookup.cell->value == i;
+    }
+
+    hashtable_delete(htb, "key7");
+    pass &= hashtable_lookup(htb, "key7").status == KEY_NOT_FOUND;
+    hashtable_insert(htb, "key7", 70);
+    pass &= hashtable_lookup(htb, "key7").cell->value == 70;
+
+    hashtable_t* htb2 = hashtable_copy(htb);
+    pass &= hashtable_lookup(htb2, "key150").status == OK;
+    pass &= hashtable_lookup(htb2, "key250").status == KEY_NOT_FOUND;
+
+    hashtable_clear(htb);
+    pass &= !hashtable_filter_contains(htb, "key150");
+    hashtable_increment(htb, "key150", 1);
+    pass &= hashtable_lookup(htb, "key150").status == OK;
+
+    hashtable_cleanup(htb);
+    hashtable_cleanup(htb2);
+    return pass;
+}
+
+//COMPACT HASHTABLE TESTS (prefixed with compact_hashtable_should)
+bool properly_insert_and_lookup_compact()
+{
+    bool pass = true;
+    value_info_t lookup;
+    compact_hashtable_t* htb = compact_hashtable_init(1 << 3);
+
+    compact_hashtable_insert(htb, "key1", 1);
+    compact_hashtable_insert(htb, "key2", 2);
+    compact_hashtable_insert(htb, "key3", 3);
+    compact_hashtable_insert(htb, "key4", 4);
+    compact_hashtable_insert(htb, "key5", 5);
+    compact_hashtable_insert(htb, "key6", 6);
+    compact_hashtable_insert(htb, "key7", 7);
+    lookup = compact_hashtable_insert(htb, "key7", 8);
+    pass &= lookup.status == DUPLICATE_KEY;
+    pass &= *lookup.value == 7;
+
+    pass &= htb->size == 7;
+    pass &= htb->capacity == 16; //should have resized
+
+    lookup = compact_hashtable_lookup(htb, "key3");
+    pass &= lookup.status == OK;
+    pass &= *lookup.value == 3;
+    (*lookup.value)++;
+    pass &= *compact_hashtable_lookup(htb, "key3").value == 4;
+
+    lookup = compact_hashtable_lookup(htb, "bingus");
+    pass &= lookup.status == KEY_NOT_FOUND;
+
+    compact_hashtable_squash(htb);
+    pass &= htb->capacity == 8;
+    pass &= *compact_hashtable_lookup(htb, "key6").value == 6;
+
+    compact_hashtable_cleanup(htb);
+    return pass;
+}
+
+bool keep_probe_chains_after_delete()
+{
+    bool pass = true;
+    char key[16];
+    compact_hashtable_t* htb = compact_hashtable_init(1 << 4);
+
+    for(int i = 0; i < 500; i++)
+    {
+        sprintf(key, "key%d", i);
+        compact_hashtable_insert(htb, key, i);
+    }
+    for(int i = 0; i < 500; i += 2)
+    {
+        sprintf(key, "key%d", i);
+        pass &= compact_hashtable_delete(htb, key).status == OK;
+    }
+    pass &= htb->size == 250;
+    pass &= compact_hashtable_delete(htb, "key0").status == KEY_NOT_FOUND;
+
+    for(int i = 0; i < 500; i++)
+    {
+        sprintf(key, "key%d", i);
+        value_info_t lookup = compact_hashtable_lookup(htb, key);
+        pass &= i % 2 ? lookup.status == OK && *lookup.value == i : lookup.status == KEY_NOT_FOUND;
+    }
+
+    for(int i = 0; i < 500; i += 2)
+    {
+        sprintf(key, "key%d", i);
+        pass &= compact_hashtable_insert(htb, key, -i).status == OK;
+    }
+    pass &= htb->size == 500;
+    pass &= *compact_hashtable_lookup(htb, "key42").value == -42;
+
+    pass &= compact_hashtable_clear(htb) == 500;
+    pass &= compact_hashtable_lookup(htb, "key43").status == KEY_NOT_FOUND;
+
+    compact_hashtable_cleanup(htb);
+    return pass;
+}
+
+bool use_less_memory_than_cells()
+{
+    bool pass = true;
+    char key[16];
+    compact_hashtable_t* htb = compact_hashtable_init(1 << 10);
+    for(int i = 0; i < 700; i++)
+    {
+        sprintf(key, "key%d", i);
+        compact_hashtable_insert(htb, key, i);
+    }
+
+    size_t slot_bytes = compact_hashtable_bytes(htb) - htb->keys_capacity - sizeof(compact_hashtable_t);
+    pass &= slot_bytes * 10 < sizeof(cell_t) * htb->capacity * 6;
+
+    compact_hashtable_cleanup(htb);
+    return pass;
+}
+
+//CACHE TESTS (prefixed with hashcache_should)
+bool evict_when_full()
+{
+    bool pass = true;
+    char key[16];
+    hashcache_t* cache = hashcache_init(100, NULL, NULL);
+
+    for(int i = 0; i < 1000; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= hashcache_insert(cache, key, i).status == OK;
+        pass &= cache->size <= 100;
+    }
+    pass &= cache->size == 100;
+    pass &= cache->evictions == 900;
+    pass &= cache->capacity == 256;
+
+    int found = 0;
+    for(int i = 0; i < 1000; i++)
+    {
+        sprintf(key, "key%d", i);
+        cell_info_t lookup = hashcache_lookup(cache, key);
+        if(lookup.status != OK) continue;
+        found++;
+        pass &= lookup.cell->value == i;
+    }
+    pass &= found == 100;
+    pass &= cache->hits == 100 && cache->misses == 900;
+    pass &= hashcache_hit_ratio(cache) == 0.1;
+
+    hashcache_cleanup(cache);
+    return pass;
+}
+
+bool evict_unreferenced_entries_first()
+{
+    bool pass = true;
+    char key[16];
+    hashcache_t* cache = hashcache_init(10, NULL, NULL);
+
+    for(int i = 0; i < 10; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashcache_insert(cache, key, i);
+    }
+    hashcache_lookup(cache, "key3");
+    hashcache_lookup(cache, "key7");
+
+    for(int i = 10; i < 18; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashcache_insert(cache, key, i);
+    }
+    pass &= cache->evictions == 8;
+    pass &= hashcache_lookup(cache, "key3").status == OK;
+    pass &= hashcache_lookup(cache, "key7").status == OK;
+    pass &= hashcache_lookup(cache, "key17").status == OK;
+
+    pass &= hashcache_insert(cache, "key3", 30).status == DUPLICATE_KEY;
+    pass &= hashcache_delete(cache, "key3").status == OK;
+    pass &= hashcache_lookup(cache, "key3").status == KEY_NOT_FOUND;
+    pass &= cache->size == 9;
+
+    hashcache_cleanup(cache);
+    return pass;
+}
+
+void count_releases(char* key, value_type* value, bool evicted, void* ctx)
+{
+    int* counts = (int*)ctx;
+    counts[evicted ? 0 : 1] += *value;
+}
+
+bool release_every_entry()
+{
+    bool pass = true;
+    char key[16];
+    int counts[2] = {0, 0};
+    hashcache_t* cache = hashcache_init(4, count_releases, counts);
+
+    for(int i = 1; i <= 6; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashcache_insert(cache, key, i);
+    }
+
+    int missing_sum = 0;
+    for(int i = 1; i <= 6; i++)
+    {
+        sprintf(key, "key%d", i);
+        if(hashcache_lookup(cache, key).status != OK) missing_sum += i;
+    }
+    pass &= cache->evictions == 2;
+    pass &= counts[0] == missing_sum;
+    pass &= counts[1] == 0;
+
+    pass &= hashcache_insert(cache, "key7", 7).status == OK;
+    pass &= hashcache_lookup(cache, "key7").status == OK;
+    pass &= hashcache_delete(cache, "key7").status == OK;
+    pass &= counts[1] == 7;
+
+    hashcache_cleanup(cache);
+    pass &= counts[0] + counts[1] == 1 + 2 + 3 + 4 + 5 + 6 + 7;
+    return pass;
+}
+//EXPIRY TESTS (prefixed with hashtable_expiry_should)
+
+bool treat_expired_keys_as_missing()
+{
+    bool pass = true;
+    fake_now = 1000;
+    hashtable_t* hashtable = hashtable_init(16);
+    hashtable_enable_expiry(hashtable, fake_clock);
+
+    pass &= hashtable_insert_ttl(hashtable, "session", 1, 100).status == OK;
+    pass &= hashtable_insert_ttl(hashtable, "forever", 2, 0).status == OK;
+    pass &= hashtable_insert(hashtable, "plain", 3).status == OK;
+
+    fake_now += 99;
+    pass &= hashtable_lookup(hashtable, "session").status == OK;
+    fake_now += 1;
+    pass &= hashtable_lookup(hashtable, "session").status == KEY_NOT_FOUND;
+    pass &= hashtable->size == 2;
+
+    //expired keys can be inserted again, and counting restarts from zero
+    pass &= hashtable_insert_ttl(hashtable, "session", 4, 50).status == OK;
+    fake_now += 50;
+    pass &= hashtable_insert(hashtable, "session", 5).status == OK;
+    pass &= hashtable_lookup(hashtable, "session").cell->value == 5;
+    pass &= hashtable_set_ttl(hashtable, "session", 10) == OK;
+    fake_now += 10;
+    pass &= hashtable_increment(hashtable, "session", 7).cell->value == 7;
+
+    pass &= hashtable_set_ttl(hashtable, "missing", 10) == KEY_NOT_FOUND;
+    pass &= hashtable_set_ttl(hashtable, "plain", 10) == OK;
+    pass &= hashtable_set_ttl(hashtable, "plain", 0) == OK;
+    fake_now += 1000000;
+    pass &= hashtable_lookup(hashtable, "plain").status == OK;
+    pass &= hashtable_lookup(hashtable, "forever").status == OK;
+    pass &= hashtable->size == 3;
+
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool sweep_expired_keys_incrementally()
+{
+    bool pass = true;
+    char key[16];
+    fake_now = 0;
+    hashtable_t* hashtable = hashtable_init(16);
+    hashtable_enable_expiry(hashtable, fake_clock);
+
+    //short lived keys, keys a few levels up the wheel, and keys past its horizon (about 3 days)
+    for(int i = 0; i < 1500; i++)
+    {
+        sprintf(key, "key%d", i);
+        uint64_t ttl = i < 500 ? 1000 + i : i < 1000 ? 5000000 : 600000000;
+        hashtable_insert_ttl(hashtable, key, i, ttl);
+    }
+    //a refreshed ttl outlives the deadline it replaced
+    pass &= hashtable_set_ttl(hashtable, "key0", 3000) == OK;
+
+    fake_now = 2000;
+    //a due deadline reclaims every expired key of its probe chain, so steps can reclaim a few more
+    //keys than their budget, but never the whole backlog at once
+    uint32_t num_expired = 0;
+    uint32_t max_step = 0;
+    for(int step = 0; step < 1000; step++)
+    {
+        uint32_t reclaimed = hashtable_expire_step(hashtable, 8);
+        if(reclaimed > max_step) max_step = reclaimed;
+        num_expired += reclaimed;
+    }
+    pass &= num_expired == 499;
+    pass &= max_step < 200;
+    pass &= hashtable->size == 1001;
+    pass &= hashtable_lookup(hashtable, "key0").status == OK;
+
+    fake_now = 3100;
+    while(hashtable_expire_step(hashtable, 8) || hashtable->expiry->tick < fake_now / 16);
+    pass &= hashtable->size == 1000;
+
+    fake_now = 5001000;
+    num_expired = 0;
+    for(int step = 0; step < 10000 && hashtable->size > 500; step++) num_expired += hashtable_expire_step(hashtable, 8);
+    pass &= num_expired == 500;
+    pass &= hashtable_lookup(hashtable, "key999").status == KEY_NOT_FOUND;
+    pass &= hashtable_lookup(hashtable, "key1000").status == OK;
+
+    fake_now = 601000000;
+    for(int step = 0; step < 10000 && hashtable->size > 0; step++) hashtable_expire_step(hashtable, 8);
+    pass &= hashtable->size == 0;
+
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool keep_ttls_through_resize_and_copy()
+{
+    bool pass = true;
+    char key[16];
+    fake_now = 0;
+    hashtable_t* hashtable = hashtable_init(4);
+    hashtable_enable_expiry(hashtable, fake_clock);
+
+    for(int i = 0; i < 64; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert_ttl(hashtable, key, i, i % 2 ? 100 : 0);
+    }
+    pass &= hashtable->capacity == 128;
+    hashtable_t* copy = hashtable_copy(hashtable);
+
+    fake_now = 100;
+    pass &= hashtable_lookup(hashtable, "key1").status == KEY_NOT_FOUND;
+    pass &= hashtable_lookup(copy, "key1").status == KEY_NOT_FOUND;
+    pass &= hashtable_lookup(copy, "key2").status == OK;
+
+    fake_now = 200;
+    pass &= hashtable_expire_step(hashtable, 1000) == 31;
+    pass &= hashtable_expire_step(copy, 1000) == 31;
+    pass &= hashtable->size == 32 && copy->size == 32;
+
+    pass &= hashtable_clear(hashtable) == 32;
+    pass &= hashtable_insert(hashtable, "key1", 1).status == OK;
+    fake_now = 1000000;
+    pass &= hashtable_lookup(hashtable, "key1").status == OK;
+
+    hashtable_cleanup(hashtable);
+    hashtable_cleanup(copy);
+    return pass;
+}
+
+bool keep_probe_chains_when_disabled()
+{
+    bool pass = true;
+    //"Aa" and "B@" hash the same, so "B@" sits behind "Aa" in its probe chain
+    hashtable_t* hashtable = hashtable_init(16);
+    hashtable_enable_expiry(hashtable, fake_clock);
+    hashtable_insert(hashtable, (char*)"Aa", 1);
+    hashtable_insert(hashtable, (char*)"B@", 2);
+    hashtable_delete(hashtable, (char*)"Aa");
+    hashtable_disable_expiry(hashtable);
+
+    cell_info_t lookup = hashtable_lookup(hashtable, (char*)"B@");
+    pass &= lookup.status == OK && lookup.cell->value == 2;
+    pass &= hashtable_insert(hashtable, (char*)"B@", 3).status == DUPLICATE_KEY;
+    pass &= hashtable->size == 1 && hashtable->expiry == NULL;
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool carry_ttls_through_merges()
+{
+    bool pass = true;
+    char key[16];
+    fake_now = 1000;
+    hashtable_t* srcs[2];
+    for(int s = 0; s < 2; s++)
+    {
+        srcs[s] = hashtable_init(64);
+        hashtable_enable_expiry(srcs[s], fake_clock);
+        for(int i = s * 20; i < s * 20 + 20; i++)
+        {
+            sprintf(key, "key%d", i);
+            hashtable_insert_ttl(srcs[s], key, i, i % 4 == 0 ? 50 : i % 4 == 1 ? 500 : 0);
+        }
+    }
+    fake_now = 1100; //keys with a ttl of 50 expired, but were never swept
+
+    //keys without expiry in dest, so merges have to enable it
+    hashtable_t* merged = hashtable_init(16);
+    hashtable_t* merged_parallel = hashtable_init(16);
+    pass &= !hashtable_merge(merged, srcs[0]) && !hashtable_merge(merged, srcs[1]);
+    pass &= !hashtable_merge_parallel(merged_parallel, srcs, 2, NULL, 2);
+    pass &= merged->size == 30 && merged_parallel->size == 30;
+    pass &= merged->expiry != NULL && merged_parallel->expiry != NULL;
+
+    for(int i = 0; i < 40; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= hashtable_lookup(merged, key).status == (i % 4 == 0 ? KEY_NOT_FOUND : OK);
+        pass &= hashtable_lookup(merged_parallel, key).status == (i % 4 == 0 ? KEY_NOT_FOUND : OK);
+    }
+
+    //keys with a ttl of 500 expire when they would have in their src, the others never do
+    fake_now = 1499;
+    pass &= hashtable_lookup(merged, (char*)"key1").status == OK && hashtable_lookup(merged_parallel, (char*)"key1").status == OK;
+    fake_now = 2000;
+    pass &= hashtable_expire_step(merged, 1000) == 10 && hashtable_expire_step(merged_parallel, 1000) == 10;
+    pass &= merged->size == 20 && merged_parallel->size == 20;
+    pass &= hashtable_lookup(merged, (char*)"key2").status == OK && hashtable_lookup(merged_parallel, (char*)"key3").status == OK;
+
+    hashtable_cleanup(merged);
+    hashtable_cleanup(merged_parallel);
+    hashtable_cleanup(srcs[0]);
+    hashtable_cleanup(srcs[1]);
+    return pass;
+}
+
+//FROZEN HASHTABLE TESTS (prefixed with frozen_hashtable_should)
+bool find_every_key_in_its_own_slot()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* hashtable = hashtable_init(16);
+    for(int i = 0; i < 5000; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(hashtable, key, i);
+    }
+
+    frozen_hashtable_t* frozen = hashtable_freeze(hashtable);
+    pass &= frozen != NULL;
+    pass &= frozen->size == 5000;
+    pass &= hashtable->size == 5000;
+    hashtable_cleanup(hashtable);
+
+    //minimal: every slot holds exactly one key
+    bool* seen = (bool*)calloc(frozen->size, sizeof(bool));
+    for(int i = 0; i < 5000; i++)
+    {
+        sprintf(key, "key%d", i);
+        value_info_t lookup = frozen_hashtable_lookup(frozen, key);
+        pass &= lookup.status == OK && *lookup.value == i;
+        if(lookup.status != OK) continue;
+        uint32_t slot = lookup.value - frozen->values;
+        pass &= !seen[slot];
+        seen[slot] = true;
+    }
+    free(seen);
+
+    pass &= frozen_hashtable_lookup(frozen, "key5000").status == KEY_NOT_FOUND;
+    pass &= frozen_hashtable_lookup(frozen, "").status == KEY_NOT_FOUND;
+    pass &= frozen_hashtable_lookup(frozen, "key").status == KEY_NOT_FOUND;
+
+    frozen_hashtable_cleanup(frozen);
+    return pass;
+}
+
+bool load_frozen_blob_from_a_mapped_file()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* hashtable = hashtable_init(64);
+    for(int i = 0; i < 40; i++)
+    {
+        sprintf(key, "word%d", i);
+        hashtable_insert(hashtable, key, i * 2);
+    }
+    frozen_hashtable_t* frozen = hashtable_freeze(hashtable);
+    hashtable_cleanup(hashtable);
+
+    char path[] = "/tmp/frozen_hashtable_XXXXXX";
+    int fd = mkstemp(path);
+    close(fd);
+    pass &= frozen_hashtable_write(frozen, path);
+
+    frozen_hashtable_t* mapped = frozen_hashtable_map(path);
+    pass &= mapped != NULL && mapped->mapped;
+    if(mapped)
+    {
+        pass &= frozen_hashtable_bytes(mapped) == frozen_hashtable_bytes(frozen);
+        for(int i = 0; i < 40; i++)
+        {
+            sprintf(key, "word%d", i);
+            value_info_t lookup = frozen_hashtable_lookup(mapped, key);
+            pass &= lookup.status == OK && *lookup.value == i * 2;
+        }
+        pass &= frozen_hashtable_lookup(mapped, "word40").status == KEY_NOT_FOUND;
+        frozen_hashtable_cleanup(mapped);
+    }
+
+    //blobs are relocatable, so a plain copy of one works just as well
+    void* copy = malloc(frozen_hashtable_bytes(frozen));
+    memcpy(copy, frozen->blob, frozen_hashtable_bytes(frozen));
+    frozen_hashtable_t* borrowed = frozen_hashtable_from_blob(copy, frozen_hashtable_bytes(frozen));
+    pass &= borrowed != NULL && *frozen_hashtable_lookup(borrowed, "word7").value == 14;
+    pass &= frozen_hashtable_from_blob(copy, 8) == NULL;
+    ((frozen_header_t*)copy)->magic = 0;
+    pass &= frozen_hashtable_from_blob(copy, frozen_hashtable_bytes(frozen)) == NULL;
+    frozen_hashtable_cleanup(borrowed);
+    free(copy);
+
+    //files that aren't frozen blobs are rejected
+    FILE* file = fopen(path, "wb");
+    fputs("not a frozen hashtable", file);
+    fclose(file);
+    pass &= frozen_hashtable_map(path) == NULL;
+    unlink(path);
+    pass &= frozen_hashtable_map(path) == NULL;
+
+    frozen_hashtable_cleanup(frozen);
+    return pass;
+}
+
+bool freeze_empty_and_expiring_tables()
+{
+    bool pass = true;
+    hashtable_t* hashtable = hashtable_init(8);
+    frozen_hashtable_t* frozen = hashtable_freeze(hashtable);
+    pass &= frozen != NULL && frozen->size == 0;
+    pass &= frozen_hashtable_lookup(frozen, "key").status == KEY_NOT_FOUND;
+    frozen_hashtable_cleanup(frozen);
+
+    fake_now = 0;
+    hashtable_enable_expiry(hashtable, fake_clock);
+    hashtable_insert_ttl(hashtable, "stays", 1, 0);
+    hashtable_insert_ttl(hashtable, "expires", 2, 10);
+    fake_now = 10;
+    frozen = hashtable_freeze(hashtable);
+    pass &= frozen->size == 1;
+    pass &= frozen_hashtable_lookup(frozen, "stays").status == OK;
+    pass &= frozen_hashtable_lookup(frozen, "expires").status == KEY_NOT_FOUND;
+
+    frozen_hashtable_cleanup(frozen);
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool reject_corrupted_frozen_blobs()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* hashtable = hashtable_init(64);
+    for(int i = 0; i < 40; i++)
+    {
+        sprintf(key, "word%d", i);
+        hashtable_insert(hashtable, key, i);
+    }
+    frozen_hashtable_t* frozen = hashtable_freeze(hashtable);
+    hashtable_cleanup(hashtable);
+    size_t bytes = frozen_hashtable_bytes(frozen);
+    char* copy = (char*)malloc(bytes);
+    size_t offsets_at = (char*)frozen->offsets - (char*)frozen->blob;
+    size_t pilots_at = (char*)frozen->pilots - (char*)frozen->blob;
+    size_t keys_bytes = bytes - (frozen->keys - (char*)frozen->blob);
+
+    //a key offset past the end of the blob
+    memcpy(copy, frozen->blob, bytes);
+    ((uint32_t*)(copy + offsets_at))[3] = keys_bytes;
+    pass &= frozen_hashtable_from_blob(copy, bytes) == NULL;
+
+    //the last key losing its terminator
+    memcpy(copy, frozen->blob, bytes);
+    copy[bytes - 1] = 'x';
+    pass &= frozen_hashtable_from_blob(copy, bytes) == NULL;
+
+    //a pilot sending keys to slots that aren't theirs
+    memcpy(copy, frozen->blob, bytes);
+    for(uint32_t b = 0; b < frozen->num_buckets; b++) ((uint32_t*)(copy + pilots_at))[b] += 1;
+    pass &= frozen_hashtable_from_blob(copy, bytes) == NULL;
+
+    //while an intact copy still loads
+    memcpy(copy, frozen->blob, bytes);
+    frozen_hashtable_t* borrowed = frozen_hashtable_from_blob(copy, bytes);
+    pass &= borrowed != NULL && *frozen_hashtable_lookup(borrowed, "word9").value == 9;
+    if(borrowed) frozen_hashtable_cleanup(borrowed);
+    free(copy);
+    frozen_hashtable_cleanup(frozen);
+    return pass;
+}
+
+//INTEGER KEY TESTS (prefixed with int_hashtable_should)
+bool properly_insert_and_lookup_int_keys()
+{
+    bool pass = true;
+    u32_hashtable_t* small = u32_hashtable_init(4);
+    u64_hashtable_t* large = u64_hashtable_init(4);
+
+    //0 marks empty slots internally, so make sure it's still a regular key
+    uint64_t keys[] = {0, 1, 42, 4294967295ull, 4294967296ull, 18446744073709551615ull};
+    for(int i = 0; i < 6; i++)
+    {
+        pass &= u64_hashtable_insert(large, keys[i], i).status == OK;
+        if(keys[i] <= UINT32_MAX) pass &= u32_hashtable_insert(small, (uint32_t)keys[i], i).status == OK;
+    }
+    pass &= large->size == 6 && small->size == 4;
+    pass &= large->capacity == 8;
+
+    for(int i = 0; i < 6; i++)
+    {
+        value_info_t lookup = u64_hashtable_lookup(large, keys[i]);
+        pass &= lookup.status == OK && *lookup.value == i;
+        pass &= u64_hashtable_insert(large, keys[i], 100).status == DUPLICATE_KEY;
+        if(keys[i] > UINT32_MAX) continue;
+        lookup = u32_hashtable_lookup(small, (uint32_t)keys[i]);
+        pass &= lookup.status == OK && *lookup.value == i;
+    }
+    pass &= u64_hashtable_lookup(large, 2).status == KEY_NOT_FOUND;
+    pass &= u32_hashtable_lookup(small, 2).status == KEY_NOT_FOUND;
+
+    pass &= u64_hashtable_delete(large, 0).status == OK;
+    pass &= u64_hashtable_lookup(large, 0).status == KEY_NOT_FOUND;
+    pass &= u64_hashtable_delete(large, 0).status == KEY_NOT_FOUND;
+    pass &= large->size == 5;
+
+    //a full hashtable still answers lookups of missing keys
+    u32_hashtable_t* full = u32_hashtable_init(4);
+    for(uint32_t k = 1; k <= 4; k++) pass &= u32_hashtable_insert_(full, k, k, /*resize*/ false).status == OK;
+    pass &= u32_hashtable_insert_(full, 5, 5, /*resize*/ false).status == HASHTABLE_FULL;
+    pass &= u32_hashtable_lookup(full, 5).status == KEY_NOT_FOUND;
+    pass &= u32_hashtable_delete(full, 3).status == OK;
+    pass &= u32_hashtable_lookup(full, 4).status == OK;
+
+    //keys that only differ above bit 32 (ex shifted ids) must still spread over the slots
+    u64_hashtable_t* high = u64_hashtable_init(4096);
+    for(uint64_t k = 0; k < 2048; k++) pass &= u64_hashtable_insert_(high, k << 48, k, /*resize*/ false).status == OK;
+    //most keys should sit in their home slot, the top 12 bits of the multiply-shift
+    uint32_t at_home = 0;
+    for(uint32_t i = 0; i < high->capacity; i++)
+    {
+        uint64_t key = high->data[i].key;
+        at_home += key != 0 && (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 52) == i;
+    }
+    pass &= at_home > 1024;
+    for(uint64_t k = 0; k < 2048; k++) pass &= u64_hashtable_lookup(high, k << 48).status == OK;
+    u64_hashtable_cleanup(high);
+
+    u32_hashtable_cleanup(full);
+    u32_hashtable_cleanup(small);
+    u64_hashtable_cleanup(large);
+    return pass;
+}
+
+bool keep_clusters_findable_after_delete()
+{
+    bool pass = true;
+    u64_hashtable_t* hashtable = u64_hashtable_init(1024);
+    for(uint64_t k = 1; k <= 700; k++) u64_hashtable_insert_(hashtable, k * 1000003, k, /*resize*/ false);
+
+    for(uint64_t k = 1; k <= 700; k += 3) pass &= u64_hashtable_delete(hashtable, k * 1000003).status == OK;
+    for(uint64_t k = 1; k <= 700; k++)
+    {
+        value_info_t lookup = u64_hashtable_lookup(hashtable, k * 1000003);
+        if(k % 3 == 1) pass &= lookup.status == KEY_NOT_FOUND;
+        else pass &= lookup.status == OK && *lookup.value == (value_type)k;
+    }
+    pass &= hashtable->size == 466;
+
+    pass &= u64_hashtable_clear(hashtable) == 466;
+    pass &= u64_hashtable_lookup(hashtable, 2 * 1000003).status == KEY_NOT_FOUND;
+
+    u64_hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool increment_and_squash_int_keys()
+{
+    bool pass = true;
+    u32_hashtable_t* hashtable = u32_hashtable_init(1);
+    for(uint32_t i = 0; i < 1000; i++) u32_hashtable_increment(hashtable, i % 100, 1);
+    pass &= hashtable->size == 100;
+    pass &= *u32_hashtable_lookup(hashtable, 0).value == 10;
+    pass &= *u32_hashtable_lookup(hashtable, 99).value == 10;
+
+    pass &= u32_hashtable_squash(hashtable) == 128;
+    pass &= u32_hashtable_resize(hashtable, 64) == 128;
+    for(uint32_t i = 0; i < 100; i++) pass &= *u32_hashtable_lookup(hashtable, i).value == 10;
+
+    u32_hashtable_cleanup(hashtable);
+    return pass;
+}
+
+//PRE-HASHED TESTS (prefixed with hashtable_hashed_should)
+bool probe_several_tables_with_one_hash()
+{
+    bool pass = true;
+    key_pool_t* pool = key_pool_init(16);
+    hashtable_t* tiers[3] = {hashtable_init(2), hashtable_init_pooled(2, pool), hashtable_init(64)};
+    hashtable_enable_filter(tiers[2]);
+
+    char* keys[100];
+    hashed_key_t hashed[100];
+    for(int i = 0; i < 100; i++)
+    {
+        keys[i] = (char*)malloc(16);
+        snprintf(keys[i], 16, "tenant-%d", i);
+    }
+    hashtable_hash_batch(keys, 100, hashed);
+
+    //each key lives in the tier given by its index, inserted through resizes
+    for(int i = 0; i < 100; i++)
+    {
+        pass &= hashed[i].key == keys[i] && hashed[i].hash == hash(keys[i]);
+        pass &= hashtable_insert_hashed(tiers[i % 3], hashed[i], i).status == OK;
+    }
+    pass &= hashtable_insert_hashed(tiers[0], hashed[0], 0).status == DUPLICATE_KEY;
+
+    for(int i = 0; i < 100; i++)
+    {
+        for(int t = 0; t < 3; t++)
+        {
+            cell_info_t lookup = hashtable_lookup_hashed(tiers[t], hashed[i]);
+            if(t == i % 3) pass &= lookup.status == OK && lookup.cell->value == i;
+            else pass &= lookup.status == KEY_NOT_FOUND;
+        }
+        pass &= hashtable_lookup(tiers[i % 3], keys[i]).status == OK;
+    }
+
+    for(int i = 0; i < 3; i++)
+    {
+        pass &= hashtable_delete_hashed(tiers[i], hashed[i]).status == OK;
+        pass &= hashtable_lookup(tiers[i], keys[i]).status == KEY_NOT_FOUND;
+        pass &= hashtable_delete_hashed(tiers[i], hashed[i]).status == KEY_NOT_FOUND;
+    }
+    pass &= tiers[0]->size + tiers[1]->size + tiers[2]->size == 97;
+
+    for(int t = 0; t < 3; t++) hashtable_cleanup(tiers[t]);
+    for(int i = 0; i < 100; i++) free(keys[i]);
+    key_pool_cleanup(pool);
+    return pass;
+}
+
+bool reject_hashes_not_made_by_hashtable_hash()
+{
+    bool pass = true;
+    hashtable_t* hashtable = hashtable_init(8);
+    hashtable_insert(hashtable, (char*)"key", 1);
+
+    hashed_key_t forged = {(char*)"key", hash((char*)"key"), 0};
+    pass &= hashtable_lookup_hashed(hashtable, forged).status == HASH_MISMATCH;
+    pass &= hashtable_insert_hashed(hashtable, forged, 2).status == HASH_MISMATCH;
+    pass &= hashtable_delete_hashed(hashtable, forged).status == HASH_MISMATCH;
+
+    hashed_key_t empty = {NULL, 0, 0};
+    pass &= hashtable_lookup_hashed(hashtable, empty).status == HASH_MISMATCH;
+
+    hashed_key_t hashed = hashtable_hash((char*)"key");
+    pass &= hashed.seed == HASHTABLE_SEED;
+    pass &= hashtable_lookup_hashed(hashtable, hashed).cell->value == 1;
+    pass &= hashtable->size == 1;
+
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+//BATCH HASH TESTS (prefixed with hash_batch_should)
+bool match_scalar_hash_on_every_isa()
+{
+    bool pass = true;
+    //keys of 4 to 40 chars with bytes above 127, so chars sign extend, and a run of shorter keys
+    //(empty included) that the lanes leave to the scalar path
+    char* keys[101];
+    uint32_t hashes[101];
+    for(int i = 0; i < 101; i++)
+    {
+        int len = i >= 40 && i < 45 ? i - 40 : 4 + (i * 7) % 37;
+        keys[i] = (char*)malloc(len + 1);
+        for(int c = 0; c < len; c++) keys[i][c] = (char)(1 + (i * 31 + c * 17) % 255);
+        keys[i][len] = '\0';
+    }
+
+    HASH_ISA widest = hash_batch_isa();
+    for(int isa = HASH_SCALAR; isa <= (int)widest; isa++)
+    {
+        hash_batch_limit_isa((HASH_ISA)isa);
+        pass &= hash_batch_isa() == (HASH_ISA)isa;
+        memset(hashes, 0, sizeof(hashes));
+        hash_batch(keys, 101, hashes);
+        for(int i = 0; i < 101; i++) pass &= hashes[i] == hash(keys[i]);
+    }
+    hash_batch_limit_isa(HASH_AVX512);
+
+    hashed_key_t hashed[101];
+    hashtable_hash_batch(keys, 101, hashed);
+    for(int i = 0; i < 101; i++) pass &= hashed[i].key == keys[i] && hashed[i].hash == hash(keys[i]);
+
+    for(int i = 0; i < 101; i++) free(keys[i]);
+    return pass;
+}
+
+bool match_scalar_hash_for_fixed_width_keys()
+{
+    bool pass = true;
+    char flat[37 * 24];
+    char key[24];
+    uint32_t hashes[37];
+    HASH_ISA widest = hash_batch_isa();
+
+    for(uint32_t width = 1; width <= 19; width++)
+    {
+        uint32_t stride = width + 1 + width % 3; //terminated keys, sometimes with padding after
+        for(uint32_t i = 0; i < 37; i++)
+        {
+            for(uint32_t c = 0; c < width; c++) flat[i * stride + c] = (char)(1 + (i * 13 + c * 29 + width) % 255);
+            flat[i * stride + width] = '\0';
+        }
+
+        for(int isa = HASH_SCALAR; isa <= (int)widest; isa++)
+        {
+            hash_batch_limit_isa((HASH_ISA)isa);
+            memset(hashes, 0, sizeof(hashes));
+            hash_batch_fixed(flat, width, stride, 37, hashes);
+            for(uint32_t i = 0; i < 37; i++)
+            {
+                memcpy(key, flat + i * stride, width + 1);
+                pass &= hashes[i] == hash(key);
+            }
+        }
+        hash_batch_limit_isa(HASH_AVX512);
+    }
+    return pass;
+}
+
+//DURABLE HASHTABLE TESTS (prefixed with durable_hashtable_should)
+static uint32_t remove_dir_(const char* dir) //removes dir and its files, returns how many logs it had
+{
+    uint32_t logs = 0;
+    char path[512];
+    DIR* handle = opendir(dir);
+    struct dirent* entry;
+    while(handle && (entry = readdir(handle)))
+    {
+        if(entry->d_name[0] == '.') continue;
+        logs += strncmp(entry->d_name, "wal.", 4) == 0;
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        unlink(path);
+    }
+    if(handle) closedir(handle);
+    rmdir(dir);
+    return logs;
+}
+
+bool recover_updates_after_reopen()
+{
+    bool pass = true;
+    char dir[] = "/tmp/durable_hashtable_XXXXXX";
+    pass &= mkdtemp(dir) != NULL;
+    durability_policy_t policy = durability_policy_default();
+    policy.mode = DURABILITY_SYNC;
+
+    char key[16];
+    durable_hashtable_t* durable = durable_hashtable_open(dir, policy);
+    for(int i = 0; i < 200; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= durable_hashtable_insert(durable, key, i).status == OK;
+    }
+    pass &= durable_hashtable_insert(durable, (char*)"key0", 1000).status == DUPLICATE_KEY;
+    for(int i = 0; i < 200; i += 2)
+    {
+        sprintf(key, "key%d", i);
+        pass &= durable_hashtable_put(durable, key, -i).status == OK;
+    }
+    for(int i = 0; i < 200; i += 3)
+    {
+        sprintf(key, "key%d", i);
+        pass &= durable_hashtable_delete(durable, key).status == OK;
+    }
+    pass &= durable_hashtable_delete(durable, (char*)"key0").status == KEY_NOT_FOUND;
+    pass &= durable->commits == 200 + 100 + 67; //one commit per change, none for failed ones
+    durable_hashtable_close(durable);
+
+    durable = durable_hashtable_open(dir, policy);
+    pass &= durable != NULL && durable->table->size == 200 - 67;
+    for(int i = 0; durable && i < 200; i++)
+    {
+        sprintf(key, "key%d", i);
+        cell_info_t lookup = hashtable_lookup(durable->table, key);
+        if(i % 3 == 0) pass &= lookup.status == KEY_NOT_FOUND;
+        else pass &= lookup.status == OK && lookup.cell->value == (i % 2 ? i : -i);
+    }
+    if(durable) durable_hashtable_close(durable);
+    remove_dir_(dir);
+    return pass;
+}
+
+bool drop_torn_records_on_replay()
+{
+    bool pass = true;
+    char dir[] = "/tmp/durable_hashtable_XXXXXX";
+    pass &= mkdtemp(dir) != NULL;
+    durability_policy_t policy = durability_policy_default();
+    policy.mode = DURABILITY_NONE;
+
+    char key[16];
+    durable_hashtable_t* durable = durable_hashtable_open(dir, policy);
+    for(int i = 0; i < 10; i++)
+    {
+        sprintf(key, "key%d", i);
+        durable_hashtable_insert(durable, key, i);
+    }
+    durable_hashtable_close(durable);
+
+    //a crash mid write leaves the start of a record at the end of the log
+    char path[512];
+    snprintf(path, sizeof(path), "%s/wal.%016x", dir, 0);
+    FILE* log = fopen(path, "ab");
+    pass &= log != NULL;
+    if(log)
+    {
+        fwrite("\x12\x34\x56\x78\x01\x05\x00", 1, 7, log);
+        fclose(log);
+    }
+
+    durable = durable_hashtable_open(dir, policy);
+    pass &= durable != NULL && durable->table->size == 10;
+    if(durable)
+    {
+        pass &= durable_hashtable_insert(durable, (char*)"after", 10).status == OK;
+        durable_hashtable_close(durable);
+    }
+
+    durable = durable_hashtable_open(dir, policy);
+    pass &= durable != NULL && durable->table->size == 11;
+    if(durable)
+    {
+        cell_info_t lookup = hashtable_lookup(durable->table, (char*)"after");
+        pass &= lookup.status == OK && lookup.cell->value == 10;
+        durable_hashtable_close(durable);
+    }
+    remove_dir_(dir);
+    return pass;
+}
+
+bool group_commit_and_compact_in_background()
+{
+    bool pass = true;
+    char dir[] = "/tmp/durable_hashtable_XXXXXX";
+    pass &= mkdtemp(dir) != NULL;
+    durability_policy_t policy = durability_policy_default();
+    policy.commit_interval_ms = 5;
+    policy.compact_bytes = 1 << 14;
+
+    char key[16];
+    durable_hashtable_t* durable = durable_hashtable_open(dir, policy);
+    for(int i = 0; i < 4000; i++)
+    {
+        sprintf(key, "key%d", i % 500);
+        durable_hashtable_put(durable, key, i);
+    }
+    pass &= durable_hashtable_sync(durable);
+    pass &= durable->commits < 4000; //records share commits
+
+    //unless a commit already started one, the log is past compact_bytes and the next change starts
+    //a compaction
+    durable_hashtable_put(durable, (char*)"key0", 4000);
+    pass &= durable->log_gen > 0;
+    durable_hashtable_close(durable);
+
+    durable = durable_hashtable_open(dir, policy);
+    pass &= durable != NULL && durable->table->size == 500;
+    for(int i = 0; durable && i < 500; i++)
+    {
+        sprintf(key, "key%d", i);
+        cell_info_t lookup = hashtable_lookup(durable->table, key);
+        pass &= lookup.status == OK && lookup.cell->value == (i ? 3500 + i : 4000);
+    }
+    if(durable) durable_hashtable_close(durable);
+    pass &= remove_dir_(dir) <= 2; //logs covered by a snapshot are removed
+    return pass;
+}
+
+bool undo_changes_that_fail_to_commit()
+{
+    bool pass = true;
+    char dir[] = "/tmp/durable_hashtable_XXXXXX";
+    pass &= mkdtemp(dir) != NULL;
+    durability_policy_t policy = durability_policy_default();
+    policy.mode = DURABILITY_SYNC;
+
+    durable_hashtable_t* durable = durable_hashtable_open(dir, policy);
+    pass &= durable_hashtable_insert(durable, (char*)"kept", 1).status == OK;
+
+    //a read only log makes every write of a commit fail
+    int log_fd = durable->log_fd;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/wal.%016llx", dir, (unsigned long long)durable->log_gen);
+    durable->log_fd = open(path, O_RDONLY);
+    pass &= durable_hashtable_insert(durable, (char*)"lost", 2).status == IO_ERROR;
+    pass &= durable_hashtable_put(durable, (char*)"kept", 3).status == IO_ERROR;
+    pass &= durable_hashtable_put(durable, (char*)"lost", 4).status == IO_ERROR;
+    pass &= durable_hashtable_delete(durable, (char*)"kept").status == IO_ERROR;
+    pass &= durable->io_failed;
+
+    cell_info_t lookup = hashtable_lookup(durable->table, (char*)"kept");
+    pass &= lookup.status == OK && lookup.cell->value == 1;
+    pass &= hashtable_lookup(durable->table, (char*)"lost").status == KEY_NOT_FOUND;
+    pass &= durable->table->size == 1;
+    close(durable->log_fd);
+    durable->log_fd = log_fd;
+    durable_hashtable_close(durable);
+
+    durable = durable_hashtable_open(dir, policy);
+    pass &= durable != NULL && durable->table->size == 1;
+    lookup = durable ? hashtable_lookup(durable->table, (char*)"kept") : lookup;
+    pass &= lookup.status == OK && lookup.cell->value == 1;
+    if(durable) durable_hashtable_close(durable);
+    remove_dir_(dir);
+    return pass;
+}
+
+//HASHSET TESTS (prefixed with hashset_should)
+bool keep_probe_chains_through_tombstones()
+{
+    bool pass = true;
+    char key[16];
+    hashset_t* set = hashset_init(64);
+    for(int i = 0; i < 40; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= hashset_insert(set, key) == OK;
+    }
+    pass &= hashset_insert(set, (char*)"key7") == DUPLICATE_KEY;
+
+    //deleting every other key must not hide the keys probed past them
+    for(int i = 0; i < 40; i += 2)
+    {
+        sprintf(key, "key%d", i);
+        pass &= hashset_delete(set, key) == OK;
+    }
+    pass &= hashset_delete(set, (char*)"key0") == KEY_NOT_FOUND;
+    pass &= set->size == 20;
+    for(int i = 0; i < 40; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= hashset_contains(set, key) == (i % 2 == 1);
+    }
+
+    //churn reuses tombstones and rehashes in place instead of growing
+    for(int round = 0; round < 20; round++)
+    {
+        for(int i = 100; i < 120; i++)
+        {
+            sprintf(key, "key%d", i);
+            pass &= hashset_insert(set, key) == OK;
+        }
+        for(int i = 100; i < 120; i++)
+        {
+            sprintf(key, "key%d", i);
+            pass &= hashset_delete(set, key) == OK;
+        }
+    }
+    pass &= set->capacity == 64 && set->size == 20;
+    for(int i = 1; i < 40; i += 2)
+    {
+        sprintf(key, "key%d", i);
+        pass &= hashset_contains(set, key);
+    }
+    hashset_cleanup(set);
+    return pass;
+}
+
+bool resize_and_squash_keys_only()
+{
+    bool pass = true;
+    char key[16];
+    hashset_t* set = hashset_init(1);
+    for(int i = 0; i < 1000; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= hashset_insert(set, key) == OK;
+    }
+    pass &= set->size == 1000 && set->capacity == 2048;
+
+    pass &= hashset_resize(set, 512) == 2048; //too small
+    pass &= hashset_resize(set, 3000) == 2048; //not a power of 2
+    pass &= hashset_insert_(set, (char*)"key1000", false, false) == OK;
+
+    hashset_t* copy = hashset_copy(set);
+    pass &= hashset_squash(set) == 1024;
+    for(int i = 0; i <= 1000; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= hashset_contains(set, key) && hashset_contains(copy, key);
+    }
+    pass &= hashset_insert_(set, (char*)"extra", false, false) == OK && set->size == 1002;
+
+    pass &= hashset_clear(copy) == 1001;
+    pass &= copy->size == 0 && !hashset_contains(copy, (char*)"key0");
+    char* moved = (char*)malloc(6);
+    strcpy(moved, "moved");
+    pass &= hashset_insert_(copy, moved, true, true) == OK && hashset_contains(copy, (char*)"moved");
+
+    hashset_cleanup(set);
+    hashset_cleanup(copy);
+    return pass;
+}
+
+bool build_set_algebra_from_either_side()
+{
+    bool pass = true;
+    char key[16];
+    hashset_t* small = hashset_init(1);
+    hashset_t* large = hashset_init(1);
+    for(int i = 0; i < 50; i++) //multiples of 3
+    {
+        sprintf(key, "key%d", i * 3);
+        hashset_insert(small, key);
+    }
+    for(int i = 0; i < 300; i += 2) //multiples of 2 (0..298)
+    {
+        sprintf(key, "key%d", i);
+        hashset_insert(large, key);
+    }
+    hashset_delete(large, (char*)"key0"); //leave a tombstone in an operand
+
+    hashset_t* sets[6] = {hashset_union(small, large), hashset_union(large, small),
+                          hashset_intersection(small, large), hashset_intersection(large, small),
+                          hashset_difference(small, large), hashset_difference(large, small)};
+    uint32_t sizes[6] = {0, 0, 0, 0, 0, 0};
+    for(int i = 0; i < 300; i++)
+    {
+        sprintf(key, "key%d", i);
+        bool in_small = i % 3 == 0 && i < 150;
+        bool in_large = i % 2 == 0 && i != 0;
+        bool expected[6] = {in_small || in_large, in_small || in_large, in_small && in_large,
+                            in_small && in_large, in_small && !in_large, in_large && !in_small};
+        for(int s = 0; s < 6; s++)
+        {
+            pass &= hashset_contains(sets[s], key) == expected[s];
+            sizes[s] += expected[s];
+        }
+    }
+    for(int s = 0; s < 6; s++)
+    {
+        pass &= sets[s]->size == sizes[s];
+        hashset_cleanup(sets[s]);
+    }
+    hashset_cleanup(small);
+    hashset_cleanup(large);
+    return pass;
+}
+
+//BUFFER HASHTABLE TESTS (prefixed with buffer_hashtable_should)
+bool keep_everything_inside_the_buffer()
+{
+    bool pass = true;
+    char key[16];
+    char buffer[8192];
+    pass &= buffer_hashtable_init(buffer, 64, 64) == NULL; //too small for the slots
+    pass &= buffer_hashtable_init(buffer, sizeof(buffer), 48) == NULL; //not a power of 2
+
+    buffer_hashtable_t* hashtable = buffer_hashtable_init(buffer + 1, sizeof(buffer) - 1, 256);
+    pass &= hashtable != NULL && (uintptr_t)hashtable % BUFFER_HASHTABLE_ALIGN == 0;
+    pass &= hashtable->keys + hashtable->keys_capacity == buffer + sizeof(buffer); //the rest is the key arena
+    for(int i = 0; i < 192; i++)
+    {
+        sprintf(key, "key%d", i);
+        value_info_t insertion = buffer_hashtable_insert(hashtable, key, i);
+        pass &= insertion.status == OK;
+        pass &= (char*)insertion.value > buffer && (char*)insertion.value < hashtable->keys;
+    }
+    pass &= buffer_hashtable_insert(hashtable, (char*)"key7", 0).status == DUPLICATE_KEY;
+
+    //deleting every other key must not hide the keys probed past them
+    for(int i = 0; i < 192; i += 2)
+    {
+        sprintf(key, "key%d", i);
+        pass &= buffer_hashtable_delete(hashtable, key).status == OK;
+    }
+    pass &= buffer_hashtable_delete(hashtable, (char*)"key0").status == KEY_NOT_FOUND;
+    for(int i = 0; i < 192; i++)
+    {
+        sprintf(key, "key%d", i);
+        value_info_t lookup = buffer_hashtable_lookup(hashtable, key);
+        pass &= i % 2 ? lookup.status == OK && *lookup.value == i : lookup.status == KEY_NOT_FOUND;
+    }
+    pass &= hashtable->size == 96;
+    return pass;
+}
+
+bool report_full_slots_and_key_arena()
+{
+    bool pass = true;
+    char key[16];
+    static char buffer[4096];
+
+    //every slot taken
+    buffer_hashtable_t* hashtable = buffer_hashtable_init(buffer, buffer_hashtable_size(16, 16 * 8), 16);
+    for(int i = 0; i < 16; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= buffer_hashtable_insert(hashtable, key, i).status == OK;
+    }
+    pass &= buffer_hashtable_insert(hashtable, (char*)"one_more", 0).status == HASHTABLE_FULL;
+    for(int i = 0; i < 16; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= buffer_hashtable_lookup(hashtable, key).status == OK;
+    }
+    pass &= buffer_hashtable_lookup(hashtable, (char*)"missing").status == KEY_NOT_FOUND;
+
+    //no room left in the key arena, though slots are free
+    hashtable = buffer_hashtable_init(buffer, buffer_hashtable_size(64, 10), 64);
+    pass &= hashtable->keys_capacity >= 10 && hashtable->keys_capacity < 10 + BUFFER_HASHTABLE_ALIGN;
+    pass &= buffer_hashtable_insert(hashtable, (char*)"abcd", 1).status == OK; //5 bytes
+    pass &= buffer_hashtable_insert(hashtable, (char*)"a_key_far_too_long_for_what_is_left", 2).status == HASHTABLE_FULL;
+    pass &= buffer_hashtable_lookup(hashtable, (char*)"a_key_far_too_long_for_what_is_left").status == KEY_NOT_FOUND;
+    pass &= hashtable->size == 1;
+    return pass;
+}
+
+bool reset_in_place_across_epochs()
+{
+    bool pass = true;
+    char key[16];
+    char buffer[4096];
+    buffer_hashtable_t* hashtable = buffer_hashtable_init(buffer, sizeof(buffer), 64);
+    size_t keys_capacity = hashtable->keys_capacity;
+
+    for(int round = 0; round < 100; round++)
+    {
+        for(int i = 0; i < 40; i++)
+        {
+            sprintf(key, "r%dk%d", round, i);
+            pass &= buffer_hashtable_insert(hashtable, key, round).status == OK;
+        }
+        sprintf(key, "r%dk0", round - 1);
+        pass &= buffer_hashtable_lookup(hashtable, key).status == KEY_NOT_FOUND; //previous round is gone
+        buffer_hashtable_delete(hashtable, (char*)"r0k1");
+        buffer_hashtable_reset(hashtable);
+        pass &= hashtable->size == 0 && hashtable->keys_used == 0 && hashtable->keys_capacity == keys_capacity;
+    }
+
+    //wrapping the epoch clears the slots so keys of epoch 1 don't come back
+    pass &= buffer_hashtable_insert(hashtable, (char*)"old", 1).status == OK;
+    hashtable->epoch = UINT32_MAX;
+    buffer_hashtable_reset(hashtable);
+    pass &= hashtable->epoch == 1;
+    pass &= buffer_hashtable_lookup(hashtable, (char*)"old").status == KEY_NOT_FOUND;
+    pass &= buffer_hashtable_insert(hashtable, (char*)"new", 2).status == OK;
+    pass &= *buffer_hashtable_lookup(hashtable, (char*)"new").value == 2;
+    return pass;
+}
+
+//HOT CACHE TESTS (prefixed with hashtable_hot_cache_should)
+bool serve_repeated_lookups_from_the_cache()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* hashtable = hashtable_init(1);
+    hashtable_enable_hot_cache(hashtable, 100);
+    pass &= hashtable->hot_cache->num_entries == 128;
+    for(int i = 0; i < 1000; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(hashtable, key, i);
+    }
+
+    cell_info_t first = hashtable_lookup(hashtable, (char*)"key5");
+    cell_info_t second = hashtable_lookup(hashtable, (char*)"key5");
+    pass &= first.status == OK && second.status == OK && first.cell == second.cell && second.cell->value == 5;
+    pass &= hashtable->hot_cache->hits == 1 && hashtable->hot_cache->misses == 1;
+    pass &= hashtable_lookup(hashtable, (char*)"missing").status == KEY_NOT_FOUND;
+    pass &= hashtable_lookup(hashtable, (char*)"key").status == KEY_NOT_FOUND; //prefix of cached keys
+
+    //every key comes out right whether or not its entry was taken by another key
+    for(int round = 0; round < 2; round++)
+    {
+        for(int i = 0; i < 1000; i++)
+        {
+            sprintf(key, "key%d", i);
+            cell_info_t lookup = hashtable_lookup(hashtable, key);
+            pass &= lookup.status == OK && lookup.cell->value == i;
+        }
+    }
+    pass &= hashtable->hot_cache->hits > 0;
+
+    //a copy starts with an empty cache of its own
+    hashtable_t* copy = hashtable_copy(hashtable);
+    pass &= copy->hot_cache && copy->hot_cache != hashtable->hot_cache && copy->hot_cache->hits == 0;
+    pass &= hashtable_lookup(copy, (char*)"key5").cell == &copy->data[hashtable_lookup(hashtable, (char*)"key5").cell - hashtable->data];
+    hashtable_cleanup(copy);
+
+    hashtable_disable_hot_cache(hashtable);
+    pass &= hashtable->hot_cache == NULL && hashtable_lookup(hashtable, (char*)"key5").cell->value == 5;
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool stay_coherent_through_updates()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* hashtable = hashtable_init(16);
+    hashtable_enable_hot_cache(hashtable, 64);
+
+    //delete and insert again, possibly in another slot
+    hashtable_insert(hashtable, (char*)"hot", 1);
+    hashtable_lookup(hashtable, (char*)"hot");
+    pass &= hashtable_delete(hashtable, (char*)"hot").status == OK;
+    pass &= hashtable_lookup(hashtable, (char*)"hot").status == KEY_NOT_FOUND;
+    hashtable_insert(hashtable, (char*)"hot", 2);
+    pass &= hashtable_lookup(hashtable, (char*)"hot").cell->value == 2;
+
+    //resize moves every key
+    for(int i = 0; i < 200; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(hashtable, key, i);
+    }
+    cell_info_t lookup = hashtable_lookup(hashtable, (char*)"hot");
+    pass &= lookup.status == OK && lookup.cell->value == 2 && lookup.cell == hashtable_lookup(hashtable, (char*)"hot").cell;
+
+    //merged away keys leave stale entries behind, which must not be served
+    hashtable_t* dest = hashtable_init(512);
+    pass &= !hashtable_merge_parallel(dest, &hashtable, 1, NULL, 2);
+    pass &= hashtable_lookup(hashtable, (char*)"hot").status == KEY_NOT_FOUND;
+    pass &= hashtable_lookup(dest, (char*)"hot").cell->value == 2;
+
+    hashtable_insert(hashtable, (char*)"hot", 3);
+    hashtable_lookup(hashtable, (char*)"hot");
+    hashtable_clear(hashtable);
+    pass &= hashtable_lookup(hashtable, (char*)"hot").status == KEY_NOT_FOUND;
+
+    //cached keys still expire
+    fake_now = 1000;
+    hashtable_enable_expiry(hashtable, fake_clock);
+    hashtable_insert_ttl(hashtable, (char*)"hot", 4, 10);
+    pass &= hashtable_lookup(hashtable, (char*)"hot").status == OK;
+    pass &= hashtable_lookup(hashtable, (char*)"hot").status == OK;
+    fake_now += 10;
+    pass &= hashtable_lookup(hashtable, (char*)"hot").status == KEY_NOT_FOUND;
+    pass &= hashtable->size == 0;
+
+    hashtable_cleanup(dest);
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+//CUCKOO HASHTABLE TESTS (prefixed with cuckoo_hashtable_should)
+bool fill_past_quadratic_probing_loads()
+{
+    bool pass = true;
+    char key[16];
+    cuckoo_hashtable_t* hashtable = cuckoo_hashtable_init(4096);
+    pass &= cuckoo_hashtable_init(48) == NULL;
+    pass &= hashtable->num_buckets == 1024 && (uintptr_t)hashtable->buckets % 64 == 0;
+
+    //0.95 load without ever resizing, which means keys were moved to make room
+    int target = (int)(4096 * CUCKOO_MAX_LOAD_FACTOR);
+    for(int i = 0; i < target; i++)
+    {
+        sprintf(key, "key%d", i);
+        value_info_t insertion = cuckoo_hashtable_insert_(hashtable, key, i, false);
+        pass &= insertion.status == OK && *insertion.value == i;
+    }
+    pass &= hashtable->capacity == 4096 && hashtable->size == (uint32_t)target;
+    pass &= cuckoo_hashtable_insert(hashtable, (char*)"key7", 0).status == DUPLICATE_KEY;
+
+    //every key found, next to its stored second hash (FNV-1a)
+    for(int i = 0; i < target; i++)
+    {
+        sprintf(key, "key%d", i);
+        value_info_t lookup = cuckoo_hashtable_lookup(hashtable, key);
+        pass &= lookup.status == OK && *lookup.value == i;
+        cuckoo_bucket_t* bucket = (cuckoo_bucket_t*)((uintptr_t)lookup.value & ~(uintptr_t)63);
+        uint32_t idx = (uint32_t)(bucket - hashtable->buckets);
+        uint32_t fnv = 2166136261u;
+        for(char* c = key; *c; c++) fnv = (fnv ^ (uint8_t)*c) * 16777619u;
+        pass &= bucket->hashes[lookup.value - bucket->values] == fnv && idx < hashtable->num_buckets;
+    }
+    pass &= cuckoo_hashtable_lookup(hashtable, (char*)"missing").status == KEY_NOT_FOUND;
+
+    //a single bucket holds 4 keys and no more
+    cuckoo_hashtable_t* tiny = cuckoo_hashtable_init(1);
+    for(int i = 0; i < 4; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= cuckoo_hashtable_insert_(tiny, key, i, false).status == OK;
+    }
+    pass &= cuckoo_hashtable_insert_(tiny, (char*)"key4", 4, false).status == HASHTABLE_FULL;
+    pass &= tiny->size == 4;
+
+    cuckoo_hashtable_cleanup(tiny);
+    cuckoo_hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool grow_and_delete_without_tombstones()
+{
+    bool pass = true;
+    char key[16];
+    cuckoo_hashtable_t* hashtable = cuckoo_hashtable_init(1);
+    for(int i = 0; i < 5000; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= cuckoo_hashtable_insert(hashtable, key, i).status == OK;
+    }
+    pass &= hashtable->size == 5000 && (double)hashtable->size / hashtable->capacity <= CUCKOO_MAX_LOAD_FACTOR;
+
+    for(int i = 0; i < 5000; i += 2)
+    {
+        sprintf(key, "key%d", i);
+        pass &= cuckoo_hashtable_delete(hashtable, key).status == OK;
+    }
+    pass &= cuckoo_hashtable_delete(hashtable, (char*)"key0").status == KEY_NOT_FOUND;
+    for(int i = 0; i < 5000; i++)
+    {
+        sprintf(key, "key%d", i);
+        value_info_t lookup = cuckoo_hashtable_lookup(hashtable, key);
+        pass &= i % 2 ? lookup.status == OK && *lookup.value == i : lookup.status == KEY_NOT_FOUND;
+    }
+
+    pass &= cuckoo_hashtable_resize(hashtable, 3000) == hashtable->capacity; //not a power of 2
+    pass &= cuckoo_hashtable_resize(hashtable, 1024) == hashtable->capacity; //too small
+    pass &= cuckoo_hashtable_resize(hashtable, 4096) == 4096;
+    for(int i = 1; i < 5000; i += 2)
+    {
+        sprintf(key, "key%d", i);
+        pass &= *cuckoo_hashtable_lookup(hashtable, key).value == i;
+    }
+
+    pass &= cuckoo_hashtable_clear(hashtable) == 2500;
+    pass &= cuckoo_hashtable_lookup(hashtable, (char*)"key1").status == KEY_NOT_FOUND;
+    cuckoo_hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool spread_keys_colliding_on_hash()
+{
+    bool pass = true;
+    //"Aa" and "B@" hash the same, and so does every key made of 4 of them
+    char keys[16][9];
+    for(int k = 0; k < 16; k++)
+    {
+        for(int pair = 0; pair < 4; pair++) memcpy(keys[k] + 2 * pair, k >> pair & 1 ? "B@" : "Aa", 2);
+        keys[k][8] = '\0';
+    }
+    pass &= hash(keys[0]) == hash(keys[15]);
+
+    //past 8 keys both buckets would be full if they came from hash() alone
+    cuckoo_hashtable_t* hashtable = cuckoo_hashtable_init(64);
+    for(int k = 0; k < 16; k++) pass &= cuckoo_hashtable_insert(hashtable, keys[k], k).status == OK;
+    pass &= hashtable->size == 16 && hashtable->capacity <= 128;
+    for(int k = 0; k < 16; k++)
+    {
+        value_info_t lookup = cuckoo_hashtable_lookup(hashtable, keys[k]);
+        pass &= lookup.status == OK && *lookup.value == k;
+    }
+    pass &= cuckoo_hashtable_resize(hashtable, 32) == 32 && hashtable->size == 16;
+    pass &= cuckoo_hashtable_delete(hashtable, keys[3]).status == OK;
+    pass &= cuckoo_hashtable_lookup(hashtable, keys[3]).status == KEY_NOT_FOUND;
+    pass &= cuckoo_hashtable_lookup(hashtable, keys[12]).status == OK;
+    cuckoo_hashtable_cleanup(hashtable);
+    return pass;
+}
+
+//COW HASHTABLE TESTS (prefixed with cow_hashtable_should)
+static void sum_values_(const char* key, value_type value, void* arg) //adds every value up
+{
+    *(long*)arg += value;
+}
+
+bool keep_snapshots_unchanged_by_writes()
+{
+    bool pass = true;
+    char key[16];
+    cow_hashtable_t* hashtable = cow_hashtable_init(1);
+    for(int i = 0; i < 1000; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= cow_hashtable_insert(hashtable, key, i) == OK;
+    }
+    pass &= cow_hashtable_insert(hashtable, (char*)"key7", 0) == DUPLICATE_KEY;
+
+    cow_hashtable_t* snapshot = cow_hashtable_snapshot(hashtable);
+    pass &= cow_hashtable_shared_pages(hashtable) == hashtable->num_pages;
+
+    //overwrite, delete and insert in the original, then in the snapshot itself
+    for(int i = 0; i < 1000; i += 2)
+    {
+        sprintf(key, "key%d", i);
+        pass &= cow_hashtable_put(hashtable, key, -i) == OK;
+    }
+    for(int i = 1; i < 1000; i += 4)
+    {
+        sprintf(key, "key%d", i);
+        pass &= cow_hashtable_delete(hashtable, key) == OK;
+    }
+    pass &= cow_hashtable_delete(hashtable, (char*)"key1") == KEY_NOT_FOUND;
+    pass &= cow_hashtable_insert(hashtable, (char*)"new", 1) == OK;
+    pass &= cow_hashtable_put(snapshot, (char*)"snapshot only", 2) == OK;
+
+    for(int i = 0; i < 1000; i++)
+    {
+        sprintf(key, "key%d", i);
+        value_info_t original = cow_hashtable_lookup(hashtable, key);
+        value_info_t snapshotted = cow_hashtable_lookup(snapshot, key);
+        pass &= snapshotted.status == OK && *snapshotted.value == i;
+        if(i % 4 == 1) pass &= original.status == KEY_NOT_FOUND;
+        else pass &= original.status == OK && *original.value == (i % 2 ? i : -i);
+    }
+    pass &= cow_hashtable_lookup(snapshot, (char*)"new").status == KEY_NOT_FOUND;
+    pass &= cow_hashtable_lookup(hashtable, (char*)"snapshot only").status == KEY_NOT_FOUND;
+
+    long sum = 0;
+    pass &= cow_hashtable_for_each(snapshot, sum_values_, &sum) == 1001;
+    pass &= sum == 999 * 1000 / 2 + 2;
+
+    cow_hashtable_cleanup(hashtable);
+    //the snapshot outlives the original, and still holds every key
+    pass &= cow_hashtable_lookup(snapshot, (char*)"key999").status == OK;
+    cow_hashtable_cleanup(snapshot);
+    return pass;
+}
+
+bool only_clone_pages_that_are_written()
+{
+    bool pass = true;
+    char key[16];
+    cow_hashtable_t* hashtable = cow_hashtable_init(COW_PAGE_SLOTS * 16);
+    for(int i = 0; i < COW_PAGE_SLOTS * 8; i++)
+    {
+        sprintf(key, "key%d", i);
+        cow_hashtable_insert(hashtable, key, i);
+    }
+    pass &= hashtable->num_pages == 16;
+
+    cow_hashtable_t* snapshot = cow_hashtable_snapshot(hashtable);
+    pass &= cow_hashtable_put(hashtable, (char*)"key3", 30) == OK;
+    pass &= cow_hashtable_shared_pages(hashtable) == 15 && cow_hashtable_shared_pages(snapshot) == 15;
+    pass &= cow_hashtable_put(hashtable, (char*)"key3", 300) == OK; //the page is already its own
+    pass &= cow_hashtable_shared_pages(hashtable) == 15;
+
+    //a resize moves every key to new pages, which leaves the snapshot sole owner of the old ones
+    cow_hashtable_resize(hashtable, COW_PAGE_SLOTS * 32);
+    pass &= cow_hashtable_shared_pages(hashtable) == 0 && cow_hashtable_shared_pages(snapshot) == 0;
+    pass &= *cow_hashtable_lookup(hashtable, (char*)"key3").value == 300;
+    pass &= *cow_hashtable_lookup(snapshot, (char*)"key3").value == 3;
+
+    //taking another snapshot and dropping it leaves pages unshared again
+    cow_hashtable_cleanup(cow_hashtable_snapshot(hashtable));
+    pass &= cow_hashtable_shared_pages(hashtable) == 0;
+
+    cow_hashtable_cleanup(snapshot);
+    cow_hashtable_cleanup(hashtable);
+    return pass;
+}
+
+static void* read_snapshot_(void* arg) //sums the values of a snapshot, then cleans it up
+{
+    cow_hashtable_t* snapshot = (cow_hashtable_t*)arg;
+    long* sum = (long*)malloc(sizeof(long));
+    *sum = 0;
+    for(int round = 0; round < 20; round++) cow_hashtable_for_each(snapshot, sum_values_, sum);
+    cow_hashtable_cleanup(snapshot);
+    return sum;
+}
+
+bool release_snapshots_from_another_thread()
+{
+    bool pass = true;
+    char key[16];
+    cow_hashtable_t* hashtable = cow_hashtable_init(1);
+    for(int i = 0; i < 2000; i++)
+    {
+        sprintf(key, "key%d", i);
+        cow_hashtable_insert(hashtable, key, 1);
+    }
+
+    pthread_t reader;
+    pthread_create(&reader, NULL, read_snapshot_, cow_hashtable_snapshot(hashtable));
+    for(int i = 0; i < 4000; i++)
+    {
+        sprintf(key, "key%d", i);
+        if(i % 3 == 0) cow_hashtable_delete(hashtable, key);
+        else cow_hashtable_put(hashtable, key, 2);
+    }
+
+    long* sum;
+    pthread_join(reader, (void**)&sum);
+    pass &= *sum == 20 * 2000;
+    free(sum);
+    pass &= hashtable->size == 4000 - 1334;
+    cow_hashtable_cleanup(hashtable);
+    return pass;
+}
+
+//ITERATION TESTS (prefixed with hashtable_iteration_should)
+static void count_cell_(cell_t* cell, void* ctx) //sums the values of the visited cells into ctx
+{
+    *(long*)ctx += cell->value;
+}
+
+bool visit_every_key_once_with_a_cursor()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* hashtable = hashtable_init(1024);
+    for(int i = 0; i < 500; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(hashtable, key, i);
+    }
+
+    //values of the keys present for the whole walk are seen exactly once, whatever else happens
+    int seen[500] = {0};
+    int visited = 0;
+    hashtable_cursor_t cursor = hashtable_cursor(hashtable);
+    cell_t* cell;
+    while((cell = hashtable_next(hashtable, &cursor)) != NULL)
+    {
+        if(cell->value < 500) seen[cell->value]++;
+        visited++;
+        if(visited % 2 == 0)
+        {
+            sprintf(key, "new%d", visited);
+            hashtable_insert_(hashtable, key, 1000 + visited, /*resize*/ false, /*move*/ false);
+        }
+        //deleting the cell just returned doesn't disturb the walk either
+        if(visited == 100) hashtable_delete(hashtable, cell->key);
+    }
+    for(int i = 0; i < 500; i++) pass &= seen[i] == 1;
+    pass &= cursor.restarts == 0 && hashtable_next(hashtable, &cursor) == NULL;
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool restart_cursors_after_a_resize()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* hashtable = hashtable_init(64);
+    for(int i = 0; i < 40; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(hashtable, key, i);
+    }
+
+    int seen[40] = {0};
+    hashtable_cursor_t cursor = hashtable_cursor(hashtable);
+    for(int i = 0; i < 10; i++) seen[hashtable_next(hashtable, &cursor)->value]++;
+    hashtable_resize(hashtable, 256);
+
+    cell_t* cell;
+    while((cell = hashtable_next(hashtable, &cursor)) != NULL) seen[cell->value]++;
+    pass &= cursor.restarts == 1;
+    int total = 0;
+    for(int i = 0; i < 40; i++)
+    {
+        pass &= seen[i] >= 1;
+        total += seen[i];
+    }
+    pass &= total == 50;
+
+    //expired keys are skipped
+    hashtable_enable_expiry(hashtable, fake_clock);
+    fake_now = 1000;
+    hashtable_set_ttl(hashtable, (char*)"key7", 10);
+    fake_now = 2000;
+    int visited = 0;
+    cursor = hashtable_cursor(hashtable);
+    while((cell = hashtable_next(hashtable, &cursor)) != NULL) visited++;
+    pass &= visited == 39;
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool split_scans_into_independent_ranges()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* hashtable = hashtable_init(1);
+    long expected = 0;
+    for(int i = 0; i < 5000; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(hashtable, key, i);
+        expected += i;
+    }
+
+    //ranges in any split cover every cell once, past the end is clamped
+    long sum = 0;
+    uint32_t visited = 0;
+    for(uint32_t begin = 0; begin < hashtable->capacity; begin += 1000) visited += hashtable_for_each_range(hashtable, begin, begin + 1000, count_cell_, &sum);
+    pass &= visited == 5000 && sum == expected;
+    pass &= hashtable_for_each_range(hashtable, 10, 10, count_cell_, &sum) == 0;
+
+    long sums[5] = {0};
+    void* ctxs[5] = {&sums[0], &sums[1], &sums[2], &sums[3], &sums[4]};
+    pass &= hashtable_for_each_parallel(hashtable, count_cell_, ctxs, 5) == 5000;
+    pass &= sums[0] + sums[1] + sums[2] + sums[3] + sums[4] == expected;
+    for(int t = 0; t < 5; t++) pass &= sums[t] > 0;
+
+    //more threads than slots
+    hashtable_t* tiny = hashtable_init(2);
+    hashtable_insert(tiny, (char*)"a", 3);
+    long tiny_sums[8] = {0};
+    void* tiny_ctxs[8];
+    for(int t = 0; t < 8; t++) tiny_ctxs[t] = &tiny_sums[t];
+    pass &= hashtable_for_each_parallel(tiny, count_cell_, tiny_ctxs, 8) == 1;
+    pass &= tiny_sums[0] + tiny_sums[1] == 3;
+    hashtable_cleanup(tiny);
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+//VALUE TESTS (prefixed with hashtable_values_should)
+bool copy_values_only_when_duplicated()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* hashtable = hashtable_init(1);
+    unsigned long copies = test_value_copies;
+    for(int i = 0; i < 200; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(hashtable, key, i);
+    }
+    pass &= test_value_copies - copies == 200;
+    pass &= hashtable_insert(hashtable, (char*)"key5", 0).status == DUPLICATE_KEY && test_value_copies - copies == 200;
+
+    //moved values are taken over as they are
+    char* moved_key = (char*)malloc(8);
+    strcpy(moved_key, "moved");
+    hashtable_insert_(hashtable, moved_key, 7, /*resize*/ true, /*move*/ true);
+    pass &= test_value_copies - copies == 200;
+
+    //resizing and squashing relocate values
+    hashtable_resize(hashtable, 4096);
+    hashtable_squash(hashtable);
+    hashtable_resize(hashtable, 2048);
+    pass &= test_value_copies - copies == 200;
+
+    hashtable_t* copy = hashtable_copy(hashtable);
+    pass &= test_value_copies - copies == 401;
+    hashtable_t* merged = hashtable_init(16);
+    hashtable_merge(merged, copy);
+    pass &= test_value_copies - copies == 602 && hashtable_lookup(merged, (char*)"moved").cell->value == 7;
+
+    hashtable_cleanup(merged);
+    hashtable_cleanup(copy);
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool destroy_values_only_when_dropped()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* hashtable = hashtable_init(256);
+    hashtable_enable_expiry(hashtable, fake_clock);
+    for(int i = 0; i < 100; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(hashtable, key, i);
+    }
+    unsigned long destroys = test_value_destroys;
+    hashtable_resize(hashtable, 1024);
+    pass &= test_value_destroys == destroys;
+
+    for(int i = 0; i < 10; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_delete(hashtable, key);
+    }
+    pass &= test_value_destroys - destroys == 10;
+    fake_now = 1000;
+    hashtable_set_ttl(hashtable, (char*)"key50", 1);
+    fake_now = 2000;
+    pass &= hashtable_lookup(hashtable, (char*)"key50").status == KEY_NOT_FOUND;
+    pass &= test_value_destroys - destroys == 11;
+
+    //keys merged in parallel move their values, conflicting ones are dropped
+    hashtable_t* src = hashtable_init(64);
+    hashtable_insert(src, (char*)"key20", 1);
+    hashtable_insert(src, (char*)"other", 1);
+    hashtable_t* srcs[1] = {src};
+    hashtable_merge_parallel(hashtable, srcs, 1, NULL, 2);
+    pass &= test_value_destroys - destroys == 12;
+
+    pass &= hashtable_clear(hashtable) == 90 && test_value_destroys - destroys == 102;
+    hashtable_insert(hashtable, (char*)"last", 1);
+    hashtable_cleanup(hashtable);
+    hashtable_cleanup(src);
+    pass &= test_value_destroys - destroys == 103;
+    return pass;
+}
+
+bool manage_values_in_every_layout()
+{
+    bool pass = true;
+    char key[16];
+    unsigned long copies = test_value_copies;
+    unsigned long destroys = test_value_destroys;
+
+    //each layout copies 50 values in, relocates them without copies, then drops them all
+    cuckoo_hashtable_t* cuckoo = cuckoo_hashtable_init(4);
+    compact_hashtable_t* compact = compact_hashtable_init(4);
+    u64_hashtable_t* ints = u64_hashtable_init(4);
+    hashcache_t* cache = hashcache_init(64, NULL, NULL);
+    for(int i = 0; i < 50; i++)
+    {
+        sprintf(key, "key%d", i);
+        cuckoo_hashtable_insert(cuckoo, key, i);
+        compact_hashtable_insert(compact, key, i);
+        u64_hashtable_insert(ints, i, i);
+        hashcache_insert(cache, key, i);
+    }
+    pass &= cuckoo_hashtable_insert(cuckoo, (char*)"key1", 0).status == DUPLICATE_KEY;
+    pass &= u64_hashtable_insert(ints, 0, 0).status == DUPLICATE_KEY;
+    cuckoo_hashtable_resize(cuckoo, 1024);
+    compact_hashtable_resize(compact, 1024);
+    u64_hashtable_resize(ints, 1024);
+    pass &= test_value_copies - copies == 200 && test_value_destroys == destroys;
+
+    cuckoo_hashtable_delete(cuckoo, (char*)"key3");
+    compact_hashtable_delete(compact, (char*)"key3");
+    u64_hashtable_delete(ints, 0);
+    hashcache_delete(cache, (char*)"key3");
+    pass &= test_value_destroys - destroys == 4;
+
+    cuckoo_hashtable_cleanup(cuckoo);
+    compact_hashtable_cleanup(compact);
+    u64_hashtable_cleanup(ints);
+    hashcache_cleanup(cache);
+    pass &= test_value_copies - copies == 200 && test_value_destroys - destroys == 200;
+    return pass;
+}
+
+//DUMP TESTS (prefixed with hashtable_dump_should)
+bool restore_every_key_on_several_threads()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* hashtable = hashtable_init(1);
+    for(int i = 0; i < 5000; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(hashtable, key, i);
+    }
+    //expired keys are left out
+    hashtable_enable_expiry(hashtable, fake_clock);
+    fake_now = 1000;
+    hashtable_set_ttl(hashtable, (char*)"key42", 1);
+    fake_now = 2000;
+
+    char path[] = "/tmp/hashtable_dump_XXXXXX";
+    int fd = mkstemp(path);
+    close(fd);
+    pass &= hashtable_dump(hashtable, path, 16);
+
+    for(uint32_t num_threads = 1; num_threads <= 8; num_threads <<= 1)
+    {
+        hashtable_t* loaded = hashtable_load(path, num_threads);
+        pass &= loaded != NULL;
+        if(loaded == NULL) continue;
+        pass &= loaded->size == 4999 && loaded->capacity == hashtable->capacity;
+        for(int i = 0; i < 5000; i++)
+        {
+            sprintf(key, "key%d", i);
+            cell_info_t lookup = hashtable_lookup(loaded, key);
+            pass &= i == 42 ? lookup.status == KEY_NOT_FOUND : lookup.status == OK && lookup.cell->value == i;
+        }
+        hashtable_cleanup(loaded);
+    }
+
+    //an empty table, with more chunks than slots
+    hashtable_t* empty = hashtable_init(4);
+    pass &= hashtable_dump(empty, path, 64);
+    hashtable_t* loaded = hashtable_load(path, 4);
+    pass &= loaded != NULL && loaded->size == 0 && loaded->capacity == 4;
+    if(loaded) hashtable_cleanup(loaded);
+    hashtable_cleanup(empty);
+    unlink(path);
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool reject_corrupted_dumps()
+{
+    bool pass = true;
+    char key[16];
+    hashtable_t* hashtable = hashtable_init(256);
+    for(int i = 0; i < 100; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(hashtable, key, i);
+    }
+    char path[] = "/tmp/hashtable_dump_XXXXXX";
+    int fd = mkstemp(path);
+    close(fd);
+    pass &= hashtable_dump(hashtable, path, 4);
+    pass &= hashtable_load((char*)"/tmp/no/such/dump", 2) == NULL;
+
+    //flip a byte of the last record
+    struct stat file_stat;
+    stat(path, &file_stat);
+    fd = open(path, O_RDWR);
+    char byte;
+    pass &= pread(fd, &byte, 1, file_stat.st_size - 1) == 1;
+    byte ^= 1;
+    pass &= pwrite(fd, &byte, 1, file_stat.st_size - 1) == 1;
+    pass &= hashtable_load(path, 2) == NULL;
+
+    //or lose the end of the file
+    byte ^= 1;
+    pass &= pwrite(fd, &byte, 1, file_stat.st_size - 1) == 1;
+    hashtable_t* loaded = hashtable_load(path, 2);
+    pass &= loaded != NULL && loaded->size == 100;
+    if(loaded) hashtable_cleanup(loaded);
+
+    //the header and directory are checked before anything is allocated
+    dump_header_t header;
+    pass &= pread(fd, &header, sizeof(header), 0) == sizeof(header);
+    header.capacity <<= 8;
+    pass &= pwrite(fd, &header, sizeof(header), 0) == sizeof(header);
+    pass &= hashtable_load(path, 2) == NULL;
+    header.capacity >>= 8;
+    pass &= pwrite(fd, &header, sizeof(header), 0) == sizeof(header);
+    dump_chunk_t chunk;
+    pass &= pread(fd, &chunk, sizeof(chunk), sizeof(header)) == sizeof(chunk);
+    chunk.num_keys++;
+    pass &= pwrite(fd, &chunk, sizeof(chunk), sizeof(header)) == sizeof(chunk);
+    pass &= hashtable_load(path, 2) == NULL;
+    chunk.num_keys--;
+    pass &= pwrite(fd, &chunk, sizeof(chunk), sizeof(header)) == sizeof(chunk);
+    loaded = hashtable_load(path, 2);
+    pass &= loaded != NULL && loaded->size == 100;
+    if(loaded) hashtable_cleanup(loaded);
+
+    pass &= ftruncate(fd, file_stat.st_size - 3) == 0;
+    pass &= hashtable_load(path, 2) == NULL;
+    close(fd);
+
+    //squashed hashtables are fuller than the max load factor, so they load into twice the capacity
+    hashtable_squash(hashtable);
+    pass &= hashtable->capacity == 128 && hashtable_dump(hashtable, path, 4);
+    loaded = hashtable_load(path, 2);
+    pass &= loaded != NULL && loaded->capacity == 256 && loaded->size == 100;
+    pass &= loaded != NULL && hashtable_lookup(loaded, (char*)"key42").cell->value == 42;
+    if(loaded) hashtable_cleanup(loaded);
+    unlink(path);
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+//KEY CACHE TESTS (prefixed with hashtable_key_cache_should)
+bool reuse_key_buffers_through_churn()
+{
+    bool pass = true;
+    char key[32];
+    hashtable_t* hashtable = hashtable_init(256);
+    hashtable_enable_expiry(hashtable, fake_clock); //tombstones keep chains whole through deletes
+    hashtable_enable_key_cache(hashtable, 1 << 20);
+    for(int i = 0; i < 100; i++)
+    {
+        sprintf(key, "key%03d", i);
+        hashtable_insert(hashtable, key, i);
+    }
+    pass &= hashtable->key_cache->allocated == 100 && hashtable->key_cache->reused == 0;
+
+    //keys of the same class get the buffers of deleted keys
+    for(int round = 0; round < 3; round++)
+    {
+        for(int i = 0; i < 50; i++)
+        {
+            sprintf(key, "key%03d", i);
+            pass &= hashtable_delete(hashtable, key).status == OK;
+        }
+        pass &= hashtable->key_cache->bytes >= 50 * 16;
+        for(int i = 0; i < 50; i++)
+        {
+            sprintf(key, "key%03d", i);
+            pass &= hashtable_insert(hashtable, key, i).status == OK;
+        }
+    }
+    pass &= hashtable->key_cache->allocated == 100 && hashtable->key_cache->reused == 150;
+    pass &= hashtable->key_cache->bytes == 0;
+
+    //a longer key needs a buffer of a larger class, moved in keys are recycled too
+    pass &= hashtable_delete(hashtable, (char*)"key099").status == OK;
+    hashtable_insert(hashtable, (char*)"a key that needs a larger buffer", 0);
+    pass &= hashtable->key_cache->allocated == 101;
+    char* moved_key = (char*)malloc(4);
+    strcpy(moved_key, "abc");
+    hashtable_insert_(hashtable, moved_key, 1, /*resize*/ true, /*move*/ true);
+    hashtable_delete(hashtable, moved_key);
+    hashtable_insert(hashtable, (char*)"key099", 99);
+    pass &= hashtable->key_cache->reused == 151;
+    for(int i = 0; i < 100; i++)
+    {
+        sprintf(key, "key%03d", i);
+        cell_info_t lookup = hashtable_lookup(hashtable, key);
+        pass &= lookup.status == OK && lookup.cell->value == i;
+    }
+
+    //clear keeps every buffer
+    uint32_t size = hashtable->size;
+    hashtable_clear(hashtable);
+    pass &= hashtable->key_cache->bytes >= size * 16;
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool bound_and_trim_kept_buffers()
+{
+    bool pass = true;
+    char key[32];
+    hashtable_t* hashtable = hashtable_init(1024);
+    hashtable_enable_key_cache(hashtable, 1000);
+    for(int i = 0; i < 500; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(hashtable, key, i);
+    }
+    //past the limit, freed buffers go back to the system
+    hashtable_clear(hashtable);
+    pass &= hashtable->key_cache->bytes > 0 && hashtable->key_cache->bytes <= 1000;
+
+    hashtable_t* copy = hashtable_copy(hashtable);
+    pass &= copy->key_cache && copy->key_cache != hashtable->key_cache && copy->key_cache->max_bytes == 1000;
+    hashtable_cleanup(copy);
+
+    size_t kept = hashtable->key_cache->bytes;
+    pass &= hashtable_trim(hashtable) == kept && hashtable->key_cache->bytes == 0;
+    pass &= hashtable_trim(hashtable) == 0;
+    hashtable_insert(hashtable, (char*)"key", 0);
+    pass &= hashtable->key_cache->reused == 0;
+    hashtable_disable_key_cache(hashtable);
+    pass &= hashtable->key_cache == NULL && hashtable_lookup(hashtable, (char*)"key").status == OK;
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+//DIAGNOSTICS TESTS (prefixed with hashtable_diagnostics_should)
+static void colliding_keys_(uint32_t capacity, char* first, char* second) //finds 2 keys with the same home slot
+{
+    char key[8];
+    uint32_t homes[256];
+    for(int i = 0; i < 256; i++)
+    {
+        sprintf(key, "k%d", i);
+        homes[i] = mod(hash(key), capacity);
+        for(int j = 0; j < i; j++)
+        {
+            if(homes[j] != homes[i]) continue;
+            sprintf(first, "k%d", j);
+            strcpy(second, key);
+            return;
+        }
+    }
+}
+
+bool report_probes_and_clusters()
+{
+    bool pass = true;
+    char first[8], second[8];
+    colliding_keys_(64, first, second);
+    hashtable_t* hashtable = hashtable_init(64);
+    hashtable_insert(hashtable, first, 1);
+    hashtable_insert(hashtable, second, 2);
+
+    //the second key sits one probe further down the chain the two share
+    hashtable_diagnostics_t diagnostics = hashtable_diagnose(hashtable);
+    pass &= diagnostics.size == 2 && diagnostics.capacity == 64 && diagnostics.unreachable == 0;
+    pass &= diagnostics.shared_homes == 1 && diagnostics.max_shared_home == 2;
+    pass &= diagnostics.home_counts[0] == 63 && diagnostics.home_counts[2] == 1;
+    pass &= diagnostics.max_probes == 2 && diagnostics.avg_probes == 1.5;
+    pass &= diagnostics.clusters >= 1 && diagnostics.max_cluster <= 2;
+    pass &= diagnostics.chi_squared_bins == 0; //too few keys
+    hashtable_cleanup(hashtable);
+
+    char key[16];
+    hashtable = hashtable_init(4096);
+    for(int i = 0; i < 3000; i++)
+    {
+        sprintf(key, "key%d", i);
+        hashtable_insert(hashtable, key, i);
+    }
+    diagnostics = hashtable_diagnose(hashtable);
+    uint32_t slots = 0;
+    for(int c = 0; c < DIAGNOSTICS_HOME_COUNTS; c++) slots += diagnostics.home_counts[c];
+    pass &= slots == 4096 && diagnostics.unreachable == 0 && diagnostics.avg_probes >= 1;
+    pass &= diagnostics.chi_squared_bins == 512 && diagnostics.chi_squared > 0;
+
+    //projections start from the smallest capacity the keys fit, and get cheaper as it grows
+    pass &= diagnostics.num_projections == DIAGNOSTICS_PROJECTIONS && diagnostics.projections[0].capacity == 4096;
+    for(uint32_t p = 1; p < diagnostics.num_projections; p++)
+    {
+        pass &= diagnostics.projections[p].capacity == diagnostics.projections[p - 1].capacity * 2;
+        pass &= diagnostics.projections[p].hit_probes <= diagnostics.projections[p - 1].hit_probes;
+        pass &= diagnostics.projections[p].miss_probes <= diagnostics.projections[p - 1].miss_probes;
+    }
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+bool find_keys_cut_off_by_deletes()
+{
+    bool pass = true;
+    char first[8], second[8];
+    colliding_keys_(64, first, second);
+
+    //without expiry, deleting the first key of a chain cuts off the second
+    hashtable_t* hashtable = hashtable_init(64);
+    hashtable_insert(hashtable, first, 1);
+    hashtable_insert(hashtable, second, 2);
+    hashtable_delete(hashtable, first);
+    hashtable_diagnostics_t diagnostics = hashtable_diagnose(hashtable);
+    pass &= diagnostics.unreachable == 1 && hashtable_lookup(hashtable, second).status == KEY_NOT_FOUND;
+    hashtable_cleanup(hashtable);
+
+    //expiring hashtables leave a tombstone instead
+    hashtable = hashtable_init(64);
+    hashtable_enable_expiry(hashtable, fake_clock);
+    hashtable_insert(hashtable, first, 1);
+    hashtable_insert(hashtable, second, 2);
+    hashtable_delete(hashtable, first);
+    diagnostics = hashtable_diagnose(hashtable);
+    pass &= diagnostics.unreachable == 0 && diagnostics.tombstones == 1 && diagnostics.max_probes == 2;
+    pass &= diagnostics.clusters == 1 && diagnostics.max_cluster == 2;
+    hashtable_cleanup(hashtable);
+    return pass;
+}
+
+//SHARED MEMORY TESTS (prefixed with shm_hashtable_should)
+bool serve_lookups_to_another_process()
+{
+    bool pass = true;
+    char key[16];
+    shm_hashtable_t* writer = shm_hashtable_create(NULL, 1024, 8192);
+    pass &= writer != NULL && shm_hashtable_create(NULL, 1000, 8192) == NULL;
+    for(int i = 0; i < 500; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= shm_hashtable_insert(writer, key, i) == OK;
+    }
+    shm_hashtable_delete(writer, "key7");
+    uint64_t version = shm_hashtable_version(writer);
+    pass &= version == 501 && writer->header->size == 499 && writer->header->tombstones == 1;
+
+    //the child maps the memfd at an address of its own and checks every key, then waits for one more
+    pid_t child = fork();
+    if(child == 0)
+    {
+        shm_hashtable_t* reader = shm_hashtable_attach(writer->fd);
+        bool child_pass = reader != NULL;
+        value_type value = -1;
+        for(int i = 0; child_pass && i < 500; i++)
+        {
+            sprintf(key, "key%d", i);
+            STATUS status = shm_hashtable_lookup(reader, key, &value);
+            child_pass &= i == 7 ? status == KEY_NOT_FOUND : status == OK && value == i;
+        }
+        child_pass &= shm_hashtable_insert(reader, "late", 1) == HASHTABLE_FULL;
+        while(child_pass && shm_hashtable_version(reader) == version) usleep(100);
+        child_pass &= shm_hashtable_lookup(reader, "late", &value) == OK && value == 42;
+        if(reader) shm_hashtable_close(reader);
+        _exit(child_pass ? 0 : 1);
+    }
+    usleep(1000);
+    pass &= shm_hashtable_insert(writer, "late", 42) == OK;
+    int child_status;
+    pass &= waitpid(child, &child_status, 0) == child && WIFEXITED(child_status) && WEXITSTATUS(child_status) == 0;
+    shm_hashtable_close(writer);
+    return pass;
+}
+
+bool reject_writes_past_capacity_or_from_readers()
+{
+    bool pass = true;
+    char name[32], key[16];
+    sprintf(name, "/hashtable_test_%d", (int)getpid());
+    shm_hashtable_unlink(name);
+    shm_hashtable_t* writer = shm_hashtable_create(name, 16, 24);
+    pass &= writer != NULL && writer->bytes == shm_hashtable_size(16, 24);
+    pass &= shm_hashtable_create(name, 16, 24) == NULL; //already exists
+    shm_hashtable_t* reader = shm_hashtable_open(name);
+    pass &= reader != NULL;
+
+    //12 slots fit under the max load factor, and the arena holds 6 keys of 4 bytes
+    for(int i = 0; i < 6; i++)
+    {
+        sprintf(key, "key%d", i);
+        pass &= shm_hashtable_insert(writer, key, i) == OK;
+    }
+    pass &= shm_hashtable_insert(writer, "key0", 0) == DUPLICATE_KEY;
+    pass &= shm_hashtable_insert(writer, "key6", 6) == HASHTABLE_FULL;
+    pass &= shm_hashtable_put(writer, "key0", 10) == OK;
+    pass &= shm_hashtable_delete(writer, "key1") == OK && shm_hashtable_delete(writer, "key1") == KEY_NOT_FOUND;
+    pass &= shm_hashtable_delete(reader, "key2") == HASHTABLE_FULL && shm_hashtable_put(reader, "key2", 0) == HASHTABLE_FULL;
+    pass &= shm_hashtable_insert(writer, "", -1) == OK; //empty keys take no arena space
+
+    value_type value = 0;
+    pass &= shm_hashtable_lookup(reader, "key0", &value) == OK && value == 10;
+    pass &= shm_hashtable_lookup(reader, "key1", &value) == KEY_NOT_FOUND && value == 10;
+    pass &= shm_hashtable_lookup(reader, "", &value) == OK && value == -1;
+    pass &= shm_hashtable_version(reader) == shm_hashtable_version(writer);
+
+    //a deleted key keeps its arena space, so it can't be inserted back once the arena is full
+    pass &= shm_hashtable_insert(writer, "key1", 1) == HASHTABLE_FULL;
+    pass &= writer->header->size == 6 && writer->header->tombstones == 1;
+
+    //the name goes, the mappings stay
+    pass &= shm_hashtable_unlink(name) && !shm_hashtable_unlink(name) && shm_hashtable_open(name) == NULL;
+    pass &= shm_hashtable_lookup(reader, "key5", &value) == OK && value == 5;
+    shm_hashtable_close(reader);
+    shm_hashtable_close(writer);
+    return pass;
+}
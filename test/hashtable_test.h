@@ -1,10 +1,28 @@
 /*
 Author: Dante Crescenzi
-Last Modif: 28 Mar 2024
+Last Modif: 19 Oct 2026
 Description: interface of unit tests for hashtable functionality
 */
 
 #include "../hashtable.h"
+#include "../hashtable_internal.h"
+#include "../compact_hashtable.h"
+#include "../hashcache.h"
+#include "../frozen_hashtable.h"
+#include "../int_hashtable.h"
+#include "../durable_hashtable.h"
+#include "../hashset.h"
+#include "../buffer_hashtable.h"
+#include "../cuckoo_hashtable.h"
+#include "../cow_hashtable.h"
+#include "../hashtable_dump.h"
+#include "../hashtable_diagnostics.h"
+#include "../shm_hashtable.h"
+#include <unistd.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 
 //SUITE = hashtable_init_should
 bool reject_empty_size();
@@ -14,6 +32,8 @@ bool properly_initialize_members();
 //SUITE = hashtable_resize_should
 bool properly_upsize();
 bool properly_downsize();
+bool move_every_key_on_several_threads();
+bool keep_filter_and_expiry_through_parallel_resize();
 
 //SUITE = hashtable_squash_should
 bool squash_for_power_of_2_size();
@@ -52,4 +72,113 @@ bool allow_reinsert_after_delete();
 
 //SUITE = combo_operations
 bool squash_copy();
-bool merge_squash();
\ No newline at end of file
+bool merge_squash();
+
+//SUITE = key_pool_should
+bool share_keys_on_copy();
+bool share_keys_on_merge();
+bool release_keys_on_cleanup();
+
+//SUITE = hashtable_increment_should
+bool increment_new_and_existing_keys();
+bool increment_concurrently();
+bool extract_top_k();
+
+//SUITE = hashtable_merge_parallel_should
+bool merge_partitions_with_combine();
+bool keep_dest_value_without_combine();
+
+//SUITE = hashtable_filter_should
+bool reject_missing_keys();
+bool stay_coherent_through_resize_and_delete();
+
+//SUITE = compact_hashtable_should
+bool properly_insert_and_lookup_compact();
+bool keep_probe_chains_after_delete();
+bool use_less_memory_than_cells();
+
+//SUITE = hashcache_should
+bool evict_when_full();
+bool evict_unreferenced_entries_first();
+bool release_every_entry();
+//SUITE = hashtable_expiry_should
+bool treat_expired_keys_as_missing();
+bool sweep_expired_keys_incrementally();
+bool keep_ttls_through_resize_and_copy();
+bool keep_probe_chains_when_disabled();
+bool carry_ttls_through_merges();
+
+//SUITE = frozen_hashtable_should
+bool find_every_key_in_its_own_slot();
+bool load_frozen_blob_from_a_mapped_file();
+bool freeze_empty_and_expiring_tables();
+bool reject_corrupted_frozen_blobs();
+
+//SUITE = int_hashtable_should
+bool properly_insert_and_lookup_int_keys();
+bool keep_clusters_findable_after_delete();
+bool increment_and_squash_int_keys();
+
+//SUITE = hashtable_hashed_should
+bool probe_several_tables_with_one_hash();
+bool reject_hashes_not_made_by_hashtable_hash();
+
+//SUITE = hash_batch_should
+bool match_scalar_hash_on_every_isa();
+bool match_scalar_hash_for_fixed_width_keys();
+
+//SUITE = durable_hashtable_should
+bool recover_updates_after_reopen();
+bool drop_torn_records_on_replay();
+bool group_commit_and_compact_in_background();
+bool undo_changes_that_fail_to_commit();
+
+//SUITE = hashset_should
+bool keep_probe_chains_through_tombstones();
+bool resize_and_squash_keys_only();
+bool build_set_algebra_from_either_side();
+
+//SUITE = buffer_hashtable_should
+bool keep_everything_inside_the_buffer();
+bool report_full_slots_and_key_arena();
+bool reset_in_place_across_epochs();
+
+//SUITE = hashtable_hot_cache_should
+bool serve_repeated_lookups_from_the_cache();
+bool stay_coherent_through_updates();
+
+//SUITE = cuckoo_hashtable_should
+bool fill_past_quadratic_probing_loads();
+bool grow_and_delete_without_tombstones();
+bool spread_keys_colliding_on_hash();
+
+//SUITE = cow_hashtable_should
+bool keep_snapshots_unchanged_by_writes();
+bool only_clone_pages_that_are_written();
+bool release_snapshots_from_another_thread();
+
+//SUITE = hashtable_iteration_should
+bool visit_every_key_once_with_a_cursor();
+bool restart_cursors_after_a_resize();
+bool split_scans_into_independent_ranges();
+
+//SUITE = hashtable_values_should
+bool copy_values_only_when_duplicated();
+bool destroy_values_only_when_dropped();
+bool manage_values_in_every_layout();
+
+//SUITE = hashtable_dump_should
+bool restore_every_key_on_several_threads();
+bool reject_corrupted_dumps();
+
+//SUITE = hashtable_key_cache_should
+bool reuse_key_buffers_through_churn();
+bool bound_and_trim_kept_buffers();
+
+//SUITE = hashtable_diagnostics_should
+bool report_probes_and_clusters();
+bool find_keys_cut_off_by_deletes();
+
+//SUITE = shm_hashtable_should
+bool serve_lookups_to_another_process();
+bool reject_writes_past_capacity_or_from_readers();
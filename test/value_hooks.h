@@ -0,0 +1,19 @@
+/*
+Author: Dante Crescenzi
+Last Modif: 19 Oct 2026
+Description: value operations of the unit tests
+
+Included ahead of every source of the unit tests (see the Makefile), so the hashtables count the
+values they copy and destroy, which the tests check against what each operation should do.
+*/
+
+#ifndef INCLUDE_VALUE_HOOKS_H
+#define INCLUDE_VALUE_HOOKS_H
+
+extern unsigned long test_value_copies;
+extern unsigned long test_value_destroys;
+
+#define HASHTABLE_VALUE_COPY(dest, src) (__atomic_fetch_add(&test_value_copies, 1, __ATOMIC_RELAXED), *(dest) = (src))
+#define HASHTABLE_VALUE_DESTROY(value) ((void)(value), __atomic_fetch_add(&test_value_destroys, 1, __ATOMIC_RELAXED))
+
+#endif //INCLUDE_VALUE_HOOKS_H